@@ -0,0 +1,79 @@
+#include <benchmark/benchmark.h>
+
+#include <functional>
+
+#include "boundary.h"
+#include "heightmap.h"
+#include "inputdcel.h"
+
+/// Creates an InputDcel for a flat `size` × `size` heightmap.
+static InputDcel gridDcel(int size) {
+	HeightMap heightMap(size, size);
+	return InputDcel(heightMap, Boundary(heightMap));
+}
+
+// The following benchmarks all sum the degrees of the vertices and the number
+// of boundary vertices of the faces, using the different ways of traversing
+// a DCEL.
+
+static void BM_TraverseWithStdFunction(benchmark::State& state) {
+	InputDcel dcel = gridDcel(state.range(0));
+	for (auto _ : state) {
+		long sum = 0;
+		std::function<void(InputDcel::HalfEdge)> countEdge = [&sum](InputDcel::HalfEdge) {
+			sum++;
+		};
+		std::function<void(InputDcel::Vertex)> countVertex = [&sum](InputDcel::Vertex) {
+			sum++;
+		};
+		for (int i = 0; i < dcel.vertexCount(); i++) {
+			dcel.vertex(i).forAllOutgoingEdges(countEdge);
+		}
+		for (int i = 0; i < dcel.faceCount(); i++) {
+			dcel.face(i).forAllBoundaryVertices(countVertex);
+		}
+		benchmark::DoNotOptimize(sum);
+	}
+	state.SetItemsProcessed(state.iterations() * (dcel.vertexCount() + dcel.faceCount()));
+}
+BENCHMARK(BM_TraverseWithStdFunction)->Arg(256)->Arg(1024);
+
+static void BM_TraverseWithLambda(benchmark::State& state) {
+	InputDcel dcel = gridDcel(state.range(0));
+	for (auto _ : state) {
+		long sum = 0;
+		for (int i = 0; i < dcel.vertexCount(); i++) {
+			dcel.vertex(i).forAllOutgoingEdges([&sum](InputDcel::HalfEdge) {
+				sum++;
+			});
+		}
+		for (int i = 0; i < dcel.faceCount(); i++) {
+			dcel.face(i).forAllBoundaryVertices([&sum](InputDcel::Vertex) {
+				sum++;
+			});
+		}
+		benchmark::DoNotOptimize(sum);
+	}
+	state.SetItemsProcessed(state.iterations() * (dcel.vertexCount() + dcel.faceCount()));
+}
+BENCHMARK(BM_TraverseWithLambda)->Arg(256)->Arg(1024);
+
+static void BM_TraverseWithRange(benchmark::State& state) {
+	InputDcel dcel = gridDcel(state.range(0));
+	for (auto _ : state) {
+		long sum = 0;
+		for (int i = 0; i < dcel.vertexCount(); i++) {
+			for ([[maybe_unused]] InputDcel::HalfEdge e : dcel.vertex(i).outgoingEdges()) {
+				sum++;
+			}
+		}
+		for (int i = 0; i < dcel.faceCount(); i++) {
+			for ([[maybe_unused]] InputDcel::Vertex v : dcel.face(i).boundaryVertices()) {
+				sum++;
+			}
+		}
+		benchmark::DoNotOptimize(sum);
+	}
+	state.SetItemsProcessed(state.iterations() * (dcel.vertexCount() + dcel.faceCount()));
+}
+BENCHMARK(BM_TraverseWithRange)->Arg(256)->Arg(1024);
@@ -0,0 +1,88 @@
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "boundary.h"
+#include "heightmap.h"
+#include "inputdcel.h"
+#include "mscomplex.h"
+#include "mscomplexcreator.h"
+
+/// Generates a synthetic `size` × `size` terrain with a few large valleys and
+/// some noise, so that it has many critical points.
+static HeightMap syntheticTerrain(int size) {
+	HeightMap heightMap(size, size);
+	std::mt19937 random(1);
+	std::uniform_real_distribution<double> noise(0, 1);
+	for (int y = 0; y < size; y++) {
+		for (int x = 0; x < size; x++) {
+			heightMap.setElevationAt(
+			    x, y, 10 * std::sin(x * 0.03) * std::cos(y * 0.025) + 3 * noise(random));
+		}
+	}
+	return heightMap;
+}
+
+static void BM_ComputeGradientFlow(benchmark::State& state) {
+	HeightMap heightMap = syntheticTerrain(state.range(0));
+	const InputDcel original(heightMap, Boundary(heightMap));
+	for (auto _ : state) {
+		state.PauseTiming();
+		InputDcel dcel = original;
+		state.ResumeTiming();
+		dcel.computeGradientFlow(state.range(1));
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * original.vertexCount());
+}
+BENCHMARK(BM_ComputeGradientFlow)
+    ->ArgNames({"size", "threads"})
+    ->ArgsProduct({{256, 512}, {1, 2, 4, 8}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+static void BM_MsComplexCreate(benchmark::State& state) {
+	HeightMap heightMap = syntheticTerrain(state.range(0));
+	InputDcel original(heightMap, Boundary(heightMap));
+	original.computeGradientFlow();
+	for (auto _ : state) {
+		state.PauseTiming();
+		auto dcel = std::make_shared<InputDcel>(original);
+		auto msc = std::make_shared<MsComplex>();
+		MsComplexCreator creator(dcel, msc, nullptr, state.range(1));
+		state.ResumeTiming();
+		creator.create();
+		benchmark::DoNotOptimize(msc->vertexCount());
+	}
+	state.SetItemsProcessed(state.iterations() * original.vertexCount());
+}
+BENCHMARK(BM_MsComplexCreate)
+    ->ArgNames({"size", "threads"})
+    ->ArgsProduct({{256, 512}, {1, 2, 4, 8}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+static void BM_VerticesAt(benchmark::State& state) {
+	HeightMap heightMap = syntheticTerrain(state.range(0));
+	InputDcel dcel(heightMap, Boundary(heightMap));
+	std::mt19937 random(2);
+	std::uniform_int_distribution<int> coordinate(0, state.range(0) - 1);
+	std::vector<Point> positions(1 << 20);
+	for (Point& p : positions) {
+		p = Point{static_cast<double>(coordinate(random)),
+		          static_cast<double>(coordinate(random)), 0};
+	}
+	for (auto _ : state) {
+		std::vector<InputDcel::Vertex> vertices = dcel.verticesAt(positions, state.range(1));
+		benchmark::DoNotOptimize(vertices.data());
+	}
+	state.SetItemsProcessed(state.iterations() * positions.size());
+}
+BENCHMARK(BM_VerticesAt)
+    ->ArgNames({"size", "threads"})
+    ->ArgsProduct({{256, 512}, {1, 4}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
@@ -0,0 +1,87 @@
+#include <benchmark/benchmark.h>
+
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "mscomplex.h"
+#include "mscomplexsimplifier.h"
+
+/// Fills `msc` with a random dendritic tree with `size` vertices, rooted at a
+/// vertex at height -∞. Most vertices extend the previous branch, so the tree
+/// consists of long branches. The vertices are numbered from the root towards
+/// the leaves, so δ-values need to propagate in the order of decreasing IDs.
+static void dendriticTree(MsComplex& msc, int size) {
+	std::mt19937 random(1);
+	std::uniform_real_distribution<double> uniform(0, 1);
+
+	msc.addVertex().data().p.h = -std::numeric_limits<double>::infinity();
+	std::vector<std::vector<MsComplex::HalfEdge>> outgoing(size);
+	for (int i = 1; i < size; i++) {
+		msc.addVertex().data().p.h = i;
+		int parent = uniform(random) < 0.9 ? i - 1 : random() % i;
+		MsComplex::HalfEdge e = msc.addEdge(msc.vertex(parent), msc.vertex(i));
+		outgoing[parent].push_back(e);
+		outgoing[i].push_back(e.twin());
+	}
+	for (int v = 0; v < size; v++) {
+		msc.vertex(v).setOutgoing(outgoing[v][0]);
+		for (int i = 0; i < outgoing[v].size(); i++) {
+			outgoing[v][i].twin().setNext(outgoing[v][(i + 1) % outgoing[v].size()]);
+		}
+	}
+	msc.addFaces();
+}
+
+/// For comparison with BM_PropagateDeltas: sums the δ-values around every
+/// vertex, which is a single linear pass over the complex.
+static void BM_TraverseTree(benchmark::State& state) {
+	MsComplex msc;
+	dendriticTree(msc, state.range(0));
+	for (int i = 0; i < msc.halfEdgeCount(); i++) {
+		msc.halfEdge(i).data().m_delta = 1;
+	}
+	for (auto _ : state) {
+		double sum = 0;
+		for (int i = 0; i < msc.vertexCount(); i++) {
+			for (MsComplex::HalfEdge e : msc.vertex(i).outgoingEdges()) {
+				sum += e.data().m_delta;
+			}
+		}
+		benchmark::DoNotOptimize(sum);
+	}
+	state.SetComplexityN(state.range(0));
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TraverseTree)
+    ->RangeMultiplier(4)
+    ->Range(1 << 10, 1 << 18)
+    ->Unit(benchmark::kMillisecond)
+    ->Complexity(benchmark::oN);
+
+static void BM_PropagateDeltas(benchmark::State& state) {
+	MsComplex msc;
+	dendriticTree(msc, state.range(0));
+	std::mt19937 random(2);
+	std::uniform_real_distribution<double> uniform(0, 1000);
+	std::vector<double> deltas(msc.halfEdgeCount() / 2);
+	for (double& delta : deltas) {
+		delta = uniform(random);
+	}
+	for (auto _ : state) {
+		state.PauseTiming();
+		for (int i = 0; i < deltas.size(); i++) {
+			msc.halfEdge(2 * i).data().m_delta = deltas[i];
+			msc.halfEdge(2 * i + 1).data().m_delta = deltas[i];
+		}
+		state.ResumeTiming();
+		MsComplexSimplifier::propagateDeltas(msc);
+	}
+	state.SetComplexityN(state.range(0));
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_PropagateDeltas)
+    ->RangeMultiplier(4)
+    ->Range(1 << 10, 1 << 18)
+    ->Unit(benchmark::kMillisecond)
+    ->Complexity(benchmark::oN);
@@ -0,0 +1,90 @@
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <memory_resource>
+#include <random>
+#include <vector>
+
+#include "piecewiselinearfunction.h"
+
+/// Generates the sand function of `pillarCount` quarter pillars with random
+/// heights in `[0, 100)`.
+static PiecewiseLinearFunction randomSandFunction(int pillarCount, int seed) {
+	std::mt19937 random(seed);
+	std::uniform_real_distribution<double> height(0, 100);
+	std::pmr::vector<double> heights(pillarCount);
+	for (double& h : heights) {
+		h = height(random);
+	}
+	return PiecewiseLinearFunction::sumOfPillars(std::move(heights));
+}
+
+static void BM_PlfAdd(benchmark::State& state) {
+	PiecewiseLinearFunction f1 = randomSandFunction(state.range(0), 1);
+	PiecewiseLinearFunction f2 = randomSandFunction(state.range(0), 2);
+	for (auto _ : state) {
+		PiecewiseLinearFunction sum = f1.add(f2);
+		benchmark::DoNotOptimize(sum);
+	}
+	state.SetItemsProcessed(state.iterations() * 2 * state.range(0));
+}
+BENCHMARK(BM_PlfAdd)->Arg(1)->Arg(4)->Arg(64)->Arg(4096);
+
+static void BM_PlfAddInPlace(benchmark::State& state) {
+	PiecewiseLinearFunction f1 = randomSandFunction(state.range(0), 1);
+	PiecewiseLinearFunction f2 = randomSandFunction(state.range(0), 2);
+	PiecewiseLinearFunction sum;
+	for (auto _ : state) {
+		// assigning reuses the capacity of sum, so this doesn't allocate
+		// after the first iteration
+		sum = f1;
+		sum += f2;
+		benchmark::DoNotOptimize(sum);
+	}
+	state.SetItemsProcessed(state.iterations() * 2 * state.range(0));
+}
+BENCHMARK(BM_PlfAddInPlace)->Arg(1)->Arg(4)->Arg(64)->Arg(4096);
+
+static void BM_PlfAddInArena(benchmark::State& state) {
+	PiecewiseLinearFunction f1 = randomSandFunction(state.range(0), 1);
+	PiecewiseLinearFunction f2 = randomSandFunction(state.range(0), 2);
+	// large enough for all allocations of one iteration, so that after
+	// releasing the arena, it never needs to allocate from upstream
+	std::vector<std::byte> buffer(64 * (state.range(0) + 1) * sizeof(LinearFunction));
+	std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size());
+	for (auto _ : state) {
+		{
+			PiecewiseLinearFunction sum(f1, &arena);
+			sum += f2;
+			benchmark::DoNotOptimize(sum);
+		}
+		arena.release();
+	}
+	state.SetItemsProcessed(state.iterations() * 2 * state.range(0));
+}
+BENCHMARK(BM_PlfAddInArena)->Arg(1)->Arg(4)->Arg(64)->Arg(4096);
+
+static void BM_PlfEvaluate(benchmark::State& state) {
+	PiecewiseLinearFunction f = randomSandFunction(state.range(0), 1);
+	double h = 0;
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(f(h));
+		h = h >= 100 ? 0 : h + 0.37;
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PlfEvaluate)->Arg(1)->Arg(4)->Arg(64)->Arg(4096);
+
+static void BM_PlfPrune(benchmark::State& state) {
+	const PiecewiseLinearFunction original = randomSandFunction(state.range(0), 1);
+	PiecewiseLinearFunction f;
+	for (auto _ : state) {
+		state.PauseTiming();
+		f = original;
+		state.ResumeTiming();
+		f.prune(50);
+		benchmark::DoNotOptimize(f);
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PlfPrune)->Arg(1)->Arg(4)->Arg(64)->Arg(4096);
@@ -2,18 +2,18 @@
 
 #include <memory>
 
-#include "inputgraph.h"
 #include "mergetree.h"
 #include "mscomplexcreator.h"
 #include "mscomplexsimplifier.h"
 #include "mstonetworkgraphcreator.h"
 
 BackgroundThread::BackgroundThread(const std::shared_ptr<RiverData>& data,
-                                   const std::shared_ptr<RiverFrame>& frame)
-    : m_data(data), m_frame(frame) {}
+                                   const std::shared_ptr<RiverFrame>& frame,
+                                   int threadCount)
+    : m_data(data), m_frame(frame), m_threadCount(threadCount) {}
 
-BackgroundThread::BackgroundThread(const std::shared_ptr<RiverData>& data)
-    : m_data(data), m_frame(nullptr) {}
+BackgroundThread::BackgroundThread(const std::shared_ptr<RiverData>& data, int threadCount)
+    : m_data(data), m_frame(nullptr), m_threadCount(threadCount) {}
 
 void BackgroundThread::run() {
 	if (!m_data->boundaryRasterized().isValid()) {
@@ -36,18 +36,17 @@ void BackgroundThread::run() {
 }
 
 bool BackgroundThread::computeForFrame() {
-	m_frame->m_inputGraph = nullptr;
 	m_frame->m_inputDcel = nullptr;
+	m_frame->m_inputDcelIndex = nullptr;
 	m_frame->m_msComplex = nullptr;
+	m_frame->m_msComplexIndex = nullptr;
 	m_frame->m_networkGraph = nullptr;
 
-	computeInputGraph();
-	if (m_frame->m_inputGraph->containsNodata()) {
+	if (!computeInputDcel()) {
 		emit errorEncountered(
 			"The computation cannot run as there are nodata values inside the boundary.");
 		return false;
 	}
-	computeInputDcel();
 	computeMsComplex();
 	computeMergeTree();
 	simplifyMsComplex();
@@ -55,31 +54,26 @@ bool BackgroundThread::computeForFrame() {
 	return true;
 }
 
-void
-BackgroundThread::computeInputGraph() {
-	emit taskStarted(m_taskPrefix + "Computing input graph");
-	auto inputGraph = std::make_shared<InputGraph>(
+bool
+BackgroundThread::computeInputDcel() {
+	emit taskStarted(m_taskPrefix + "Computing input DCEL");
+	auto inputDcel = std::make_shared<InputDcel>(
 	                           m_frame->m_heightMap,
 	                           m_data->boundaryRasterized());
-	emit progressMade(m_taskPrefix + "Computing input graph", 100);
-	{
-		QWriteLocker lock(&(m_frame->m_inputGraphLock));
-		m_frame->m_inputGraph = inputGraph;
+	if (inputDcel->containsNodata()) {
+		emit taskEnded(m_taskPrefix + "Computing input DCEL");
+		return false;
 	}
-	emit taskEnded(m_taskPrefix + "Computing input graph");
-}
-
-void
-BackgroundThread::computeInputDcel() {
-	emit taskStarted(m_taskPrefix + "Computing input DCEL");
-	auto inputDcel = std::make_shared<InputDcel>(*m_frame->m_inputGraph);
-	inputDcel->computeGradientFlow();
+	inputDcel->computeGradientFlow(m_threadCount);
+	auto index = std::make_shared<InputDcelIndex>(*inputDcel);
 	emit progressMade(m_taskPrefix + "Computing input DCEL", 100);
 	{
 		QWriteLocker lock(&(m_frame->m_inputDcelLock));
 		m_frame->m_inputDcel = inputDcel;
+		m_frame->m_inputDcelIndex = index;
 	}
 	emit taskEnded(m_taskPrefix + "Computing input DCEL");
+	return true;
 }
 
 void
@@ -89,11 +83,13 @@ BackgroundThread::computeMsComplex() {
 	MsComplexCreator msCreator(m_frame->m_inputDcel,
 	                           msComplex, [this](int progress) {
 		emit progressMade(m_taskPrefix + "Computing MS complex", progress);
-	});
+	}, m_threadCount);
 	msCreator.create();
+	auto index = std::make_shared<SpatialIndex>(SpatialIndex::ofSaddleEdges(*msComplex));
 	{
 		QWriteLocker lock(&(m_frame->m_msComplexLock));
 		m_frame->m_msComplex = msComplex;
+		m_frame->m_msComplexIndex = index;
 	}
 	emit taskEnded(m_taskPrefix + "Computing MS complex");
 }
@@ -113,22 +109,18 @@ BackgroundThread::computeMergeTree() {
 void
 BackgroundThread::simplifyMsComplex() {
 	emit taskStarted(m_taskPrefix + "Simplifying MS complex");
-	auto msSimplified = std::make_shared<MsComplex>(*m_frame->m_msComplex);
-	MsComplexSimplifier msSimplifier(msSimplified,
+	MsComplexSimplifier msSimplifier(m_frame->m_msComplex,
 	                                 [this](int progress) {
 		emit progressMade(m_taskPrefix + "Simplifying MS complex", progress);
 	});
-	msSimplifier.simplify();
-	emit taskEnded(m_taskPrefix + "Simplifying MS complex");
-
-	emit taskStarted(m_taskPrefix + "Compacting MS complex");
-
-	msSimplified->compact();
+	// computing the δ-values only reads the MS complex, so only writing them
+	// into it needs to block the GUI from drawing it
+	msSimplifier.computeDeltas();
 	{
 		QWriteLocker lock(&(m_frame->m_msComplexLock));
-		m_frame->m_msComplex = msSimplified;
+		msSimplifier.writeDeltas();
 	}
-	emit taskEnded(m_taskPrefix + "Compacting MS complex");
+	emit taskEnded(m_taskPrefix + "Simplifying MS complex");
 }
 
 void
@@ -19,14 +19,21 @@ class BackgroundThread : public QThread {
 		/**
 		 * Creates a background thread that computes the network for one river
 		 * frame.
+		 *
+		 * \param threadCount The number of threads to use for the parallel
+		 * parts of the computation.
 		 */
 		BackgroundThread(const std::shared_ptr<RiverData>& data,
-						const std::shared_ptr<RiverFrame>& frame);
+						const std::shared_ptr<RiverFrame>& frame,
+						int threadCount = 1);
 		/**
 		 * Creates a background thread that computes the network for all river
 		 * frames.
+		 *
+		 * \param threadCount The number of threads to use for the parallel
+		 * parts of the computation.
 		 */
-		BackgroundThread(const std::shared_ptr<RiverData>& data);
+		BackgroundThread(const std::shared_ptr<RiverData>& data, int threadCount = 1);
 
 		void run() override;
 
@@ -70,8 +77,16 @@ class BackgroundThread : public QThread {
 
 		QString m_taskPrefix = "";
 
-		void computeInputGraph();
-		void computeInputDcel();
+		/**
+		 * The number of threads to use for the parallel parts of the
+		 * computation.
+		 */
+		int m_threadCount;
+
+		/// Computes the input DCEL. Returns `false` if the terrain inside
+		/// the boundary contains nodata values, in which case the DCEL is not
+		/// stored in the frame.
+		bool computeInputDcel();
 		void computeMsComplex();
 		void computeMergeTree();
 		void simplifyMsComplex();
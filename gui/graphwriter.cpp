@@ -1,11 +1,19 @@
 #include <QFile>
 
+#include <algorithm>
+#include <vector>
+
 #include "graphwriter.h"
 #include "networkgraph.h"
 
-void GraphWriter::writeGraph(NetworkGraph& graph,
+void GraphWriter::writeGraph(const NetworkGraph& graph,
                              const Units& units,
-                             const QString& fileName) {
+                             const QString& fileName,
+                             double threshold) {
+
+	std::span<const int> selected = graph.edgesWithDeltaAtLeast(threshold);
+	std::vector<int> edges(selected.begin(), selected.end());
+	std::sort(edges.begin(), edges.end());
 
 	QFile file(fileName);
 	file.open(QIODevice::WriteOnly | QIODevice::Text);
@@ -17,17 +25,18 @@ void GraphWriter::writeGraph(NetworkGraph& graph,
 		    << graph[i].p.x << " "
 		    << graph[i].p.y << "\n";
 	}
-	out << graph.edgeCount() << "\n";
-	for (int i = 0; i < graph.edgeCount(); i++) {
+	out << edges.size() << "\n";
+	for (int i = 0; i < edges.size(); i++) {
+		const NetworkGraph::Edge& e = graph.edge(edges[i]);
 		out << i << " "
-		    << graph.edge(i).from << " "
-		    << graph.edge(i).to << " "
-		    << units.toRealVolume(graph.edge(i).delta) << " ";
+		    << e.from << " "
+		    << e.to << " "
+		    << units.toRealVolume(e.delta) << " ";
 
-		for (int j = 0; j < graph.edge(i).path.size(); j++) {
-			Point p = graph.edge(i).path[j];
+		for (int j = 0; j < e.path.size(); j++) {
+			Point p = e.path[j];
 			out << p.x << " " << p.y
-			    << (j == graph.edge(i).path.size() - 1 ? "\n" : " ");
+			    << (j == e.path.size() - 1 ? "\n" : " ");
 		}
 	}
 }
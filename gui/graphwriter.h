@@ -4,6 +4,8 @@
 #include <QString>
 #include <QTextStream>
 
+#include <limits>
+
 #include "networkgraph.h"
 #include "units.h"
 
@@ -26,14 +28,19 @@ class GraphWriter {
 		 * <id> <from-id> <to-id> <delta> (<x> <y>)*  # for each edge
 		 * ```
 		 *
+		 * Only the edges with δ-value at least `threshold` are output; they
+		 * are numbered consecutively in the order of their IDs in the graph.
+		 *
 		 * \param networkGraph The graph to output.
 		 * \param units The unit converter, used to output the delta values
 		 * in natural units.
 		 * \param fileName The file name of the image file.
+		 * \param threshold The δ-threshold.
 		 */
-		static void writeGraph(NetworkGraph& networkGraph,
+		static void writeGraph(const NetworkGraph& networkGraph,
 		                       const Units& units,
-		                       const QString& fileName);
+		                       const QString& fileName,
+		                       double threshold = -std::numeric_limits<double>::infinity());
 };
 
 #endif // GRAPHWRITER_H
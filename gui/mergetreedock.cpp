@@ -2,6 +2,8 @@
 
 #include <QMouseEvent>
 
+#include <climits>
+
 MergeTreeDock::MergeTreeDock(QWidget *parent) : QDockWidget("Merge tree", parent) {
 	setBackgroundRole(QPalette::Base);
 	setAutoFillBackground(true);
@@ -17,6 +19,9 @@ QSize MergeTreeDock::sizeHint() const {
 }
 
 void MergeTreeDock::setMergeTree(std::shared_ptr<MergeTree> mergeTree) {
+	if (mergeTree == m_mergeTree) {
+		return;
+	}
 	m_mergeTree = mergeTree;
 	if (mergeTree == nullptr) {
 		setEnabled(false);
@@ -27,6 +32,7 @@ void MergeTreeDock::setMergeTree(std::shared_ptr<MergeTree> mergeTree) {
 			Point p2 = n2.m_p;
 			return p1.x < p2.x;
 		});
+		emit leafLabelsChanged(constructLeafLabelImage());
 		setEnabled(true);
 		update();
 	}
@@ -51,9 +57,7 @@ void MergeTreeDock::mouseMoveEvent(QMouseEvent* event) {
 	// if hovering the color ramp: show the entire level set
 	m_hoveringRamp = column < 0;
 	if (m_hoveringRamp) {
-		QImage mask(m_mapWidth, m_mapHeight, QImage::Format::Format_ARGB32);
-		mask.fill(QColor{"white"});
-		emit hoveredSubtreeMaskChanged(mask);
+		emit hoveredLeafRangeChanged(0, INT_MAX);
 
 	// if hovering a column of the merge tree: show the corresponding contour
 	} else if (m_columnToNodeMap.contains(column)) {
@@ -61,18 +65,15 @@ void MergeTreeDock::mouseMoveEvent(QMouseEvent* event) {
 		const MergeTree::Node& columnNode = m_sortedMergeTree->get(nodeId);
 		m_hoveredNodeId = m_sortedMergeTree->parentAtHeight(columnNode.m_index, m_hoveredHeight);
 		if (m_hoveredNodeId) {
-			QImage mask = constructMaskImage(m_sortedMergeTree->get(*m_hoveredNodeId));
-			emit hoveredSubtreeMaskChanged(mask);
+			// the labels are the leaf numbers plus one
+			const MergeTree::Node& node = m_sortedMergeTree->get(*m_hoveredNodeId);
+			emit hoveredLeafRangeChanged(node.m_firstLeaf + 1, node.m_lastLeaf + 1);
 		} else {
-			QImage mask(m_mapWidth, m_mapHeight, QImage::Format::Format_ARGB32);
-			mask.fill(QColor{"black"});
-			emit hoveredSubtreeMaskChanged(mask);
+			emit hoveredLeafRangeChanged(1, 0);
 		}
 
 	} else {
-		QImage mask(m_mapWidth, m_mapHeight, QImage::Format::Format_ARGB32);
-		mask.fill(QColor{"black"});
-		emit hoveredSubtreeMaskChanged(mask);
+		emit hoveredLeafRangeChanged(1, 0);
 	}
 	
 	update();
@@ -82,9 +83,7 @@ void MergeTreeDock::leaveEvent(QEvent*) {
 	m_hoveringRamp = false;
 	m_hoveredNodeId = std::nullopt;
 
-	QImage mask(m_mapWidth, m_mapHeight, QImage::Format::Format_ARGB32);
-	mask.fill(QColor{"black"});
-	emit hoveredSubtreeMaskChanged(mask);
+	emit hoveredLeafRangeChanged(1, 0);
 
 	update();
 }
@@ -192,27 +191,16 @@ int MergeTreeDock::drawSubtree(QPainter& painter, const MergeTree::Node& root, i
 	return currentColumn - column;
 };
 
-QImage MergeTreeDock::constructMaskImage(const MergeTree::Node& root) {
-	QImage mask(m_mapWidth, m_mapHeight, QImage::Format::Format_ARGB32);
-	mask.fill(QColor{"black"});
-	addSubtreeToMask(mask, root);
-	return mask;
-}
-
-void MergeTreeDock::addSubtreeToMask(QImage& mask, const MergeTree::Node& root) {
-	if (root.m_children.empty()) {
-		assert(std::holds_alternative<MsComplex::Face>(root.m_criticalSimplex));
-		MsComplex::Face maximum = std::get<MsComplex::Face>(root.m_criticalSimplex);
-		for (InputDcel::Face f : maximum.data().faces) {
-			Point p = f.data().p;
-			int x = std::floor(p.x);
-			int y = std::floor(p.y);
-			mask.setPixelColor(x, y, QColor{"white"});
+QImage MergeTreeDock::constructLeafLabelImage() {
+	std::vector<int> leaves = m_sortedMergeTree->leafRaster(m_mapWidth, m_mapHeight);
+	QImage labels(m_mapWidth, m_mapHeight, QImage::Format::Format_ARGB32);
+	for (int y = 0; y < m_mapHeight; y++) {
+		QRgb* line = reinterpret_cast<QRgb*>(labels.scanLine(y));
+		for (int x = 0; x < m_mapWidth; x++) {
+			// like the elevation texture, store the label in 24 bits of RGB
+			int label = leaves[static_cast<std::size_t>(y) * m_mapWidth + x] + 1;
+			line[x] = qRgb((label >> 16) & 0xff, (label >> 8) & 0xff, label & 0xff);
 		}
-		return;
-	}
-
-	for (int child : root.m_children) {
-		addSubtreeToMask(mask, m_sortedMergeTree->get(child));
 	}
+	return labels;
 }
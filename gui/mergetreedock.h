@@ -35,7 +35,19 @@ class MergeTreeDock : public QDockWidget {
 	signals:
 		void pointToHighlightChanged(std::optional<Point> pos);
 		void hoveredHeightChanged(double height);
-		void hoveredSubtreeMaskChanged(QImage mask);
+		/**
+		 * Emitted when the merge tree changes. The image contains for each
+		 * pixel of the map the number (plus one) of the merge tree leaf whose
+		 * MS-face contains it, encoded in the RGB channels, or 0 if there is
+		 * no such leaf.
+		 */
+		void leafLabelsChanged(QImage labels);
+		/**
+		 * Emitted when the hovered subtree changes. The pixels that belong to
+		 * the hovered subtree are the pixels whose label in the image from
+		 * leafLabelsChanged() is between `first` and `last` (inclusive).
+		 */
+		void hoveredLeafRangeChanged(int first, int last);
 
 	public slots:
 		/**
@@ -62,8 +74,8 @@ class MergeTreeDock : public QDockWidget {
 		/// Returns the number of columns spanned by the subtree drawn.
 		int drawSubtree(QPainter& painter, const MergeTree::Node& root, int column, double yParent);
 
-		QImage constructMaskImage(const MergeTree::Node& root);
-		void addSubtreeToMask(QImage& mask, const MergeTree::Node& root);
+		/// Builds the image for leafLabelsChanged().
+		QImage constructLeafLabelImage();
 
 		std::shared_ptr<MergeTree> m_mergeTree = nullptr;
 		std::unique_ptr<MergeTree> m_sortedMergeTree = nullptr;
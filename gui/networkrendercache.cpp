@@ -0,0 +1,254 @@
+#include "networkrendercache.h"
+
+#include <QLineF>
+#include <QPen>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <span>
+#include <utility>
+
+void NetworkRenderCache::update(const std::shared_ptr<NetworkGraph>& graph, double zoom,
+                                bool drawOutOfBounds) {
+	int zoomOctave = std::floor(std::log2(zoom));
+	if (graph != nullptr && m_graph.lock() == graph && zoomOctave == m_zoomOctave &&
+	    drawOutOfBounds == m_drawOutOfBounds) {
+		return;
+	}
+	m_graph = graph;
+	m_zoomOctave = zoomOctave;
+	m_drawOutOfBounds = drawOutOfBounds;
+	m_edges.clear();
+	m_buckets.clear();
+	m_maxPenWidth = 0;
+	m_index = SpatialIndex();
+	if (graph == nullptr) {
+		return;
+	}
+
+	std::span<const int> order = graph->edgesByDelta();
+	double deltaMax = 0;
+	for (auto it = order.rbegin(); it != order.rend(); it++) {
+		double delta = graph->edge(*it).delta;
+		if (delta < std::numeric_limits<double>::infinity()) {
+			deltaMax = std::max(deltaMax, delta);
+			break;
+		}
+	}
+
+	// at zoom levels within this octave, the simplification error is at most
+	// half a pixel
+	double tolerance = 0.25 / std::exp2(zoomOctave);
+
+	m_edges.resize(order.size());
+	// edges without a path get a NaN box, so that they are not indexed
+	double nan = std::numeric_limits<double>::quiet_NaN();
+	std::vector<SpatialIndex::Box> bounds(order.size(), SpatialIndex::Box{nan, nan, nan, nan});
+	double inf = std::numeric_limits<double>::infinity();
+	SpatialIndex::Box area{inf, inf, -inf, -inf};
+	for (int rank = 0; rank < order.size(); rank++) {
+		const NetworkGraph::Edge& e = graph->edge(order[rank]);
+		CachedEdge& cached = m_edges[rank];
+		cached.width = 4;
+		if (e.delta < std::numeric_limits<double>::infinity()) {
+			cached.width = std::max(1.5, 3 - 0.5 * std::log10(deltaMax / e.delta));
+		}
+		m_maxPenWidth = std::max(m_maxPenWidth, cached.width + 2);
+		QColor color = colorForDelta(e.delta, deltaMax);
+		if (m_buckets.empty() || m_buckets.back().color != color) {
+			m_buckets.push_back(Bucket{rank, color});
+		}
+
+		if (e.path.size() < 2) {
+			continue;
+		}
+		auto inBounds = [drawOutOfBounds](Point p) {
+			return drawOutOfBounds || std::isfinite(p.h);
+		};
+		QPolygonF polygon;
+		if (inBounds(e.path[0]) && inBounds(e.path[1])) {
+			polygon << QPointF((e.path[0].x + e.path[1].x) / 2, (e.path[0].y + e.path[1].y) / 2);
+		}
+		for (int i = 1; i < e.path.size(); i++) {
+			if (inBounds(e.path[i])) {
+				polygon << QPointF(e.path[i].x, e.path[i].y);
+			}
+		}
+		if (polygon.size() <= 1) {
+			continue;
+		}
+		polygon = simplify(polygon, tolerance);
+		cached.path = roundedPath(polygon, 0.3);
+		QRectF box = polygon.boundingRect();
+		bounds[rank] = SpatialIndex::Box{box.left(), box.top(), box.right(), box.bottom()};
+		area.xMin = std::min(area.xMin, box.left());
+		area.yMin = std::min(area.yMin, box.top());
+		area.xMax = std::max(area.xMax, box.right());
+		area.yMax = std::max(area.yMax, box.bottom());
+	}
+
+	// at most 64 × 64 tiles, of at least one river unit each
+	double extent = std::max(area.xMax - area.xMin, area.yMax - area.yMin);
+	m_index = SpatialIndex(bounds, std::isfinite(extent) ? std::max(1.0, extent / 64) : 1.0);
+}
+
+void NetworkRenderCache::draw(QPainter& p, const QTransform& toScreen, const QRectF& viewport,
+                              double threshold) {
+	std::shared_ptr<NetworkGraph> graph = m_graph.lock();
+	if (graph == nullptr || m_edges.empty()) {
+		return;
+	}
+	int firstRank = m_edges.size() - graph->edgesWithDeltaAbove(threshold).size();
+
+	// collect the edges near the viewport; the viewport is extended by half
+	// the widest pen, as the pens are cosmetic and extend beyond the paths
+	double margin = m_maxPenWidth / 2;
+	QRectF visible =
+	        toScreen.inverted().mapRect(viewport.adjusted(-margin, -margin, margin, margin));
+	std::vector<int> ranks = m_index.query(SpatialIndex::Box{
+	        visible.left(), visible.top(), visible.right(), visible.bottom()});
+	ranks.erase(ranks.begin(), std::lower_bound(ranks.begin(), ranks.end(), firstRank));
+
+	p.save();
+	p.setTransform(toScreen, true);
+	p.setBrush(Qt::NoBrush);
+
+	// the pens are cosmetic, so that their width is in pixels regardless of
+	// the transform
+	// draw white casing
+	for (int rank : ranks) {
+		QPen pen(QColor{"white"}, m_edges[rank].width + 2);
+		pen.setCosmetic(true);
+		p.setPen(pen);
+		p.drawPath(m_edges[rank].path);
+	}
+
+	// draw colored edges
+	int bucket = 0;
+	for (int rank : ranks) {
+		while (bucket + 1 < m_buckets.size() && m_buckets[bucket + 1].begin <= rank) {
+			bucket++;
+		}
+		QPen pen(m_buckets[bucket].color, m_edges[rank].width);
+		pen.setCosmetic(true);
+		p.setPen(pen);
+		p.drawPath(m_edges[rank].path);
+	}
+
+	p.restore();
+}
+
+QPainterPath NetworkRenderCache::roundedPath(const QPolygonF& polygon, double cornerLength) {
+	QPainterPath result;
+	result.moveTo(polygon[0]);
+	// for all internal vertices
+	for (int i = 1; i < polygon.size() - 1; ++i) {
+		QPointF p1 = polygon[i - 1];
+		QPointF p2 = polygon[i];
+		QPointF p3 = polygon[i + 1];
+		double l21 = QLineF(p1, p2).length();
+		double l23 = QLineF(p3, p2).length();
+		QPointF p21 = p2 + (p1 - p2) * (cornerLength / l21);
+		QPointF p23 = p2 + (p3 - p2) * (cornerLength / l23);
+		result.lineTo(p21);
+		result.quadTo(p2, p23);
+	}
+	result.lineTo(polygon[polygon.size() - 1]);
+	return result;
+}
+
+QPolygonF NetworkRenderCache::simplify(const QPolygonF& polygon, double tolerance) {
+	if (polygon.size() <= 2) {
+		return polygon;
+	}
+
+	// iterative Douglas-Peucker: keep[i] is set for the vertices that remain
+	std::vector<bool> keep(polygon.size(), false);
+	keep.front() = true;
+	keep.back() = true;
+	std::vector<std::pair<int, int>> stack{{0, static_cast<int>(polygon.size()) - 1}};
+	while (!stack.empty()) {
+		auto [first, last] = stack.back();
+		stack.pop_back();
+		QPointF a = polygon[first];
+		QPointF d = polygon[last] - a;
+		double length = std::hypot(d.x(), d.y());
+		double maxDistance = -1;
+		int farthest = -1;
+		for (int i = first + 1; i < last; i++) {
+			QPointF v = polygon[i] - a;
+			double distance = length == 0 ? std::hypot(v.x(), v.y())
+			                              : std::abs(d.x() * v.y() - d.y() * v.x()) / length;
+			if (distance > maxDistance) {
+				maxDistance = distance;
+				farthest = i;
+			}
+		}
+		if (maxDistance > tolerance) {
+			keep[farthest] = true;
+			stack.emplace_back(first, farthest);
+			stack.emplace_back(farthest, last);
+		}
+	}
+
+	QPolygonF result;
+	for (int i = 0; i < polygon.size(); i++) {
+		if (keep[i]) {
+			result << polygon[i];
+		}
+	}
+	return result;
+}
+
+QColor NetworkRenderCache::colorForDelta(double delta, double deltaMax) {
+	// bubble gum
+	if (delta == std::numeric_limits<double>::infinity()) {
+		return QColor("#49006a");
+	} else if (delta > deltaMax / 1e1) {
+		return QColor("#7a0177");
+	} else if (delta > deltaMax / 1e2) {
+		return QColor("#ae017e");
+	} else if (delta > deltaMax / 1e3) {
+		return QColor("#dd3497");
+	} else if (delta > deltaMax / 1e4) {
+		return QColor("#f768a1");
+	} else if (delta > deltaMax / 1e5) {
+		return QColor("#fa9fb5");
+	} else {
+		return QColor("#fcc5c0");
+	}
+	// orange brown
+	/*if (delta == std::numeric_limits<double>::infinity()) {
+		return QColor("#fec44f");
+	} else if (delta > deltaMax / 1e1) {
+		return QColor("#fe9929");
+	} else if (delta > deltaMax / 1e2) {
+		return QColor("#ec7014");
+	} else if (delta > deltaMax / 1e3) {
+		return QColor("#cc4c02");
+	} else if (delta > deltaMax / 1e4) {
+		return QColor("#993404");
+	} else if (delta > deltaMax / 1e5) {
+		return QColor("#662506");
+	} else {
+		return QColor("#331609");
+	}*/
+
+	// green blue
+	/*if (delta == std::numeric_limits<double>::infinity()) {
+		return QColor("#c7e9b4");
+	} else if (delta > deltaMax / 1e1) {
+		return QColor("#7fcdbb");
+	} else if (delta > deltaMax / 1e2) {
+		return QColor("#41b6c4");
+	} else if (delta > deltaMax / 1e3) {
+		return QColor("#1d91c0");
+	} else if (delta > deltaMax / 1e4) {
+		return QColor("#225ea8");
+	} else if (delta > deltaMax / 1e5) {
+		return QColor("#253494");
+	} else {
+		return QColor("#081d58");
+	}*/
+}
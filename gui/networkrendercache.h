@@ -0,0 +1,126 @@
+#ifndef NETWORKRENDERCACHE_H
+#define NETWORKRENDERCACHE_H
+
+#include <QColor>
+#include <QPainter>
+#include <QPainterPath>
+#include <QPolygonF>
+#include <QRectF>
+#include <QTransform>
+
+#include <memory>
+#include <vector>
+
+#include "networkgraph.h"
+#include "spatialindex.h"
+
+/**
+ * Cached geometry for drawing a NetworkGraph.
+ *
+ * The geometry of each edge is built once as a QPainterPath in river
+ * coordinates, so that drawing the network after panning only requires
+ * changing the painter transform. The paths are simplified with the
+ * Douglas-Peucker algorithm to a tolerance that depends on the zoom level;
+ * they are rebuilt only if the zoom level changes by a factor of two.
+ *
+ * The edges are stored in order of increasing δ-value and grouped into
+ * δ-buckets that share the same color. A SpatialIndex of the edges' bounding
+ * boxes allows skipping edges outside the viewport.
+ */
+class NetworkRenderCache {
+
+	public:
+
+		/**
+		 * Makes sure that the cache contains the geometry of the given graph,
+		 * simplified for the given zoom level. Does nothing if the cache is
+		 * already up-to-date.
+		 *
+		 * \param graph The graph.
+		 * \param zoom The zoom level (the number of pixels per river unit).
+		 * \param drawOutOfBounds Whether to include path points that are out
+		 * of bounds (that is, have an infinite height).
+		 */
+		void update(const std::shared_ptr<NetworkGraph>& graph, double zoom,
+		            bool drawOutOfBounds);
+
+		/**
+		 * Draws the edges of the graph with δ-value larger than the given
+		 * threshold. First all edges get a white casing, then the edges
+		 * themselves are drawn on top, in order of increasing δ-value.
+		 *
+		 * \param p The painter to draw with.
+		 * \param toScreen The transform from river coordinates to the
+		 * coordinates of the painter.
+		 * \param viewport The area to draw, in painter coordinates.
+		 * \param threshold The δ-threshold.
+		 */
+		void draw(QPainter& p, const QTransform& toScreen, const QRectF& viewport,
+		          double threshold);
+
+		/**
+		 * Converts a polyline into a path in which every internal vertex is
+		 * rounded off with a quadratic curve.
+		 *
+		 * \param polygon The polyline, which needs to have at least two
+		 * vertices.
+		 * \param cornerLength The distance from each internal vertex at which
+		 * the rounding starts.
+		 * \return The rounded path.
+		 */
+		static QPainterPath roundedPath(const QPolygonF& polygon, double cornerLength);
+
+		/**
+		 * Simplifies a polyline with the Douglas-Peucker algorithm. The
+		 * endpoints are always kept.
+		 *
+		 * \param polygon The polyline.
+		 * \param tolerance The maximum distance between the original
+		 * polyline and the result.
+		 * \return The simplified polyline.
+		 */
+		static QPolygonF simplify(const QPolygonF& polygon, double tolerance);
+
+	private:
+
+		/// The geometry of a single edge.
+		struct CachedEdge {
+			/// The rounded and simplified path, in river coordinates.
+			QPainterPath path;
+			/// The pen width, in pixels.
+			double width;
+		};
+
+		/// A range of consecutive edges (in order of δ-value) that are drawn
+		/// in the same color.
+		struct Bucket {
+			/// The first edge in the bucket.
+			int begin;
+			/// The color of the edges in the bucket.
+			QColor color;
+		};
+
+		/// Returns the color of an edge with the given δ-value.
+		static QColor colorForDelta(double delta, double deltaMax);
+
+		/// The graph the cache was built for.
+		std::weak_ptr<NetworkGraph> m_graph;
+		/// The zoom octave the cache was built for (see update()).
+		int m_zoomOctave = 0;
+		/// Whether out-of-bounds points were included.
+		bool m_drawOutOfBounds = false;
+
+		/// The edges, in order of increasing δ-value (that is, in the order
+		/// of NetworkGraph::edgesByDelta()).
+		std::vector<CachedEdge> m_edges;
+		/// The δ-buckets, sorted by their first edge.
+		std::vector<Bucket> m_buckets;
+
+		/// The largest pen width (including the casing), in pixels.
+		double m_maxPenWidth = 0;
+		/// The bounding boxes of the edges, in river coordinates, indexed by
+		/// their position in δ-order.
+		SpatialIndex m_index;
+};
+
+#endif // NETWORKRENDERCACHE_H
@@ -17,11 +17,17 @@ uniform sampler2D tex;
 uniform sampler2D elevationRampTex;
 
 /**
- * A texture that defines in which part of the terrain the contour has to be
- * drawn.
+ * A texture that contains for each pixel the label of the merge tree leaf it
+ * belongs to, as a 24-bit integer in the RGB channels (0 = no leaf).
  */
 uniform sampler2D contourMaskTex;
 
+/**
+ * The range of labels in which the contour has to be drawn (inclusive).
+ */
+uniform int contourFirstLabel;
+uniform int contourLastLabel;
+
 /**
  * The water level.
  */
@@ -180,7 +186,10 @@ void main() {
 	}
 
 	// draw contour
-	bool onContourMask = texture(contourMaskTex, tPos - vec2(.5 / texWidth, .5 / texHeight)).r > 0.5;
+	ivec3 labelBytes = ivec3(round(
+	    texture(contourMaskTex, tPos - vec2(.5 / texWidth, .5 / texHeight)).rgb * 255.0));
+	int label = (labelBytes.r << 16) | (labelBytes.g << 8) | labelBytes.b;
+	bool onContourMask = label >= contourFirstLabel && label <= contourLastLabel;
 	// debug: draw mask
 	//if (onContourMask && int(gl_FragCoord.x) % 2 == int(gl_FragCoord.y) % 2) {
 	//	color = vec4(1, 0, 0, 1);
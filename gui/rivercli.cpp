@@ -5,20 +5,42 @@
 #include <QFile>
 #include <QImage>
 
+#include <algorithm>
 #include <iostream>
+#include <limits>
+#include <optional>
 
 #include "boundaryreader.h"
+#include "io/binaryheightmapreader.h"
 #include "io/esrigridreader.h"
 #include "io/gdalreader.h"
+#include "io/heightmapcache.h"
 #include "io/textfilereader.h"
 #include "linksequence.h"
 #include "mscomplexcreator.h"
 #include "mscomplexsimplifier.h"
 #include "mstonetworkgraphcreator.h"
+#include "parallel.h"
 
 #include "graphwriter.h"
 #include "linksequencewriter.h"
 
+/// Returns the smallest window of the raster that contains the boundary.
+static GdalReader::Window boundingWindow(const Boundary& boundary) {
+	const std::vector<HeightMap::Coordinate>& points = boundary.path().m_points;
+	int xMin = std::numeric_limits<int>::max();
+	int yMin = std::numeric_limits<int>::max();
+	int xMax = std::numeric_limits<int>::min();
+	int yMax = std::numeric_limits<int>::min();
+	for (const HeightMap::Coordinate& c : points) {
+		xMin = std::min(xMin, c.m_x);
+		yMin = std::min(yMin, c.m_y);
+		xMax = std::max(xMax, c.m_x);
+		yMax = std::max(yMax, c.m_y);
+	}
+	return GdalReader::Window{xMin, yMin, xMax - xMin + 1, yMax - yMin + 1};
+}
+
 int RiverCli::runComputation(const QStringList& args) {
 
 	QCommandLineParser parser;
@@ -56,6 +78,20 @@ int RiverCli::runComputation(const QStringList& args) {
 				"filename");
 	parser.addOption(boundaryOption);
 
+	QCommandLineOption cacheOption(
+				QStringList() << "cache",
+				"Caches the elevation data in a binary format, so that "
+				"reading the same input file again is faster.");
+	parser.addOption(cacheOption);
+
+	QCommandLineOption threadsOption(
+				QStringList() << "threads",
+				"Sets the number of threads to use for reading the input "
+				"and for the computation. "
+				"[default: the number of hardware threads]",
+				"count");
+	parser.addOption(threadsOption);
+
 	parser.addPositionalArgument("input",
 								 "The input river dataset.",
 								 "<input>");
@@ -76,17 +112,56 @@ int RiverCli::runComputation(const QStringList& args) {
 		return 1;
 	}
 
+	int threadCount = defaultThreadCount();
+	if (parser.isSet(threadsOption)) {
+		QString value = parser.value(threadsOption);
+		bool ok = false;
+		threadCount = value.toInt(&ok);
+		if (!ok || threadCount < 1) {
+			std::cerr << "thread count (--threads) \""
+					  << value.toStdString()
+					  << "\" must be a positive integer.\n";
+			return 1;
+		}
+	}
+
 	Units units;
 
 	QString inputFile = parser.positionalArguments()[0];
 	HeightMap heightMap;
 	QString error = "[no error given]";
-	if (inputFile.endsWith(".txt")) {
-		heightMap = TextFileReader::readTextFile(inputFile, error, units);
-	} else if (inputFile.endsWith(".ascii") || inputFile.endsWith(".asc")) {
-		heightMap = EsriGridReader::readGridFile(inputFile, error, units);
-	} else {
-		heightMap = GdalReader::readGdalFile(inputFile, error, units);
+	HeightMapCache cache(HeightMapCache::defaultDirectory());
+	const bool useCache = parser.isSet(cacheOption);
+	if (useCache) {
+		heightMap = cache.read(inputFile, units);
+	}
+	if (heightMap.isEmpty()) {
+		if (inputFile.endsWith(".txt")) {
+			heightMap = TextFileReader::readTextFile(inputFile, error, units);
+		} else if (inputFile.endsWith(".tthm")) {
+			heightMap = BinaryHeightMapReader::readBinaryFile(inputFile, error, units);
+		} else if (inputFile.endsWith(".ascii") || inputFile.endsWith(".asc")) {
+			heightMap = EsriGridReader::readGridFile(inputFile, error, units, threadCount);
+		} else {
+			// if a boundary is given, read only the part of the raster that
+			// it covers, as the elevations outside of it are never used
+			// (unless the heightmap is cached, as then it should be complete)
+			std::optional<GdalReader::Window> window;
+			int width, height;
+			if (parser.isSet(boundaryOption) && !useCache &&
+			    GdalReader::readRasterSize(inputFile, width, height, error)) {
+				QString boundaryError = "";
+				Boundary boundary = BoundaryReader::readBoundary(
+				            parser.value(boundaryOption), width, height, boundaryError);
+				if (boundaryError == "") {
+					window = boundingWindow(boundary);
+				}
+			}
+			heightMap = GdalReader::readGdalFile(inputFile, error, units, threadCount, window);
+		}
+		if (useCache && !heightMap.isEmpty() && !inputFile.endsWith(".tthm")) {
+			cache.write(inputFile, heightMap, units);
+		}
 	}
 	if (heightMap.isEmpty()) {
 		std::cerr << "Could not read image or text file \""
@@ -148,33 +223,30 @@ int RiverCli::runComputation(const QStringList& args) {
 		return 1;
 	}
 
-	std::cerr << "Computing input graph...\n";
-	InputGraph inputGraph(heightMap, boundary);
+	std::cerr << "Computing input DCEL...\n";
+	auto inputDcel = std::make_shared<InputDcel>(heightMap, boundary);
 
-	if (inputGraph.containsNodata()) {
+	if (inputDcel->containsNodata()) {
 		std::cerr << "The computation cannot run as there are nodata values inside the boundary.\n";
 		return 1;
 	}
 
-	std::cerr << "Computing input DCEL...\n";
-	auto inputDcel = std::make_shared<InputDcel>(inputGraph);
-	inputDcel->computeGradientFlow();
+	inputDcel->computeGradientFlow(threadCount);
 
 	std::cerr << "Computing MS complex...     ";
 	auto msComplex = std::make_shared<MsComplex>();
 	MsComplexCreator msCreator(inputDcel, msComplex, [](int p) {
 		std::cerr << "\b\b\b\b";
 		std::cerr << std::setw(3) << p << "%";
-	});
+	}, threadCount);
 	msCreator.create();
 	std::cerr << "\n";
 
 	auto networkGraph = std::make_shared<NetworkGraph>();
 
 	std::cerr << "Simplifying MS complex...     ";
-	auto msSimplified = std::make_shared<MsComplex>(*msComplex);
 	MsComplexSimplifier msSimplifier(
-				msSimplified,
+				msComplex,
 				[](int p) {
 		std::cerr << "\b\b\b\b";
 		std::cerr << std::setw(3) << p << "%";
@@ -182,12 +254,9 @@ int RiverCli::runComputation(const QStringList& args) {
 	msSimplifier.simplify();
 	std::cerr << "\n";
 
-	std::cerr << "Compacting MS complex...\n";
-	msSimplified->compact();
-
 	std::cerr << "Converting MS complex into network...     ";
 	MsToNetworkGraphCreator networkGraphCreator(
-				msSimplified, networkGraph,
+				msComplex, networkGraph,
 				[](int p) {
 		std::cerr << "\b\b\b\b";
 		std::cerr << std::setw(3) << p << "%";
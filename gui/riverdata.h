@@ -7,12 +7,15 @@
 
 #include <memory>
 
+#ifdef EXPERIMENTAL_FINGERS_SUPPORT
+#include "fingerfinder.h"
+#endif
 #include "heightmap.h"
 #include "inputdcel.h"
-#include "inputgraph.h"
 #include "mergetree.h"
 #include "mscomplex.h"
 #include "networkgraph.h"
+#include "spatialindex.h"
 #include "units.h"
 
 /**
@@ -52,23 +55,19 @@ class RiverFrame : public QObject {
 		HeightMap m_heightMap;
 
 		/**
-		 * The input graph.
+		 * The input DCEL.
 		 *
-		 * \note Acquire inputGraphLock before reading / writing to this field.
-		 */
-		std::shared_ptr<InputGraph> m_inputGraph = nullptr;
-
-		/**
-		 * Read-write lock for inputGraph.
+		 * \note Acquire inputDcelLock before reading / writing to this field.
 		 */
-		QReadWriteLock m_inputGraphLock;
+		std::shared_ptr<InputDcel> m_inputDcel = nullptr;
 
 		/**
-		 * The input DCEL.
+		 * Spatial index of the input DCEL, used for drawing only the visible
+		 * part of it.
 		 *
 		 * \note Acquire inputDcelLock before reading / writing to this field.
 		 */
-		std::shared_ptr<InputDcel> m_inputDcel = nullptr;
+		std::shared_ptr<InputDcelIndex> m_inputDcelIndex = nullptr;
 
 		/**
 		 * Read-write lock for inputDcel.
@@ -85,6 +84,14 @@ class RiverFrame : public QObject {
 		 */
 		std::shared_ptr<MsComplex> m_msComplex = nullptr;
 
+		/**
+		 * Spatial index of the saddle edges of the Morse-Smale complex, used
+		 * for drawing only the visible part of it.
+		 *
+		 * \note Acquire msComplexLock before reading / writing to this field.
+		 */
+		std::shared_ptr<SpatialIndex> m_msComplexIndex = nullptr;
+
 		/**
 		 * Read-write lock for msComplex.
 		 */
@@ -112,6 +119,16 @@ class RiverFrame : public QObject {
 		 */
 		std::shared_ptr<InputDcel> m_simplifiedInputDcel = nullptr;
 
+		/**
+		 * Spatial index of m_simplifiedInputDcel. As the simplified input
+		 * DCEL is a copy of the input DCEL, this is the index of the input
+		 * DCEL it was copied from.
+		 *
+		 * \note Acquire m_simplifiedInputDcelLock before reading / writing to
+		 * this field.
+		 */
+		std::shared_ptr<InputDcelIndex> m_simplifiedInputDcelIndex = nullptr;
+
 		/**
 		 * Read-write lock for m_simplifiedInputDcel.
 		 */
@@ -119,6 +136,15 @@ class RiverFrame : public QObject {
 
 		std::shared_ptr<std::vector<InputDcel::Path>> m_fingers = nullptr;
 		QReadWriteLock m_fingersLock;
+
+		/**
+		 * The data computed by the FingerFinder for the half-edges and faces
+		 * of m_simplifiedInputDcel.
+		 *
+		 * \note Acquire m_simplifiedInputDcelLock before reading / writing to
+		 * this field.
+		 */
+		std::shared_ptr<FingerData> m_fingerData = nullptr;
 #endif
 };
 
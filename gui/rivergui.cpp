@@ -23,9 +23,12 @@
 #include "gradientfieldsimplifier.h"
 #endif
 #include "graphwriter.h"
+#include "io/binaryheightmapreader.h"
+#include "io/binaryheightmapwriter.h"
 #include "io/esrigridreader.h"
 #include "io/esrigridwriter.h"
 #include "io/gdalreader.h"
+#include "io/heightmapcache.h"
 #include "io/textfilereader.h"
 #include "linksequence.h"
 #include "linksequencewriter.h"
@@ -107,8 +110,10 @@ void RiverGui::createGui() {
 	        map, &RiverWidget::setPointToHighlight);
 	connect(mergeTreeDock, &MergeTreeDock::hoveredHeightChanged,
 	        map, &RiverWidget::setContourLevel);
-	connect(mergeTreeDock, &MergeTreeDock::hoveredSubtreeMaskChanged,
-	        map, &RiverWidget::setContourMask);
+	connect(mergeTreeDock, &MergeTreeDock::leafLabelsChanged,
+	        map, &RiverWidget::setContourLeafLabels);
+	connect(mergeTreeDock, &MergeTreeDock::hoveredLeafRangeChanged,
+	        map, &RiverWidget::setContourLeafRange);
 	mergeTreeDock->hide();
 
 	// settings dock
@@ -159,6 +164,12 @@ void RiverGui::createActions() {
 	openTimeSeriesAction->setToolTip("Open a series of elevation data files");
 	connect(openTimeSeriesAction, &QAction::triggered, this, &RiverGui::openFrames);
 
+	cacheElevationDataAction = new QAction("&Cache elevation data", this);
+	cacheElevationDataAction->setToolTip("Store opened elevation data in a binary format, "
+	                                     "so that opening the same file again is faster");
+	cacheElevationDataAction->setCheckable(true);
+	cacheElevationDataAction->setChecked(false);
+
 	saveFrameAction = new QAction("&Save DEM...", this);
 	saveFrameAction->setShortcuts(QKeySequence::Save);
 	saveFrameAction->setIcon(UiHelper::createIcon("document-save"));
@@ -440,6 +451,8 @@ void RiverGui::createMenu() {
 	openMenu->setIcon(UiHelper::createIcon("document-open"));
 	openMenu->addAction(openAction);
 	openMenu->addAction(openTimeSeriesAction);
+	openMenu->addSeparator();
+	openMenu->addAction(cacheElevationDataAction);
 	fileMenu->addAction(saveFrameAction);
 	fileMenu->addSeparator();
 	exportMenu = fileMenu->addMenu("Export");
@@ -651,12 +664,26 @@ void RiverGui::openFramesNamed(QStringList& fileNames) {
 std::shared_ptr<RiverFrame> RiverGui::loadFrame(const QString& fileName, Units& units) {
 	HeightMap heightMap;
 	QString error = "[no error given]";
-	if (fileName.endsWith(".txt")) {
-		heightMap = TextFileReader::readTextFile(fileName, error, units);
-	} else if (fileName.endsWith(".ascii") || fileName.endsWith(".asc")) {
-		heightMap = EsriGridReader::readGridFile(fileName, error, units);
-	} else {
-		heightMap = GdalReader::readGdalFile(fileName, error, units);
+	HeightMapCache cache(HeightMapCache::defaultDirectory());
+	const bool useCache = cacheElevationDataAction->isChecked();
+	if (useCache) {
+		heightMap = cache.read(fileName, units);
+	}
+	if (heightMap.isEmpty()) {
+		if (fileName.endsWith(".txt")) {
+			heightMap = TextFileReader::readTextFile(fileName, error, units);
+		} else if (fileName.endsWith(".tthm")) {
+			heightMap = BinaryHeightMapReader::readBinaryFile(fileName, error, units);
+		} else if (fileName.endsWith(".ascii") || fileName.endsWith(".asc")) {
+			heightMap = EsriGridReader::readGridFile(fileName, error, units,
+			                                         settingsDock->threadCount());
+		} else {
+			heightMap = GdalReader::readGdalFile(fileName, error, units,
+			                                     settingsDock->threadCount());
+		}
+		if (useCache && !heightMap.isEmpty() && !fileName.endsWith(".tthm")) {
+			cache.write(fileName, heightMap, units);
+		}
 	}
 
 	if (heightMap.isEmpty()) {
@@ -683,12 +710,17 @@ void RiverGui::saveFrame() {
 	QString fileName = QFileDialog::getSaveFileName(this,
 	        "Save DEM",
 	        ".",
-	        "ESRI grid files (*.ascii)");
+	        "ESRI grid files (*.ascii);;TopoTide binary heightmaps (*.tthm)");
 	if (fileName == nullptr) {
 		return;
 	}
 
-	EsriGridWriter::writeGridFile(activeFrame()->m_heightMap, fileName, m_riverData->units());
+	if (fileName.endsWith(".tthm")) {
+		BinaryHeightMapWriter::writeBinaryFile(activeFrame()->m_heightMap, fileName,
+		                                       m_riverData->units());
+	} else {
+		EsriGridWriter::writeGridFile(activeFrame()->m_heightMap, fileName, m_riverData->units());
+	}
 }
 
 void RiverGui::resetBoundary() {
@@ -777,9 +809,8 @@ void RiverGui::saveGraph() {
 
 	QReadLocker lock(&activeFrame()->m_networkGraphLock);
 
-	NetworkGraph graph = *activeFrame()->m_networkGraph;
-	graph.filterOnDelta(settingsDock->msThreshold());
-	GraphWriter::writeGraph(graph, m_riverData->units(), fileName);
+	GraphWriter::writeGraph(*activeFrame()->m_networkGraph, m_riverData->units(), fileName,
+	                        settingsDock->msThreshold());
 
 	statusBar()->showMessage("Saved graph as \"" + fileName + "\"", 5000);
 }
@@ -891,8 +922,9 @@ void RiverGui::startComputation(bool allFrames) {
 	map->update();
 	updateActions();
 
-	auto* thread = allFrames ? new BackgroundThread(m_riverData)
-	                         : new BackgroundThread(m_riverData, activeFrame());
+	const int threadCount = settingsDock->threadCount();
+	auto* thread = allFrames ? new BackgroundThread(m_riverData, threadCount)
+	                         : new BackgroundThread(m_riverData, activeFrame(), threadCount);
 
 	connect(thread, &BackgroundThread::taskStarted, this, [this](QString task) {
 		QThread::currentThread();
@@ -941,6 +973,7 @@ void RiverGui::computeFingers() {
 	QWriteLocker lock2(&(frame->m_msComplexLock));
 	QWriteLocker lock3(&(frame->m_simplifiedInputDcelLock));
 	frame->m_simplifiedInputDcel = std::make_shared<InputDcel>(*frame->m_inputDcel);
+	frame->m_simplifiedInputDcelIndex = frame->m_inputDcelIndex;
 
 	GradientFieldSimplifier simplifier(frame->m_simplifiedInputDcel, frame->m_msComplex,
 	                                   settingsDock->msThreshold());
@@ -949,6 +982,7 @@ void RiverGui::computeFingers() {
 	FingerFinder finder(frame->m_simplifiedInputDcel, frame->m_msComplex,
 	                    settingsDock->msThreshold());
 	frame->m_fingers = std::make_shared<std::vector<InputDcel::Path>>(finder.findFingers());
+	frame->m_fingerData = finder.data();
 	map->update();
 	updateActions();
 }
@@ -159,6 +159,7 @@ class RiverGui : public QMainWindow {
 
 		QAction* openAction;
 		QAction* openTimeSeriesAction;
+		QAction* cacheElevationDataAction;
 		QAction* saveFrameAction;
 		QAction* openBoundaryAction;
 		QAction* saveGraphAction;
@@ -20,6 +20,7 @@
 #include <algorithm>
 #include <cmath>
 #include <limits>
+#include <numeric>
 #include <optional>
 #include <vector>
 
@@ -28,6 +29,19 @@
 #include "boundary.h"
 #include "boundarycreator.h"
 #include "heightmap.h"
+#include "spatialindex.h"
+
+/// Returns the IDs of the elements in the given region according to the
+/// index, or all `count` IDs if there is no index.
+static std::vector<int> visibleElements(const SpatialIndex* index, int count,
+                                        const SpatialIndex::Box& region) {
+	if (index != nullptr) {
+		return index->query(region);
+	}
+	std::vector<int> all(count);
+	std::iota(all.begin(), all.end(), 0);
+	return all;
+}
 
 RiverWidget::RiverWidget() {
 	QSurfaceFormat format;
@@ -245,11 +259,19 @@ void RiverWidget::updateTexture() {
 	texture = new QOpenGLTexture(image);
 	texture->setWrapMode(QOpenGLTexture::ClampToEdge);
 
-	QImage maskImage(heightMap.width(), heightMap.height(), QImage::Format::Format_ARGB32);
-	maskImage.fill(QColor{"black"});
-	contourMaskTexture = new QOpenGLTexture(maskImage);
-	contourMaskTexture->setWrapMode(QOpenGLTexture::ClampToEdge);
-	contourMaskTexture->setMagnificationFilter(QOpenGLTexture::Nearest);
+	QImage labels(heightMap.width(), heightMap.height(), QImage::Format::Format_ARGB32);
+	labels.fill(QColor{"black"});
+	contourMaskTexture = createLabelTexture(labels);
+	m_contourFirstLabel = 1;
+	m_contourLastLabel = 0;
+}
+
+QOpenGLTexture* RiverWidget::createLabelTexture(const QImage& labels) {
+	// labels cannot be interpolated, so no mipmaps and no linear filtering
+	QOpenGLTexture* labelTexture = new QOpenGLTexture(labels, QOpenGLTexture::DontGenerateMipMaps);
+	labelTexture->setWrapMode(QOpenGLTexture::ClampToEdge);
+	labelTexture->setMinMagFilters(QOpenGLTexture::Nearest, QOpenGLTexture::Nearest);
+	return labelTexture;
 }
 
 void RiverWidget::updateElevationRampTexture() {
@@ -302,6 +324,8 @@ void RiverWidget::paintGL() {
 		contourMaskTexture->bind(2);
 		program->setUniformValue("contourMaskTex", 2);
 	}
+	program->setUniformValue("contourFirstLabel", m_contourFirstLabel);
+	program->setUniformValue("contourLastLabel", m_contourLastLabel);
 
 	// draw background map using OpenGL
 	QTransform transform;
@@ -360,11 +384,13 @@ void RiverWidget::paintGL() {
 #ifdef EXPERIMENTAL_FINGERS_SUPPORT
 			if (m_showSimplified && m_riverFrame->m_simplifiedInputDcel != nullptr) {
 				QReadLocker lock(&(m_riverFrame->m_simplifiedInputDcelLock));
-				drawGradientPairs(p, *m_riverFrame->m_simplifiedInputDcel);
+				drawGradientPairs(p, *m_riverFrame->m_simplifiedInputDcel,
+				                  m_riverFrame->m_simplifiedInputDcelIndex.get());
 			} else {
 #endif
 				QReadLocker lock(&(m_riverFrame->m_inputDcelLock));
-				drawGradientPairs(p, *m_riverFrame->m_inputDcel);
+				drawGradientPairs(p, *m_riverFrame->m_inputDcel,
+				                  m_riverFrame->m_inputDcelIndex.get());
 #ifdef EXPERIMENTAL_FINGERS_SUPPORT
 			}
 #endif
@@ -372,18 +398,20 @@ void RiverWidget::paintGL() {
 
 		if (m_showMsComplex && m_riverFrame->m_msComplex != nullptr) {
 			QReadLocker locker(&(m_riverFrame->m_msComplexLock));
-			drawMsComplex(p, *m_riverFrame->m_msComplex);
+			drawMsComplex(p, *m_riverFrame->m_msComplex, m_riverFrame->m_msComplexIndex.get());
 		}
 
 		if (m_showCriticalPoints && m_riverFrame->m_inputDcel != nullptr) {
 #ifdef EXPERIMENTAL_FINGERS_SUPPORT
 			if (m_showSimplified && m_riverFrame->m_simplifiedInputDcel != nullptr) {
 				QReadLocker lock(&(m_riverFrame->m_simplifiedInputDcelLock));
-				drawCriticalPoints(p, *m_riverFrame->m_simplifiedInputDcel);
+				drawCriticalPoints(p, *m_riverFrame->m_simplifiedInputDcel,
+				                   m_riverFrame->m_simplifiedInputDcelIndex.get());
 			} else {
 #endif
 				QReadLocker lock(&(m_riverFrame->m_inputDcelLock));
-				drawCriticalPoints(p, *m_riverFrame->m_inputDcel);
+				drawCriticalPoints(p, *m_riverFrame->m_inputDcel,
+				                   m_riverFrame->m_inputDcelIndex.get());
 #ifdef EXPERIMENTAL_FINGERS_SUPPORT
 			}
 #endif
@@ -405,7 +433,7 @@ void RiverWidget::paintGL() {
 
 		if (m_showNetwork && m_riverFrame->m_msComplex != nullptr &&
 		    m_riverFrame->m_networkGraph != nullptr) {
-			drawNetwork(p, *m_riverFrame->m_networkGraph);
+			drawNetwork(p, m_riverFrame->m_networkGraph);
 		}
 
 		if (m_pointToHighlight) {
@@ -582,35 +610,42 @@ void RiverWidget::drawPermeableRegion(QPainter& p, const Path& path,
 	}
 }
 
-void RiverWidget::drawCriticalPoints(QPainter& p, InputDcel& dcel) const {
+void RiverWidget::drawCriticalPoints(QPainter& p, InputDcel& dcel,
+                                     const InputDcelIndex* index) const {
 	QBrush blue(QColor(60, 90, 220));
 	QBrush green(QColor(110, 180, 90));
 	QBrush black(QColor(0, 0, 0, 127));
 	QBrush red(QColor(220, 90, 60, 127));
 
-	for (size_t i = 0; i < dcel.halfEdgeCount(); i++) {
+	SpatialIndex::Box region = visibleRegion(1);
+	for (int i : visibleElements(index ? &index->halfEdges : nullptr, dcel.halfEdgeCount(), region)) {
 		InputDcel::HalfEdge e = dcel.halfEdge(i);
 		if (e.origin().id() < e.destination().id()) {
 			continue; // avoid drawing the same edge twice
 		}
-		if (dcel.isCritical(e) && inBounds(e.data().p)) {
+		Point center = InputDcel::position(e);
+		if (dcel.isCritical(e) && inBounds(center)) {
 			p.setPen(QPen(black, 6));
-			p.drawLine(0.5 * (convertPoint(e.origin().data().p) + convertPoint(e.data().p)),
-			           0.5 * (convertPoint(e.destination().data().p) + convertPoint(e.data().p)));
+			p.drawLine(0.5 * (convertPoint(e.origin().data().p) + convertPoint(center)),
+			           0.5 * (convertPoint(e.destination().data().p) + convertPoint(center)));
 			p.setPen(QPen(green, 4));
-			p.drawLine(0.5 * (convertPoint(e.origin().data().p) + convertPoint(e.data().p)),
-			           0.5 * (convertPoint(e.destination().data().p) + convertPoint(e.data().p)));
+			p.drawLine(0.5 * (convertPoint(e.origin().data().p) + convertPoint(center)),
+			           0.5 * (convertPoint(e.destination().data().p) + convertPoint(center)));
 		}
 	}
 
-	for (size_t i = 0; i < dcel.faceCount(); i++) {
+	for (int i : visibleElements(index ? &index->faces : nullptr, dcel.faceCount(), region)) {
 		InputDcel::Face f = dcel.face(i);
-		if (dcel.isCritical(f) && inBounds(f.data().p)) {
+		if (!dcel.isCritical(f)) {
+			continue;
+		}
+		Point center = InputDcel::position(f);
+		if (inBounds(center)) {
 			p.setPen(QPen(black, 1));
 			p.setBrush(red);
 			QPolygonF face;
-			f.forAllBoundaryVertices([this, &face, &f](InputDcel::Vertex v) {
-				face << 0.25 * (3 * convertPoint(v.data().p) + convertPoint(f.data().p));
+			f.forAllBoundaryVertices([this, &face, &center](InputDcel::Vertex v) {
+				face << 0.25 * (3 * convertPoint(v.data().p) + convertPoint(center));
 			});
 			p.drawPolygon(face);
 		}
@@ -618,7 +653,7 @@ void RiverWidget::drawCriticalPoints(QPainter& p, InputDcel& dcel) const {
 
 	p.setPen(QPen(black, 1));
 	p.setBrush(blue);
-	for (size_t i = 0; i < dcel.vertexCount(); i++) {
+	for (int i : visibleElements(index ? &index->vertices : nullptr, dcel.vertexCount(), region)) {
 		InputDcel::Vertex v = dcel.vertex(i);
 		if (dcel.isCritical(v) && inBounds(v.data().p)) {
 			p.drawEllipse(convertPoint(v.data().p), 4, 4);
@@ -626,7 +661,8 @@ void RiverWidget::drawCriticalPoints(QPainter& p, InputDcel& dcel) const {
 	}
 }
 
-void RiverWidget::drawGradientPairs(QPainter& p, InputDcel& dcel) const {
+void RiverWidget::drawGradientPairs(QPainter& p, InputDcel& dcel,
+                                    const InputDcelIndex* index) const {
 	QPen blue(QBrush(QColor(60, 90, 220)), 2);
 	QPen red(QBrush(QColor(220, 90, 60)), 2);
 
@@ -634,9 +670,11 @@ void RiverWidget::drawGradientPairs(QPainter& p, InputDcel& dcel) const {
 	font.setPixelSize(10);
 	p.setFont(font);
 
-	for (size_t i = 0; i < dcel.halfEdgeCount(); i++) {
+	SpatialIndex::Box region = visibleRegion(1);
+	for (int i : visibleElements(index ? &index->halfEdges : nullptr, dcel.halfEdgeCount(), region)) {
 		InputDcel::HalfEdge e = dcel.halfEdge(i);
-		if (!inBounds(e.data().p)) {
+		Point edgeCenter = InputDcel::position(e);
+		if (!inBounds(edgeCenter)) {
 			continue;
 		}
 		if (e.data().pairedWithVertex) {
@@ -645,17 +683,22 @@ void RiverWidget::drawGradientPairs(QPainter& p, InputDcel& dcel) const {
 				p.drawLine(convertPoint(e.origin().data().p), convertPoint(e.destination().data().p));
 			} else {
 				drawArrow(p, convertPoint(e.origin().data().p),
-						(convertPoint(e.origin().data().p) + convertPoint(e.data().p)) * 0.5);
+						(convertPoint(e.origin().data().p) + convertPoint(edgeCenter)) * 0.5);
 			}
 		}
-		if (e.data().pairedWithFace && inBounds(e.incidentFace().data().p)) {
+		if (e.data().pairedWithFace && e.incidentFace() != dcel.outerFace() &&
+		        inBounds(InputDcel::position(e.incidentFace()))) {
+			Point faceCenter = InputDcel::position(e.incidentFace());
 			p.setPen(red);
 			if (m_drawGradientPairsAsTrees) {
-				if (std::isfinite(e.incidentFace().data().p.h) && std::isfinite(e.oppositeFace().data().p.h)) {
-					p.drawLine(convertPoint(e.incidentFace().data().p),
-					           convertPoint(e.twin().incidentFace().data().p));
-					if (m_transform.m11() > 50) {
-						QPointF center = convertPoint(e.data().p);
+				if (e.oppositeFace() != dcel.outerFace() && std::isfinite(faceCenter.h) &&
+				        std::isfinite(InputDcel::position(e.oppositeFace()).h)) {
+					p.drawLine(convertPoint(faceCenter),
+					           convertPoint(InputDcel::position(e.oppositeFace())));
+#ifdef EXPERIMENTAL_FINGERS_SUPPORT
+					const FingerData* fingerData = fingerDataFor(dcel);
+					if (fingerData != nullptr && m_transform.m11() > 50) {
+						QPointF center = convertPoint(edgeCenter);
 						QPointF origin = convertPoint(e.origin().data().p);
 						QPointF destination = convertPoint(e.destination().data().p);
 						QPointF vector = destination - origin;
@@ -663,7 +706,8 @@ void RiverWidget::drawGradientPairs(QPainter& p, InputDcel& dcel) const {
 						double length = std::hypot(perpendicular.x(), perpendicular.y());
 						QPointF offset = perpendicular * (10.0 / length);
 						if (rect().contains(center.toPoint())) {
-							PiecewiseLinearFunction& volume = e.data().volumeAbove;
+							PiecewiseLinearFunction volume =
+							        fingerData->halfEdges[e.id()].volumeAbove;
 							p.save();
 							p.translate(center + offset);
 							p.rotate(180 * std::atan2(-vector.y(), -vector.x()) / M_PI);
@@ -674,34 +718,37 @@ void RiverWidget::drawGradientPairs(QPainter& p, InputDcel& dcel) const {
 							p.save();
 							p.translate(center - offset);
 							p.rotate(180 * std::atan2(vector.y(), vector.x()) / M_PI);
-							PiecewiseLinearFunction twinVolume = e.twin().data().volumeAbove;
+							PiecewiseLinearFunction twinVolume =
+							        fingerData->halfEdges[e.twin().id()].volumeAbove;
 							p.drawText(QRectF(QPointF(-100, -100), QSizeF(200, 200)),
 							           Qt::AlignCenter,
 							           QString("%1 m").arg(twinVolume.heightForVolume(m_networkDelta)));
 							p.restore();
 						}
 					}
+#endif
 				}
 			} else {
-				drawArrow(p, convertPoint(e.data().p),
-						(convertPoint(e.data().p) + convertPoint(e.incidentFace().data().p)) * 0.5);
+				drawArrow(p, convertPoint(edgeCenter),
+						(convertPoint(edgeCenter) + convertPoint(faceCenter)) * 0.5);
 			}
 		}
 	}
 
 	if (m_drawGradientPairsAsTrees) {
 		p.setPen(blue);
-		for (size_t i = 0; i < dcel.vertexCount(); i++) {
+		for (int i : visibleElements(index ? &index->vertices : nullptr, dcel.vertexCount(), region)) {
 			InputDcel::Vertex v = dcel.vertex(i);
 			if (std::isfinite(v.data().p.h) && dcel.isBlueLeaf(v)) {
 				p.drawEllipse(convertPoint(v.data().p), 2, 2);
 			}
 		}
 		p.setPen(red);
-		for (size_t i = 0; i < dcel.faceCount(); i++) {
+		for (int i : visibleElements(index ? &index->faces : nullptr, dcel.faceCount(), region)) {
 			InputDcel::Face f = dcel.face(i);
-			if (std::isfinite(f.data().p.h) && dcel.isRedLeaf(f)) {
-				p.drawEllipse(convertPoint(f.data().p), 2, 2);
+			if (f != dcel.outerFace() && std::isfinite(InputDcel::position(f).h) &&
+			        dcel.isRedLeaf(f)) {
+				p.drawEllipse(convertPoint(InputDcel::position(f)), 2, 2);
 			}
 		}
 	}
@@ -719,14 +766,19 @@ void RiverWidget::drawSpurs(QPainter& p, InputDcel& dcel) const {
 	p.setPen(Qt::NoPen);
 	p.setOpacity(0.2);
 
+	const FingerData* fingerData = fingerDataFor(dcel);
+	if (fingerData == nullptr) {
+		return;
+	}
+
 	int color = 0;
 	for (size_t i = 0; i < dcel.faceCount(); i++) {
 		InputDcel::Face f = dcel.face(i);
-		if (std::isfinite(f.data().p.h) && dcel.isRedLeaf(f)) {
-			if (f.data().isSignificant) {
+		if (f != dcel.outerFace() && dcel.isRedLeaf(f)) {
+			if (fingerData->faces[i].isSignificant) {
 				p.setBrush(QBrush(colors[color++ % colors.size()]));
 				QPolygonF polygon;
-				for (int vId : f.data().spurBoundary) {
+				for (int vId : fingerData->faces[i].spurBoundary) {
 					polygon << convertPoint(dcel.vertex(vId).data().p);
 				}
 				p.drawPath(makePathRounded(polygon));
@@ -741,11 +793,11 @@ void RiverWidget::drawSpurs(QPainter& p, InputDcel& dcel) const {
 	color = 0;
 	for (size_t i = 0; i < dcel.faceCount(); i++) {
 		InputDcel::Face f = dcel.face(i);
-		if (std::isfinite(f.data().p.h) && dcel.isRedLeaf(f)) {
-			if (f.data().isSignificant) {
+		if (f != dcel.outerFace() && dcel.isRedLeaf(f)) {
+			if (fingerData->faces[i].isSignificant) {
 				p.setPen(QPen(colors[color++ % colors.size()], 1));
 				QPolygonF polygon;
-				for (int vId : f.data().spurBoundary) {
+				for (int vId : fingerData->faces[i].spurBoundary) {
 					polygon << convertPoint(dcel.vertex(vId).data().p);
 				}
 				p.drawPath(makePathRounded(polygon));
@@ -762,26 +814,28 @@ void RiverWidget::drawSpurs(QPainter& p, InputDcel& dcel) const {
 	color = 0;
 	for (size_t i = 0; i < dcel.faceCount(); i++) {
 		InputDcel::Face f = dcel.face(i);
-		if (std::isfinite(f.data().p.h) && dcel.isRedLeaf(f)) {
-			if (f.data().isSignificant) {
+		if (f != dcel.outerFace() && dcel.isRedLeaf(f)) {
+			const FingerData::Face& faceData = fingerData->faces[i];
+			if (faceData.isSignificant) {
 				p.setPen(QPen(colors[color++ % colors.size()], 2));
-				p.drawEllipse(convertPoint(f.data().p), 4, 4);
-				double flankingHeight = f.data().flankingHeight;
+				p.drawEllipse(convertPoint(InputDcel::position(f)), 4, 4);
+				double flankingHeight = faceData.flankingHeight;
 				p.drawText(
-					QRectF(convertPoint(f.data().p) + QPointF(-100, -87), QSizeF(200, 200)),
+					QRectF(convertPoint(InputDcel::position(f)) + QPointF(-100, -87), QSizeF(200, 200)),
 					Qt::AlignCenter, QString("%1 m").arg(flankingHeight));
 
 				// draw path upwards until top edge
 				QPolygonF path;
-				for (int faceId : f.data().pathToTopEdge) {
+				for (int faceId : faceData.pathToTopEdge) {
 					InputDcel::Face face = dcel.face(faceId);
-					path << convertPoint(face.data().p);
+					path << convertPoint(InputDcel::position(face));
 				}
-				InputDcel::HalfEdge topEdge = dcel.halfEdge(f.data().topEdge);
-				path << convertPoint(topEdge.data().p);
+				InputDcel::HalfEdge topEdge = dcel.halfEdge(faceData.topEdge);
+				path << convertPoint(InputDcel::position(topEdge));
 				p.drawPath(makePathRounded(path));
-				if (std::isfinite(topEdge.oppositeFace().data().p.h)) {
-					drawArrow(p, convertPoint(topEdge.data().p), convertPoint(topEdge.oppositeFace().data().p));
+				if (topEdge.oppositeFace() != dcel.outerFace()) {
+					drawArrow(p, convertPoint(InputDcel::position(topEdge)),
+					          convertPoint(InputDcel::position(topEdge.oppositeFace())));
 				}
 			}
 		}
@@ -789,6 +843,17 @@ void RiverWidget::drawSpurs(QPainter& p, InputDcel& dcel) const {
 }
 #endif
 
+#ifdef EXPERIMENTAL_FINGERS_SUPPORT
+const FingerData* RiverWidget::fingerDataFor(const InputDcel& dcel) const {
+	// the finger data is computed for the simplified input DCEL only
+	if (m_riverFrame == nullptr || m_riverFrame->m_fingerData == nullptr ||
+	        &dcel != m_riverFrame->m_simplifiedInputDcel.get()) {
+		return nullptr;
+	}
+	return m_riverFrame->m_fingerData.get();
+}
+#endif
+
 void RiverWidget::drawArrow(QPainter& p, const QPointF& p1, const QPointF& p2) const {
 	p.drawLine(p1, p2);
 	QPointF difference = p2 - p1;
@@ -797,12 +862,13 @@ void RiverWidget::drawArrow(QPainter& p, const QPointF& p1, const QPointF& p2) c
 	p.drawLine(p2, 0.5 * (p1 + p2) - 0.25 * perpendicular);
 }
 
-void RiverWidget::drawMsComplex(QPainter& p, MsComplex& msComplex) const {
+void RiverWidget::drawMsComplex(QPainter& p, MsComplex& msComplex,
+                                const SpatialIndex* index) const {
 	QPen blue(QBrush(QColor(60, 90, 220)), 3);
 	p.setBrush(Qt::NoBrush);
 	p.setPen(blue);
 
-	for (int i = 0; i < msComplex.halfEdgeCount(); i++) {
+	for (int i : visibleElements(index, msComplex.halfEdgeCount(), visibleRegion(1))) {
 
 		MsComplex::HalfEdge e = msComplex.halfEdge(i);
 		if (e.isRemoved()) {
@@ -816,8 +882,8 @@ void RiverWidget::drawMsComplex(QPainter& p, MsComplex& msComplex) const {
 				           convertPoint(e.destination().data().p.x, e.destination().data().p.y));
 			} else {
 				QPolygonF path;
-				InputDcel::HalfEdge saddle = e.data().m_dcelPath.edges()[0];
-				path << convertPoint(saddle.data().p.x, saddle.data().p.y);
+				Point saddle = InputDcel::position(e.data().m_dcelPath.firstEdge());
+				path << convertPoint(saddle.x, saddle.y);
 				e.data().m_dcelPath.forAllVertices([this, &path, &e](InputDcel::Vertex v) {
 					if (v != e.data().m_dcelPath.origin()) {
 						path << convertPoint(v.data().p.x, v.data().p.y);
@@ -843,23 +909,7 @@ void RiverWidget::drawMsComplex(QPainter& p, MsComplex& msComplex) const {
 }
 
 QPainterPath RiverWidget::makePathRounded(const QPolygonF& path) const {
-	QPainterPath result;
-	result.moveTo(path[0]);
-	// for all internal vertices
-	for (int i = 1; i < path.size() - 1; ++i) {
-		QPointF p1 = path[i - 1];
-		QPointF p2 = path[i];
-		QPointF p3 = path[i + 1];
-		double l21 = QLineF(p1, p2).length();
-		double l23 = QLineF(p3, p2).length();
-		double pixelLength = m_transform.m11() * 0.3;
-		QPointF p21 = p2 + (p1 - p2) * (pixelLength / l21);
-		QPointF p23 = p2 + (p3 - p2) * (pixelLength / l23);
-		result.lineTo(p21);
-		result.quadTo(p2, p23);
-	}
-	result.lineTo(path[path.size() - 1]);
-	return result;
+	return NetworkRenderCache::roundedPath(path, m_transform.m11() * 0.3);
 }
 
 void RiverWidget::drawVertex(QPainter& p, Point p1, VertexType type) const {
@@ -899,127 +949,24 @@ void RiverWidget::drawMsEdge(QPainter& p, MsComplex::HalfEdge e) const {
 		if (e.origin().data().type == VertexType::minimum) {
 			e = e.twin();
 		}
-		for (auto l : e.data().m_dcelPath.edges()) {
+		for (InputDcel::HalfEdge l : e.data().m_dcelPath) {
 			p.drawLine(convertPoint(l.origin().data().p.x, l.origin().data().p.y),
 			           convertPoint(l.destination().data().p.x, l.destination().data().p.y));
 		}
 	}
 }
 
-void RiverWidget::drawNetwork(QPainter& p, const NetworkGraph& graph) const {
-	// sort edges on delta
-	double deltaMax = 0;
-	std::vector<NetworkGraph::Edge> edges;
-	for (int i = 0; i < graph.edgeCount(); i++) {
-		const NetworkGraph::Edge& e = graph.edge(i);
-		if (e.delta < std::numeric_limits<double>::infinity()) {
-			deltaMax = std::max(deltaMax, e.delta);
-		}
-		if (e.delta > m_networkDelta) {
-			edges.push_back(e);
-		}
-	}
-	std::sort(edges.begin(), edges.end(),
-	          [](NetworkGraph::Edge e1, NetworkGraph::Edge e2) { return e1.delta < e2.delta; });
-
-	// draw white casing
-	for (NetworkGraph::Edge& e : edges) {
-		double delta = e.delta;
-		QColor color;
-		double width = 4;
-		if (delta < std::numeric_limits<double>::infinity()) {
-			width = std::max(1.5, 3 - 0.5 * log10(deltaMax / delta));
-		}
-		p.setPen(QPen(QColor{"white"}, width + 2));
-		p.setBrush(Qt::NoBrush);
-		drawGraphEdge(p, e);
-	}
+void RiverWidget::drawNetwork(QPainter& p, const std::shared_ptr<NetworkGraph>& graph) const {
+	m_networkRenderCache.update(graph, m_transform.m11(), m_drawOutOfBounds);
 
-	// draw colored edges
-	for (NetworkGraph::Edge& e : edges) {
-		double delta = e.delta;
-		QColor color;
-		// bubble gum
-		if (delta == std::numeric_limits<double>::infinity()) {
-			color = QColor("#49006a");
-		} else if (delta > deltaMax / 1e1) {
-			color = QColor("#7a0177");
-		} else if (delta > deltaMax / 1e2) {
-			color = QColor("#ae017e");
-		} else if (delta > deltaMax / 1e3) {
-			color = QColor("#dd3497");
-		} else if (delta > deltaMax / 1e4) {
-			color = QColor("#f768a1");
-		} else if (delta > deltaMax / 1e5) {
-			color = QColor("#fa9fb5");
-		} else {
-			color = QColor("#fcc5c0");
-		}
-		// orange brown
-		/*if (delta == std::numeric_limits<double>::infinity()) {
-			color = QColor("#fec44f");
-		} else if (delta > deltaMax / 1e1) {
-			color = QColor("#fe9929");
-		} else if (delta > deltaMax / 1e2) {
-			color = QColor("#ec7014");
-		} else if (delta > deltaMax / 1e3) {
-			color = QColor("#cc4c02");
-		} else if (delta > deltaMax / 1e4) {
-			color = QColor("#993404");
-		} else if (delta > deltaMax / 1e5) {
-			color = QColor("#662506");
-		} else {
-			color = QColor("#331609");
-		}*/
-
-		// green blue
-		/*if (delta == std::numeric_limits<double>::infinity()) {
-			color = QColor("#c7e9b4");
-		} else if (delta > deltaMax / 1e1) {
-			color = QColor("#7fcdbb");
-		} else if (delta > deltaMax / 1e2) {
-			color = QColor("#41b6c4");
-		} else if (delta > deltaMax / 1e3) {
-			color = QColor("#1d91c0");
-		} else if (delta > deltaMax / 1e4) {
-			color = QColor("#225ea8");
-		} else if (delta > deltaMax / 1e5) {
-			color = QColor("#253494");
-		} else {
-			color = QColor("#081d58");
-		}*/
-		double width = 4;
-		if (delta < std::numeric_limits<double>::infinity()) {
-			width = std::max(1.5, 3 - 0.5 * log10(deltaMax / delta));
-		}
-		p.setPen(QPen(color, width));
-		p.setBrush(Qt::NoBrush);
-		drawGraphEdge(p, e);
-	}
-
-	/*for (int i = 0; i < graph->vertexCount(); i++) {
-		drawVertex(p, (*graph)[i].p, VertexType::maximum);
-	}*/
-}
-
-void RiverWidget::drawGraphEdge(QPainter& p, const NetworkGraph::Edge& e) const {
-	if (e.path.size() < 2) {
-		return;
-	}
+	// the transform that convertPoint() applies
+	QTransform toScreen = QTransform::fromTranslate(0.5 - m_riverFrame->m_heightMap.width() / 2.0,
+	                                                0.5 - m_riverFrame->m_heightMap.height() / 2.0);
+	toScreen *= m_transform;
+	toScreen *= QTransform::fromScale(1, m_units.m_yResolution / m_units.m_xResolution);
+	toScreen *= QTransform::fromTranslate(width() / 2.0, height() / 2.0);
 
-	QPolygonF path;
-	if (inBounds(e.path[0]) && inBounds(e.path[1])) {
-		path << convertPoint((e.path[0].x + e.path[1].x) / 2, (e.path[0].y + e.path[1].y) / 2);
-	}
-	for (int i = 1; i < e.path.size(); i++) {
-		if (inBounds(e.path[i])) {
-			path << convertPoint(e.path[i].x, e.path[i].y);
-		}
-	}
-	if (path.size() <= 1) {
-		return;
-	}
-	p.drawPath(makePathRounded(path));
+	m_networkRenderCache.draw(p, toScreen, rect(), m_networkDelta);
 }
 
 void RiverWidget::drawFingers(QPainter& p, const std::vector<InputDcel::Path>& fingers) const {
@@ -1058,12 +1005,12 @@ QPolygonF RiverWidget::polygonForMsFace(MsComplex::Face f) const {
 	} else {
 		f.forAllBoundaryEdges([&p, this](MsComplex::HalfEdge e) {
 			if (e.origin().data().type == VertexType::minimum) {
-				for (int i = e.twin().data().m_dcelPath.length() - 1; i >= 0; i--) {
-					InputDcel::HalfEdge l = e.twin().data().m_dcelPath.edges()[i];
-					p.append(convertPoint(l.destination().data().p));
+				InputDcel::Path path = e.twin().data().m_dcelPath.reversed();
+				for (InputDcel::HalfEdge l : path.edges()) {
+					p.append(convertPoint(l.origin().data().p));
 				}
 			} else {
-				for (auto l : e.data().m_dcelPath.edges()) {
+				for (InputDcel::HalfEdge l : e.data().m_dcelPath) {
 					p.append(convertPoint(l.origin().data().p));
 				}
 			}
@@ -1130,6 +1077,15 @@ QPointF RiverWidget::convertPoint(double x, double y) const {
 	return mapped + QPointF(width(), height()) / 2;
 }
 
+SpatialIndex::Box RiverWidget::visibleRegion(double margin) const {
+	QPointF topLeft = inverseConvertPoint(QPointF(0, 0));
+	QPointF bottomRight = inverseConvertPoint(QPointF(width(), height()));
+	return SpatialIndex::Box{std::min(topLeft.x(), bottomRight.x()) - margin,
+	                         std::min(topLeft.y(), bottomRight.y()) - margin,
+	                         std::max(topLeft.x(), bottomRight.x()) + margin,
+	                         std::max(topLeft.y(), bottomRight.y()) + margin};
+}
+
 QPointF RiverWidget::inverseConvertPoint(QPointF p) const {
 	double stretchFactor = m_units.m_yResolution / m_units.m_xResolution;
 	QPointF toMap = p - QPointF(width(), height()) / 2;
@@ -1376,10 +1332,20 @@ void RiverWidget::setPointToHighlight(std::optional<Point> point) {
 	update();
 }
 
-void RiverWidget::setContourMask(QImage mask) {
-	contourMaskTexture = new QOpenGLTexture(mask);
-	contourMaskTexture->setWrapMode(QOpenGLTexture::ClampToEdge);
-	contourMaskTexture->setMagnificationFilter(QOpenGLTexture::Nearest);
+void RiverWidget::setContourLeafLabels(QImage labels) {
+	makeCurrent();
+	delete contourMaskTexture;
+	contourMaskTexture = createLabelTexture(labels);
+	doneCurrent();
+	update();
+}
+
+void RiverWidget::setContourLeafRange(int first, int last) {
+	if (first == m_contourFirstLabel && last == m_contourLastLabel) {
+		return;
+	}
+	m_contourFirstLabel = first;
+	m_contourLastLabel = last;
 	update();
 }
 
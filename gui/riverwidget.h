@@ -20,6 +20,7 @@
 #include "colorramp.h"
 #include "mscomplex.h"
 #include "networkgraph.h"
+#include "networkrendercache.h"
 #include "point.h"
 #include "units.h"
 
@@ -85,7 +86,8 @@ class RiverWidget : public QOpenGLWidget {
 		void setShowNetwork(bool showNetwork);
 		void setNetworkDelta(double networkDelta);
 		void setPointToHighlight(std::optional<Point> point);
-		void setContourMask(QImage mask);
+		void setContourLeafLabels(QImage labels);
+		void setContourLeafRange(int first, int last);
 #ifdef EXPERIMENTAL_FINGERS_SUPPORT
 		void setShowSpurs(bool showSpurs);
 		void setShowFingers(bool showFingers);
@@ -157,25 +159,32 @@ class RiverWidget : public QOpenGLWidget {
 		void drawPath(QPainter& p, const Path& path) const;
 	    void drawPermeableRegion(QPainter& p, const Path& path,
 	                             const Boundary::Region& region) const;
-	    void drawCriticalPoints(QPainter& p, InputDcel& dcel) const;
-		void drawGradientPairs(QPainter& p, InputDcel& dcel) const;
+	    void drawCriticalPoints(QPainter& p, InputDcel& dcel, const InputDcelIndex* index) const;
+		void drawGradientPairs(QPainter& p, InputDcel& dcel, const InputDcelIndex* index) const;
 	    void drawArrow(QPainter& p, const QPointF& p1, const QPointF& p2) const;
 #ifdef EXPERIMENTAL_FINGERS_SUPPORT
 		void drawSpurs(QPainter& p, InputDcel& dcel) const;
+		/// Returns the finger data computed for the given DCEL, or `nullptr`
+		/// if no finger data is available for it.
+		const FingerData* fingerDataFor(const InputDcel& dcel) const;
 #endif
 	    void drawInputDcel(QPainter& p, InputDcel& dcel) const;
-		void drawMsComplex(QPainter& p, MsComplex& msComplex) const;
+		void drawMsComplex(QPainter& p, MsComplex& msComplex, const SpatialIndex* index) const;
 		QPainterPath makePathRounded(const QPolygonF& path) const;
 		void drawVertex(QPainter& p, Point p1, VertexType type) const;
 		void drawMsEdge(QPainter& p, MsComplex::HalfEdge e) const;
-		void drawNetwork(QPainter& p, const NetworkGraph& graph) const;
-		void drawGraphEdge(QPainter& p, const NetworkGraph::Edge& e) const;
+		void drawNetwork(QPainter& p, const std::shared_ptr<NetworkGraph>& graph) const;
+		/// Geometry of the network, kept between paints.
+		mutable NetworkRenderCache m_networkRenderCache;
 		void drawFingers(QPainter& p, const std::vector<InputDcel::Path>& fingers) const;
 		QPolygonF polygonForMsFace(MsComplex::Face f) const;
 		QPointF convertPoint(Point p) const;
 		QPointF convertPoint(HeightMap::Coordinate c) const;
 		QPointF convertPoint(double x, double y) const;
 		QPointF inverseConvertPoint(QPointF p) const;
+		/// Returns the part of the river that is visible in the widget,
+		/// extended by the given margin (in river coordinates).
+		SpatialIndex::Box visibleRegion(double margin) const;
 		std::optional<int> hoveredPathVertex(const Path& p) const;
 		std::optional<int> hoveredNonPermeableBoundaryVertex(const Boundary& b) const;
 
@@ -195,11 +204,18 @@ class RiverWidget : public QOpenGLWidget {
 		std::shared_ptr<RiverData> m_riverData;
 		std::shared_ptr<RiverFrame> m_riverFrame;
 
+		/// Creates a texture for the given leaf label image.
+		QOpenGLTexture* createLabelTexture(const QImage& labels);
+
 		QOpenGLShaderProgram* program;
 		QOpenGLTexture* texture = nullptr;
 		QOpenGLTexture* elevationRampTexture = nullptr;
-		/// texture that masks where the contour is shown (black = not shown, white = shown)
+		/// texture that contains for each pixel the label of the merge tree
+		/// leaf it belongs to (encoded in RGB, 0 = no leaf)
 		QOpenGLTexture* contourMaskTexture = nullptr;
+		/// the contour is shown on pixels whose label is in this range
+		int m_contourFirstLabel = 1;
+		int m_contourLastLabel = 0;
 		QOpenGLFunctions_4_5_Core* gl;
 
 		ColorRamp m_colorRamp;
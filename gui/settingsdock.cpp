@@ -4,6 +4,7 @@
 
 #include "settingsdock.h"
 
+#include "parallel.h"
 #include "unitshelper.h"
 
 SettingsDock::SettingsDock(QWidget* parent) :
@@ -17,6 +18,7 @@ SettingsDock::SettingsDock(QWidget* parent) :
 
 	layout->setRowStretch(0, 1);
 	layout->setRowStretch(1, 1);
+	layout->setColumnStretch(0, 1);
 
 	msThresholdSlider = new QSlider(Qt::Horizontal, settingsWidget);
 	msThresholdSlider->setRange(0, 800); // threshold from 10^0 to 10^8
@@ -34,6 +36,15 @@ SettingsDock::SettingsDock(QWidget* parent) :
 	connect(msThresholdSlider, &QSlider::valueChanged,
 	        [this] { emit msThresholdChanged(msThresholdSlider->value()); });
 
+	threadCountBox = new QSpinBox(settingsWidget);
+	threadCountBox->setRange(1, 256);
+	threadCountBox->setValue(defaultThreadCount());
+	threadCountBox->setToolTip("<p><b>Threads</b></p>"
+	                           "<p>The number of threads to use for the computation. "
+	                           "This does not influence the result.</p>");
+	layout->addWidget(threadCountBox, 0, 1, Qt::AlignBottom);
+	layout->addWidget(new QLabel("Threads"), 1, 1, Qt::AlignHCenter | Qt::AlignTop);
+
 	updateLabels();
 }
 
@@ -41,6 +52,10 @@ double SettingsDock::msThreshold() {
 	return pow(10, msThresholdSlider->value() / 100.0);
 }
 
+int SettingsDock::threadCount() {
+	return threadCountBox->value();
+}
+
 void SettingsDock::setUnits(Units units) {
 	m_units = units;
 	updateLabels();
@@ -6,6 +6,7 @@
 #include <QDockWidget>
 #include <QLabel>
 #include <QSlider>
+#include <QSpinBox>
 #include <QStackedWidget>
 #include <QWidget>
 
@@ -35,6 +36,14 @@ class SettingsDock : public QDockWidget {
 		 */
 		double msThreshold();
 
+		/**
+		 * Returns the currently set number of threads to use for the
+		 * computation.
+		 *
+		 * \return The thread count.
+		 */
+		int threadCount();
+
 	public slots:
 		void setUnits(Units units);
 
@@ -45,6 +54,7 @@ class SettingsDock : public QDockWidget {
 		QWidget* settingsWidget;
 		QLabel* msThresholdLabel;
 		QSlider* msThresholdSlider;
+		QSpinBox* threadCountBox;
 
 		Units m_units;
 
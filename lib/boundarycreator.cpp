@@ -2,11 +2,12 @@
 #include "heightmap.h"
 #include "path.h"
 #include <cmath>
+#include <limits>
 #include <optional>
 
 BoundaryCreator::BoundaryCreator(HeightMap heightMap)
     : m_heightMap(heightMap) {
-	m_inputDcel = InputDcel(InputGraph(heightMap));
+	m_inputDcel = InputDcel(heightMap, Boundary(heightMap));
 }
 
 void BoundaryCreator::setSeed(HeightMap::Coordinate seed) {
@@ -20,8 +21,17 @@ void BoundaryCreator::setSeed(HeightMap::Coordinate seed) {
 		m_path = std::nullopt;
 		return;
 	}
+	// The position of a face; the outer face is placed at (-1, -1), with
+	// height -∞.
+	auto positionOf = [this](Face f) {
+		if (f == m_inputDcel.outerFace()) {
+			return Point{-1, -1, -std::numeric_limits<double>::infinity()};
+		}
+		return InputDcel::position(f);
+	};
+
 	Face startFace = startVertex.incidentFace();  // TODO pick suitable one
-	if (!std::isfinite(startFace.data().p.h)) {
+	if (!std::isfinite(positionOf(startFace).h)) {
 		m_path = std::nullopt;
 		return;
 	}
@@ -31,15 +41,15 @@ void BoundaryCreator::setSeed(HeightMap::Coordinate seed) {
 	// corner cases where we run out of the grid)
 	std::vector<std::vector<bool>> reached(m_heightMap.width() + 2,
 	                                       std::vector<bool>(m_heightMap.height() + 2, false));
-	int x = static_cast<int>(startFace.data().p.x);
-	int y = static_cast<int>(startFace.data().p.y);
+	int x = static_cast<int>(positionOf(startFace).x);
+	int y = static_cast<int>(positionOf(startFace).y);
 	reached[x + 1][y + 1] = true;  // + 1 because of the boundary
 
 	startFace.forAllReachableFaces(
-	    [&reached](HalfEdge e) -> bool {
+	    [&reached, &positionOf](HalfEdge e) -> bool {
 		    Face f = e.oppositeFace();
-		    int x = static_cast<int>(f.data().p.x);
-		    int y = static_cast<int>(f.data().p.y);
+		    int x = static_cast<int>(positionOf(f).x);
+		    int y = static_cast<int>(positionOf(f).y);
 		    if (reached[x + 1][y + 1]) {
 				return false;
 			}
@@ -51,9 +61,9 @@ void BoundaryCreator::setSeed(HeightMap::Coordinate seed) {
 		    });
 		    return !faceHasNodata;
 	    },
-	    [&reached](Face f, HalfEdge) {
-		    int x = static_cast<int>(f.data().p.x);
-		    int y = static_cast<int>(f.data().p.y);
+	    [&reached, &positionOf](Face f, HalfEdge) {
+		    int x = static_cast<int>(positionOf(f).x);
+		    int y = static_cast<int>(positionOf(f).y);
 		    reached[x + 1][y + 1] = true;
 	    });
 
@@ -5,53 +5,145 @@
 #include <functional>
 #include <iomanip>
 #include <iostream>
+#include <iterator>
 #include <queue>
 #include <type_traits>
 #include <vector>
 
 /**
- * \brief A doubly-connected edge list.
- *
- * An implementation of a doubly-connected edge list (DCEL), a data structure
- * that stores a planar subdivision. A DCEL consists of vertices, edges and
- * faces, that are connected to each other in such a way that it is easy to
- * traverse the subdivision. Every edge is stored twice, one for each
- * direction; both halves are called half-edges. A half-edge, representing
- * one side of an edge, is incident to only one face.
+ * \brief Default storage policy for the Dcel: an array of structs.
  *
- * A cycle of a half-edge and its twin is supposed to run in counter-clockwise
- * order.
+ * A storage policy stores the pointers, removed flags and data of the
+ * vertices, half-edges and faces of a Dcel, which refers to them by their IDs.
+ * The Dcel accesses its elements only through the accessors of the storage
+ * policy, so that alternative policies can lay out (or compute) them
+ * differently.
  *
- * Vertices have a pointer to
+ * This policy stores each vertex, half-edge and face as one struct containing
+ * both its pointers and its data.
  *
- * * an arbitrary outgoing half-edge.
- *
- * Half-edges have a pointer to
- *
- * * its origin vertex;
- * * its incident face;
- * * its previous and next half-edges on the incident face;
- * * its twin (the opposite half-edge).
- *
- * Faces have a pointer to
- *
- * * an arbitrary half-edge on the boundary.
- *
- * In this class, the pointers are implemented as indexes into the list of
- * vertices, the list of edges and the list of faces.
- *
- * Furthermore, vertices, half-edges and faces can carry data of an arbitrary
- * type.
- *
- * \tparam VertexData The vertex data type; needs to be default-constructible.
- * \tparam HalfEdgeData The half-edge data type; needs to be
- * default-constructible.
- * \tparam FaceData The face data type; needs to be default-constructible.
+ * \tparam VertexData The vertex data type.
+ * \tparam HalfEdgeData The half-edge data type.
+ * \tparam FaceData The face data type.
  */
 template<typename VertexData, typename HalfEdgeData, typename FaceData>
-class Dcel {
+class DcelAosStorage {
+
+	public:
+
+		/// \name Vertices
+		///@{
+		int vertexCount() const {
+			return m_vertices.size();
+		}
+		int addVertex() {
+			m_vertices.emplace_back();
+			return m_vertices.size() - 1;
+		}
+		VertexData& vertexData(int v) {
+			return m_vertices[v].m_data;
+		}
+		const VertexData& vertexData(int v) const {
+			return m_vertices[v].m_data;
+		}
+		int outgoing(int v) const {
+			return m_vertices[v].m_outgoing;
+		}
+		void setOutgoing(int v, int e) {
+			m_vertices[v].m_outgoing = e;
+		}
+		bool isVertexRemoved(int v) const {
+			return m_vertices[v].removed;
+		}
+		void setVertexRemoved(int v) {
+			m_vertices[v].removed = true;
+		}
+		///@}
+
+		/// \name Half-edges
+		///@{
+		int halfEdgeCount() const {
+			return m_halfEdges.size();
+		}
+		int addHalfEdge() {
+			m_halfEdges.emplace_back();
+			return m_halfEdges.size() - 1;
+		}
+		HalfEdgeData& halfEdgeData(int e) {
+			return m_halfEdges[e].m_data;
+		}
+		const HalfEdgeData& halfEdgeData(int e) const {
+			return m_halfEdges[e].m_data;
+		}
+		int origin(int e) const {
+			return m_halfEdges[e].m_origin;
+		}
+		void setOrigin(int e, int v) {
+			m_halfEdges[e].m_origin = v;
+		}
+		int twin(int e) const {
+			return m_halfEdges[e].m_twin;
+		}
+		void setTwin(int e, int twin) {
+			m_halfEdges[e].m_twin = twin;
+		}
+		int previous(int e) const {
+			return m_halfEdges[e].m_previous;
+		}
+		void setPrevious(int e, int previous) {
+			m_halfEdges[e].m_previous = previous;
+		}
+		int next(int e) const {
+			return m_halfEdges[e].m_next;
+		}
+		void setNext(int e, int next) {
+			m_halfEdges[e].m_next = next;
+		}
+		int incidentFace(int e) const {
+			return m_halfEdges[e].m_incidentFace;
+		}
+		void setIncidentFace(int e, int f) {
+			m_halfEdges[e].m_incidentFace = f;
+		}
+		bool isHalfEdgeRemoved(int e) const {
+			return m_halfEdges[e].removed;
+		}
+		void setHalfEdgeRemoved(int e) {
+			m_halfEdges[e].removed = true;
+		}
+		///@}
+
+		/// \name Faces
+		///@{
+		int faceCount() const {
+			return m_faces.size();
+		}
+		int addFace() {
+			m_faces.emplace_back();
+			return m_faces.size() - 1;
+		}
+		FaceData& faceData(int f) {
+			return m_faces[f].m_data;
+		}
+		const FaceData& faceData(int f) const {
+			return m_faces[f].m_data;
+		}
+		int boundary(int f) const {
+			return m_faces[f].m_boundary;
+		}
+		void setBoundary(int f, int e) {
+			m_faces[f].m_boundary = e;
+		}
+		bool isFaceRemoved(int f) const {
+			return m_faces[f].removed;
+		}
+		void setFaceRemoved(int f) {
+			m_faces[f].removed = true;
+		}
+		///@}
+
+	private:
 
-	protected:
 
 		/**
 		 * The pointers of a vertex in the DCEL.
@@ -136,6 +228,230 @@ class Dcel {
 			bool removed = false;
 		};
 
+		/**
+		 * The list of vertices.
+		 */
+		std::vector<VertexImpl> m_vertices;
+
+		/**
+		 * The list of half-edges.
+		 */
+		std::vector<HalfEdgeImpl> m_halfEdges;
+
+		/**
+		 * The list of faces.
+		 */
+		std::vector<FaceImpl> m_faces;
+};
+
+/**
+ * \brief Storage policy for the Dcel that stores each field in a separate
+ * array.
+ *
+ * Every pointer, the removed flags and the data are kept in their own arrays
+ * (a struct-of-arrays layout). Compared to DcelAosStorage, a loop that only
+ * follows pointers then does not need to stride over the (possibly large)
+ * element data, and vice versa.
+ *
+ * \tparam VertexData The vertex data type.
+ * \tparam HalfEdgeData The half-edge data type.
+ * \tparam FaceData The face data type.
+ */
+template<typename VertexData, typename HalfEdgeData, typename FaceData>
+class DcelSoaStorage {
+
+	public:
+
+		/// \name Vertices
+		///@{
+		int vertexCount() const {
+			return m_vertexData.size();
+		}
+		int addVertex() {
+			m_vertexData.emplace_back();
+			m_outgoing.push_back(-1);
+			m_vertexRemoved.push_back(false);
+			return m_vertexData.size() - 1;
+		}
+		VertexData& vertexData(int v) {
+			return m_vertexData[v];
+		}
+		const VertexData& vertexData(int v) const {
+			return m_vertexData[v];
+		}
+		int outgoing(int v) const {
+			return m_outgoing[v];
+		}
+		void setOutgoing(int v, int e) {
+			m_outgoing[v] = e;
+		}
+		bool isVertexRemoved(int v) const {
+			return m_vertexRemoved[v];
+		}
+		void setVertexRemoved(int v) {
+			m_vertexRemoved[v] = true;
+		}
+		///@}
+
+		/// \name Half-edges
+		///@{
+		int halfEdgeCount() const {
+			return m_halfEdgeData.size();
+		}
+		int addHalfEdge() {
+			m_halfEdgeData.emplace_back();
+			m_origin.push_back(-1);
+			m_twin.push_back(-1);
+			m_previous.push_back(-1);
+			m_next.push_back(-1);
+			m_incidentFace.push_back(-1);
+			m_halfEdgeRemoved.push_back(false);
+			return m_halfEdgeData.size() - 1;
+		}
+		HalfEdgeData& halfEdgeData(int e) {
+			return m_halfEdgeData[e];
+		}
+		const HalfEdgeData& halfEdgeData(int e) const {
+			return m_halfEdgeData[e];
+		}
+		int origin(int e) const {
+			return m_origin[e];
+		}
+		void setOrigin(int e, int v) {
+			m_origin[e] = v;
+		}
+		int twin(int e) const {
+			return m_twin[e];
+		}
+		void setTwin(int e, int twin) {
+			m_twin[e] = twin;
+		}
+		int previous(int e) const {
+			return m_previous[e];
+		}
+		void setPrevious(int e, int previous) {
+			m_previous[e] = previous;
+		}
+		int next(int e) const {
+			return m_next[e];
+		}
+		void setNext(int e, int next) {
+			m_next[e] = next;
+		}
+		int incidentFace(int e) const {
+			return m_incidentFace[e];
+		}
+		void setIncidentFace(int e, int f) {
+			m_incidentFace[e] = f;
+		}
+		bool isHalfEdgeRemoved(int e) const {
+			return m_halfEdgeRemoved[e];
+		}
+		void setHalfEdgeRemoved(int e) {
+			m_halfEdgeRemoved[e] = true;
+		}
+		///@}
+
+		/// \name Faces
+		///@{
+		int faceCount() const {
+			return m_faceData.size();
+		}
+		int addFace() {
+			m_faceData.emplace_back();
+			m_boundary.push_back(-1);
+			m_faceRemoved.push_back(false);
+			return m_faceData.size() - 1;
+		}
+		FaceData& faceData(int f) {
+			return m_faceData[f];
+		}
+		const FaceData& faceData(int f) const {
+			return m_faceData[f];
+		}
+		int boundary(int f) const {
+			return m_boundary[f];
+		}
+		void setBoundary(int f, int e) {
+			m_boundary[f] = e;
+		}
+		bool isFaceRemoved(int f) const {
+			return m_faceRemoved[f];
+		}
+		void setFaceRemoved(int f) {
+			m_faceRemoved[f] = true;
+		}
+		///@}
+
+	protected:
+
+		/// \name Data
+		///@{
+		std::vector<VertexData> m_vertexData;
+		std::vector<HalfEdgeData> m_halfEdgeData;
+		std::vector<FaceData> m_faceData;
+		///@}
+
+		/// \name Pointers and removed flags
+		///@{
+		std::vector<int> m_outgoing;
+		std::vector<bool> m_vertexRemoved;
+		std::vector<int> m_origin;
+		std::vector<int> m_twin;
+		std::vector<int> m_previous;
+		std::vector<int> m_next;
+		std::vector<int> m_incidentFace;
+		std::vector<bool> m_halfEdgeRemoved;
+		std::vector<int> m_boundary;
+		std::vector<bool> m_faceRemoved;
+		///@}
+};
+
+/**
+ * \brief A doubly-connected edge list.
+ *
+ * An implementation of a doubly-connected edge list (DCEL), a data structure
+ * that stores a planar subdivision. A DCEL consists of vertices, edges and
+ * faces, that are connected to each other in such a way that it is easy to
+ * traverse the subdivision. Every edge is stored twice, one for each
+ * direction; both halves are called half-edges. A half-edge, representing
+ * one side of an edge, is incident to only one face.
+ *
+ * A cycle of a half-edge and its twin is supposed to run in counter-clockwise
+ * order.
+ *
+ * Vertices have a pointer to
+ *
+ * * an arbitrary outgoing half-edge.
+ *
+ * Half-edges have a pointer to
+ *
+ * * its origin vertex;
+ * * its incident face;
+ * * its previous and next half-edges on the incident face;
+ * * its twin (the opposite half-edge).
+ *
+ * Faces have a pointer to
+ *
+ * * an arbitrary half-edge on the boundary.
+ *
+ * In this class, the pointers are implemented as indexes into the list of
+ * vertices, the list of edges and the list of faces.
+ *
+ * Furthermore, vertices, half-edges and faces can carry data of an arbitrary
+ * type.
+ *
+ * \tparam VertexData The vertex data type; needs to be default-constructible.
+ * \tparam HalfEdgeData The half-edge data type; needs to be
+ * default-constructible.
+ * \tparam FaceData The face data type; needs to be default-constructible.
+ * \tparam Storage The storage policy that determines how the elements are
+ * stored; see DcelAosStorage.
+ */
+template<typename VertexData, typename HalfEdgeData, typename FaceData,
+         template<typename, typename, typename> class Storage = DcelAosStorage>
+class Dcel {
+
 	public:
 
 		class Vertex;
@@ -143,6 +459,117 @@ class Dcel {
 		class Face;
 		class Wedge;
 
+	private:
+
+		/// \name Steps and projections for CycleRange
+		///@{
+		static HalfEdge nextOnFace(HalfEdge e) {
+			return e.next();
+		}
+		static HalfEdge nextOutgoing(HalfEdge e) {
+			return e.nextOutgoing();
+		}
+		static HalfEdge nextIncoming(HalfEdge e) {
+			return e.nextIncoming();
+		}
+		static HalfEdge halfEdgeItself(HalfEdge e) {
+			return e;
+		}
+		static Vertex originOf(HalfEdge e) {
+			return e.origin();
+		}
+		///@}
+
+	public:
+
+		/**
+		 * A range over a cycle of half-edges, for use in range-based for
+		 * loops.
+		 *
+		 * The range starts at a given half-edge and repeatedly applies `step`
+		 * until it arrives back at the start. Each half-edge is mapped to an
+		 * element of the range using `project`. If the start half-edge is
+		 * uninitialized, the range is empty.
+		 *
+		 * \note The cycle should not be modified while iterating over it.
+		 *
+		 * \tparam Value The type of the elements of the range.
+		 * \tparam step Returns the half-edge after the given one in the cycle.
+		 * \tparam project Returns the element for the given half-edge.
+		 */
+		template<typename Value, HalfEdge (*step)(HalfEdge), Value (*project)(HalfEdge)>
+		class CycleRange {
+
+			public:
+
+				/// Forward iterator over a CycleRange.
+				class Iterator {
+
+					public:
+						using iterator_category = std::forward_iterator_tag;
+						using value_type = Value;
+						using difference_type = std::ptrdiff_t;
+						using pointer = void;
+						using reference = Value;
+
+						Iterator() = default;
+						Iterator(HalfEdge edge, bool atStart) :
+						    m_edge(edge), m_atStart(atStart) {}
+
+						Value operator*() const {
+							return project(m_edge);
+						}
+						Iterator& operator++() {
+							m_edge = step(m_edge);
+							m_atStart = false;
+							return *this;
+						}
+						Iterator operator++(int) {
+							Iterator result = *this;
+							++*this;
+							return result;
+						}
+						bool operator==(const Iterator& other) const {
+							return m_edge == other.m_edge && m_atStart == other.m_atStart;
+						}
+
+					private:
+						/// The current half-edge.
+						HalfEdge m_edge;
+						/// Whether we have not moved away from the start yet.
+						/// This distinguishes the begin iterator from the end
+						/// iterator, which both point to the start half-edge.
+						bool m_atStart = false;
+				};
+
+				/**
+				 * Creates a range starting from the given half-edge.
+				 *
+				 * \param start The half-edge to start from.
+				 */
+				explicit CycleRange(HalfEdge start) : m_start(start) {}
+
+				Iterator begin() const {
+					return Iterator(m_start, m_start.isInitialized());
+				}
+				Iterator end() const {
+					return Iterator(m_start, false);
+				}
+
+			private:
+				/// The half-edge to start from.
+				HalfEdge m_start;
+		};
+
+		/// A range over the outgoing half-edges of a vertex.
+		using OutgoingEdgeRange = CycleRange<HalfEdge, &Dcel::nextOutgoing, &Dcel::halfEdgeItself>;
+		/// A range over the incoming half-edges of a vertex.
+		using IncomingEdgeRange = CycleRange<HalfEdge, &Dcel::nextIncoming, &Dcel::halfEdgeItself>;
+		/// A range over the boundary half-edges of a face.
+		using BoundaryEdgeRange = CycleRange<HalfEdge, &Dcel::nextOnFace, &Dcel::halfEdgeItself>;
+		/// A range over the boundary vertices of a face.
+		using BoundaryVertexRange = CycleRange<Vertex, &Dcel::nextOnFace, &Dcel::originOf>;
+
 		/**
 		 * A vertex in a doubly-connected edge list.
 		 *
@@ -163,7 +590,8 @@ class Dcel {
 			 * The main `Dcel` class may access our pointers. Other classes
 			 * need to go through the `Dcel` class.
 			 */
-			template<typename Vertex, typename HalfEdge, typename Face>
+			template<typename V, typename H, typename F,
+			         template<typename, typename, typename> class S>
 			friend class Dcel;
 
 			public:
@@ -191,7 +619,7 @@ class Dcel {
 				 * otherwise.
 				 */
 				bool isRemoved() const {
-					return m_dcel->m_vertices[id()].removed;
+					return m_dcel->m_storage.isVertexRemoved(id());
 				}
 
 				/**
@@ -211,7 +639,7 @@ class Dcel {
 				 */
 				VertexData& data() {
 					assert(isInitialized());
-					return m_dcel->m_vertices[id()].m_data;
+					return m_dcel->m_storage.vertexData(id());
 				}
 
 				/**
@@ -220,7 +648,7 @@ class Dcel {
 				 */
 				const VertexData& data() const {
 					assert(isInitialized());
-					return m_dcel->m_vertices[id()].m_data;
+					return m_dcel->m_storage.vertexData(id());
 				}
 
 				/**
@@ -229,7 +657,7 @@ class Dcel {
 				 */
 				void setData(VertexData data) {
 					assert(isInitialized());
-					m_dcel->m_vertices[id()].m_data = data;
+					m_dcel->m_storage.vertexData(id()) = data;
 				}
 
 				/**
@@ -238,7 +666,7 @@ class Dcel {
 				 */
 				HalfEdge outgoing() const {
 					assert(isInitialized());
-					return m_dcel->halfEdge(m_dcel->m_vertices[id()].m_outgoing);
+					return m_dcel->halfEdge(m_dcel->m_storage.outgoing(id()));
 				}
 
 				/**
@@ -259,7 +687,7 @@ class Dcel {
 				void setOutgoing(HalfEdge outgoing) {
 					assert(isInitialized());
 					assert(outgoing.isInitialized());
-					m_dcel->m_vertices[id()].m_outgoing = outgoing.id();
+					m_dcel->m_storage.setOutgoing(id(), outgoing.id());
 				}
 
 				/**
@@ -280,7 +708,8 @@ class Dcel {
 				 *
 				 * \param f A function to call for every outgoing edge.
 				 */
-				void forAllOutgoingEdges(std::function<void(HalfEdge)> f) {
+				template<typename F>
+				void forAllOutgoingEdges(F f) {
 					assert(isInitialized());
 					if (!outgoing().isInitialized()) {
 						// this vertex has no incident edges
@@ -297,8 +726,8 @@ class Dcel {
 				 * outgoing edge of this vertex.
 				 * \param f A function to call for every outgoing edge.
 				 */
-				void forAllOutgoingEdges(HalfEdge startEdge,
-										 std::function<void(HalfEdge)> f) {
+				template<typename F>
+				void forAllOutgoingEdges(HalfEdge startEdge, F f) {
 
 					assert(isInitialized());
 					assert(startEdge.isInitialized());
@@ -312,6 +741,32 @@ class Dcel {
 					} while (edge != startEdge);
 				}
 
+				/**
+				 * Returns a range over the outgoing edges of this vertex,
+				 * starting from the edge returned by outgoing(), in
+				 * counter-clockwise order.
+				 *
+				 * \see forAllOutgoingEdges()
+				 */
+				OutgoingEdgeRange outgoingEdges() const {
+					assert(isInitialized());
+					return OutgoingEdgeRange(outgoing());
+				}
+
+				/**
+				 * Returns a range over the outgoing edges of this vertex,
+				 * starting from the given edge, in counter-clockwise order.
+				 *
+				 * \param startEdge The edge to start from. This must be an
+				 * outgoing edge of this vertex.
+				 */
+				OutgoingEdgeRange outgoingEdges(HalfEdge startEdge) const {
+					assert(isInitialized());
+					assert(startEdge.isInitialized());
+					assert(startEdge.origin() == *this);
+					return OutgoingEdgeRange(startEdge);
+				}
+
 				/**
 				 * Returns the outgoing half-edge of this vertex to the given
 				 * neighbor vertex.
@@ -338,7 +793,8 @@ class Dcel {
 				 *
 				 * \param f A function to call for every incoming edge.
 				 */
-				void forAllIncomingEdges(std::function<void(HalfEdge)> f) {
+				template<typename F>
+				void forAllIncomingEdges(F f) {
 					assert(isInitialized());
 					if (!outgoing().isInitialized()) {
 						// this vertex has no incident edges
@@ -355,8 +811,8 @@ class Dcel {
 				 * incoming edge of this vertex.
 				 * \param f A function to call for every incoming edge.
 				 */
-				void forAllIncomingEdges(HalfEdge startEdge,
-				                         std::function<void(HalfEdge)> f) {
+				template<typename F>
+				void forAllIncomingEdges(HalfEdge startEdge, F f) {
 
 					assert(isInitialized());
 					assert(startEdge.isInitialized());
@@ -370,6 +826,22 @@ class Dcel {
 					} while (edge != startEdge);
 				}
 
+				/**
+				 * Returns a range over the incoming edges of this vertex,
+				 * starting from the edge returned by incoming(), in
+				 * counter-clockwise order.
+				 *
+				 * \see forAllIncomingEdges()
+				 */
+				IncomingEdgeRange incomingEdges() const {
+					assert(isInitialized());
+					if (!outgoing().isInitialized()) {
+						// this vertex has no incident edges
+						return IncomingEdgeRange(HalfEdge());
+					}
+					return IncomingEdgeRange(incoming());
+				}
+
 				/**
 				 * Returns the incoming half-edge of this vertex from the given
 				 * neighbor vertex.
@@ -395,7 +867,8 @@ class Dcel {
 				 *
 				 * \param f A function to call for every incident face.
 				 */
-				void forAllIncidentFaces(std::function<void(Face)> f) {
+				template<typename F>
+				void forAllIncidentFaces(F f) {
 					assert(isInitialized());
 
 					forAllOutgoingEdges([f](HalfEdge e) {
@@ -451,8 +924,8 @@ class Dcel {
 				 * the half-edge that lead to this vertex. (That is, all those
 				 * half-edges together form a BFS tree.)
 				 */
-				void forAllReachableVertices(
-				        std::function<void(Vertex, HalfEdge)> f) {
+				template<typename F>
+				void forAllReachableVertices(F f) {
 
 					assert(isInitialized());
 					forAllReachableVertices([](HalfEdge e) {
@@ -473,83 +946,59 @@ class Dcel {
 				 * \param f A function to call for every reachable vertex. The
 				 * first argument contains the vertex, the second argument is
 				 * the half-edge that lead to this vertex. (That is, all those
-				 * half-edges together form a BFS tree.)
+				 * half-edges together form a BFS tree.) If `f` takes a third
+				 * argument, it receives the distance (in the number of
+				 * half-edges) from this vertex to the returned vertex.
 				 */
-				void forAllReachableVertices(
-				        std::function<bool(HalfEdge)> edgeCheck,
-				        std::function<void(Vertex, HalfEdge)> f) {
+				template<typename EdgeCheck, typename F>
+				void forAllReachableVertices(EdgeCheck edgeCheck, F f) {
 
 					assert(isInitialized());
-					std::vector<bool> visited(m_dcel->vertexCount(), false);
 					Vertex v = *this;
-					visited[v.id()] = true;
 					std::queue<Vertex> queue;
 					queue.push(v);
 
-					while (!queue.empty()) {
-						Vertex v = queue.front();
-						queue.pop();
-						v.forAllOutgoingEdges(
-						            [&f, &queue, &visited, &edgeCheck]
-						            (HalfEdge outgoing) {
-							if (!edgeCheck(outgoing)) {
-								return;
-							}
-							Vertex vNew = outgoing.destination();
-							if (!visited[vNew.id()]) {
-								visited[vNew.id()] = true;
-								queue.push(vNew);
-								f(vNew, outgoing);
-							}
-						});
-					}
-				}
-
-				/**
-				 * Performs an action for all vertices that are reachable from
-				 * this vertex (but not this vertex itself), while passing
-				 * along certain edges only. This variant of the method
-				 * maintains the distance (in the number of half-edges) of all
-				 * returned vertices to this vertex.
-				 *
-				 * \note This performs a BFS on the DCEL.
-				 *
-				 * \param edgeCheck A function to call for every encountered
-				 * half-edge, that returns whether we are allowed to take this
-				 * half-edge or not.
-				 * \param f A function to call for every reachable vertex. The
-				 * first argument contains the vertex, the second argument is
-				 * the half-edge that lead to this vertex (that is, all those
-				 * half-edges together form a BFS tree) and the third argument
-				 * is the distance from this vertex to the returned vertex.
-				 */
-				void forAllReachableVertices(
-				        std::function<bool(HalfEdge)> edgeCheck,
-				        std::function<void(Vertex, HalfEdge, int)> f) {
-
-					assert(isInitialized());
-					std::vector<int> distance(m_dcel->vertexCount(), -1);
-					Vertex v = *this;
-					distance[v.id()] = 0;
-					std::queue<Vertex> queue;
-					queue.push(v);
-
-					while (!queue.empty()) {
-						Vertex v = queue.front();
-						queue.pop();
-						v.forAllOutgoingEdges(
-						            [&f, &v, &queue, &distance, &edgeCheck]
-									(HalfEdge outgoing) {
-							if (!edgeCheck(outgoing)) {
-								return;
-							}
-							Vertex vNew = outgoing.destination();
-							if (distance[vNew.id()] == -1) {
-								distance[vNew.id()] = distance[v.id()] + 1;
-								queue.push(vNew);
-								f(vNew, outgoing, distance[vNew.id()]);
-							}
-						});
+					if constexpr (std::is_invocable_v<F&, Vertex, HalfEdge, int>) {
+						std::vector<int> distance(m_dcel->vertexCount(), -1);
+						distance[v.id()] = 0;
+						while (!queue.empty()) {
+							Vertex v = queue.front();
+							queue.pop();
+							v.forAllOutgoingEdges(
+							            [&f, &v, &queue, &distance, &edgeCheck]
+							            (HalfEdge outgoing) {
+								if (!edgeCheck(outgoing)) {
+									return;
+								}
+								Vertex vNew = outgoing.destination();
+								if (distance[vNew.id()] == -1) {
+									distance[vNew.id()] = distance[v.id()] + 1;
+									queue.push(vNew);
+									f(vNew, outgoing, distance[vNew.id()]);
+								}
+							});
+						}
+					} else {
+						// without distances, a bit per vertex suffices
+						std::vector<bool> visited(m_dcel->vertexCount(), false);
+						visited[v.id()] = true;
+						while (!queue.empty()) {
+							Vertex v = queue.front();
+							queue.pop();
+							v.forAllOutgoingEdges(
+							            [&f, &queue, &visited, &edgeCheck]
+							            (HalfEdge outgoing) {
+								if (!edgeCheck(outgoing)) {
+									return;
+								}
+								Vertex vNew = outgoing.destination();
+								if (!visited[vNew.id()]) {
+									visited[vNew.id()] = true;
+									queue.push(vNew);
+									f(vNew, outgoing);
+								}
+							});
+						}
 					}
 				}
 
@@ -810,7 +1259,7 @@ class Dcel {
 						edge = edge.nextOutgoing();
 					} while (!edge.isRemoved());
 
-					m_dcel->m_vertices[id()].removed = true;
+					m_dcel->m_storage.setVertexRemoved(id());
 				}
 
 				/**
@@ -857,14 +1306,14 @@ class Dcel {
 				 * \param dcel The DCEL instance.
 				 * \param id The ID of this vertex.
 				 */
-				Vertex(Dcel<VertexData, HalfEdgeData, FaceData>* dcel,
+				Vertex(Dcel* dcel,
 						int id) : m_dcel(dcel), m_id(id) {
 				}
 
 				/**
 				 * The DCEL this vertex is a part of.
 				 */
-				Dcel<VertexData, HalfEdgeData, FaceData>* m_dcel = nullptr;
+				Dcel* m_dcel = nullptr;
 
 				/**
 				 * The index of this vertex in the `Dcel::vertices()` list, or
@@ -897,7 +1346,8 @@ class Dcel {
 			 * The main `Dcel` class may access our pointers. Other classes
 			 * need to go through the `Dcel` class.
 			 */
-			template<typename Vertex, typename HalfEdge, typename Face>
+			template<typename V, typename H, typename F,
+			         template<typename, typename, typename> class S>
 			friend class Dcel;
 
 			public:
@@ -925,7 +1375,7 @@ class Dcel {
 				 * otherwise.
 				 */
 				bool isRemoved() const {
-					return m_dcel->m_halfEdges[id()].removed;
+					return m_dcel->m_storage.isHalfEdgeRemoved(id());
 				}
 
 				/**
@@ -945,7 +1395,7 @@ class Dcel {
 				 */
 				HalfEdgeData& data() {
 					assert(isInitialized());
-					return m_dcel->m_halfEdges[id()].m_data;
+					return m_dcel->m_storage.halfEdgeData(id());
 				}
 
 				/**
@@ -954,7 +1404,7 @@ class Dcel {
 				 */
 				const HalfEdgeData& data() const {
 					assert(isInitialized());
-					return m_dcel->m_halfEdges[id()].m_data;
+					return m_dcel->m_storage.halfEdgeData(id());
 				}
 
 				/**
@@ -963,7 +1413,7 @@ class Dcel {
 				 */
 				void setData(HalfEdgeData data) {
 					assert(isInitialized());
-					m_dcel->m_halfEdges[id()].m_data = data;
+					m_dcel->m_storage.halfEdgeData(id()) = data;
 				}
 
 				/**
@@ -972,7 +1422,7 @@ class Dcel {
 				 */
 				Vertex origin() const {
 					assert(isInitialized());
-					return m_dcel->vertex(m_dcel->m_halfEdges[id()].m_origin);
+					return m_dcel->vertex(m_dcel->m_storage.origin(id()));
 				}
 
 				/**
@@ -982,7 +1432,7 @@ class Dcel {
 				void setOrigin(Vertex origin) {
 					assert(isInitialized());
 					assert(origin.isInitialized());
-					m_dcel->m_halfEdges[id()].m_origin = origin.id();
+					m_dcel->m_storage.setOrigin(id(), origin.id());
 				}
 
 				/**
@@ -1002,7 +1452,7 @@ class Dcel {
 				 */
 				HalfEdge twin() const {
 					assert(isInitialized());
-					return m_dcel->halfEdge(m_dcel->m_halfEdges[id()].m_twin);
+					return m_dcel->halfEdge(m_dcel->m_storage.twin(id()));
 				}
 
 				/**
@@ -1012,8 +1462,8 @@ class Dcel {
 				void setTwin(HalfEdge twin) {
 					assert(isInitialized());
 					assert(twin.isInitialized());
-					m_dcel->m_halfEdges[id()].m_twin = twin.id();
-					m_dcel->m_halfEdges[twin.id()].m_twin = id();
+					m_dcel->m_storage.setTwin(id(), twin.id());
+					m_dcel->m_storage.setTwin(twin.id(), id());
 				}
 
 				/**
@@ -1028,7 +1478,7 @@ class Dcel {
 				HalfEdge previous() const {
 					assert(isInitialized());
 					return m_dcel->halfEdge(
-								m_dcel->m_halfEdges[id()].m_previous);
+								m_dcel->m_storage.previous(id()));
 				}
 
 				/**
@@ -1037,7 +1487,7 @@ class Dcel {
 				 */
 				HalfEdge next() const {
 					assert(isInitialized());
-					return m_dcel->halfEdge(m_dcel->m_halfEdges[id()].m_next);
+					return m_dcel->halfEdge(m_dcel->m_storage.next(id()));
 				}
 
 				/**
@@ -1047,8 +1497,8 @@ class Dcel {
 				void setNext(HalfEdge next) {
 					assert(isInitialized());
 					assert(next.isInitialized());
-					m_dcel->m_halfEdges[id()].m_next = next.id();
-					m_dcel->m_halfEdges[next.id()].m_previous = id();
+					m_dcel->m_storage.setNext(id(), next.id());
+					m_dcel->m_storage.setPrevious(next.id(), id());
 				}
 
 				/**
@@ -1103,7 +1553,7 @@ class Dcel {
 				Face incidentFace() const {
 					assert(isInitialized());
 					return m_dcel->face(
-								m_dcel->m_halfEdges[id()].m_incidentFace);
+								m_dcel->m_storage.incidentFace(id()));
 				}
 
 				/**
@@ -1113,8 +1563,7 @@ class Dcel {
 				void setIncidentFace(Face incidentFace) {
 					assert(isInitialized());
 					assert(incidentFace.isInitialized());
-					m_dcel->m_halfEdges[id()].m_incidentFace =
-								incidentFace.id();
+					m_dcel->m_storage.setIncidentFace(id(), incidentFace.id());
 				}
 
 				/**
@@ -1204,8 +1653,8 @@ class Dcel {
 					                  << std::endl;
 #endif
 
-					m_dcel->m_halfEdges[id()].removed = true;
-					m_dcel->m_halfEdges[twin().id()].removed = true;
+					m_dcel->m_storage.setHalfEdgeRemoved(id());
+					m_dcel->m_storage.setHalfEdgeRemoved(twin().id());
 
 					// if origin was pointing at this edge, move that pointer to
 					// another outgoing edge (and this is the only outgoing
@@ -1216,7 +1665,7 @@ class Dcel {
 							std::cout << "    remove origin "
 							          << origin().id() << std::endl;
 #endif
-							m_dcel->m_vertices[origin().id()].removed = true;
+							m_dcel->m_storage.setVertexRemoved(origin().id());
 						} else {
 #ifdef DCEL_ENABLE_TRACING_OUTPUT
 							std::cout << "    move origin.outgoing to "
@@ -1233,7 +1682,7 @@ class Dcel {
 							std::cout << "    remove destination "
 							          << destination().id() << std::endl;
 #endif
-							m_dcel->m_vertices[destination().id()].removed = true;
+							m_dcel->m_storage.setVertexRemoved(destination().id());
 						} else {
 #ifdef DCEL_ENABLE_TRACING_OUTPUT
 							std::cout << "    move destination.outgoing to "
@@ -1252,7 +1701,7 @@ class Dcel {
 							std::cout << "    remove face "
 							          << incidentFace().id() << std::endl;
 #endif
-							m_dcel->m_faces[incidentFace().id()].removed = true;
+							m_dcel->m_storage.setFaceRemoved(incidentFace().id());
 						} else if (next() == twin()) {
 #ifdef DCEL_ENABLE_TRACING_OUTPUT
 							std::cout << "    move incidentFace.boundary to "
@@ -1275,7 +1724,7 @@ class Dcel {
 							std::cout << "    remove face "
 							          << twin().incidentFace().id() << std::endl;
 #endif
-							m_dcel->m_faces[twin().incidentFace().id()].removed = true;
+							m_dcel->m_storage.setFaceRemoved(twin().incidentFace().id());
 						} else if (twin().next() == *this) {
 #ifdef DCEL_ENABLE_TRACING_OUTPUT
 							std::cout << "    move twin.incidentFace.boundary to "
@@ -1300,8 +1749,7 @@ class Dcel {
 #endif
 
 						// remove incident face of twin
-						m_dcel->m_faces[twin().incidentFace().id()].removed
-						        = true;
+						m_dcel->m_storage.setFaceRemoved(twin().incidentFace().id());
 
 						// let boundary edges point to the merged face
 						twin().incidentFace().
@@ -1369,14 +1817,14 @@ class Dcel {
 				 * \param dcel The DCEL instance.
 				 * \param id The ID of this half-edge.
 				 */
-				HalfEdge(Dcel<VertexData, HalfEdgeData, FaceData>* dcel,
+				HalfEdge(Dcel* dcel,
 						int id) : m_dcel(dcel), m_id(id) {
 				}
 
 				/**
 				 * The DCEL this half-edge is a part of.
 				 */
-				Dcel<VertexData, HalfEdgeData, FaceData>* m_dcel = nullptr;
+				Dcel* m_dcel = nullptr;
 
 				/**
 				 * The index of this half-edge in the `Dcel::halfEdges()` list,
@@ -1408,7 +1856,8 @@ class Dcel {
 			 * The main `Dcel` class may access our pointers. Other classes
 			 * need to go through the `Dcel` class.
 			 */
-			template<typename Vertex, typename HalfEdge, typename Face>
+			template<typename V, typename H, typename F,
+			         template<typename, typename, typename> class S>
 			friend class Dcel;
 
 			public:
@@ -1434,7 +1883,7 @@ class Dcel {
 				 * otherwise.
 				 */
 				bool isRemoved() const {
-					return m_dcel->m_faces[id()].removed;
+					return m_dcel->m_storage.isFaceRemoved(id());
 				}
 
 				/**
@@ -1454,7 +1903,7 @@ class Dcel {
 				 */
 				FaceData& data() {
 					assert(isInitialized());
-					return m_dcel->m_faces[id()].m_data;
+					return m_dcel->m_storage.faceData(id());
 				}
 
 				/**
@@ -1463,7 +1912,7 @@ class Dcel {
 				 */
 				const FaceData& data() const {
 					assert(isInitialized());
-					return m_dcel->m_faces[id()].m_data;
+					return m_dcel->m_storage.faceData(id());
 				}
 
 				/**
@@ -1472,7 +1921,7 @@ class Dcel {
 				 */
 				void setData(FaceData data) {
 					assert(isInitialized());
-					m_dcel->m_faces[id()].m_data = data;
+					m_dcel->m_storage.faceData(id()) = data;
 				}
 
 				/**
@@ -1481,7 +1930,7 @@ class Dcel {
 				 */
 				HalfEdge boundary() const {
 					assert(isInitialized());
-					return m_dcel->halfEdge(m_dcel->m_faces[id()].m_boundary);
+					return m_dcel->halfEdge(m_dcel->m_storage.boundary(id()));
 				}
 
 				/**
@@ -1491,7 +1940,7 @@ class Dcel {
 				void setBoundary(HalfEdge boundary) {
 					assert(isInitialized());
 					assert(boundary.isInitialized());
-					m_dcel->m_faces[id()].m_boundary = boundary.id();
+					m_dcel->m_storage.setBoundary(id(), boundary.id());
 				}
 
 				/**
@@ -1510,7 +1959,8 @@ class Dcel {
 				 *
 				 * \param f A function to call for every boundary edge.
 				 */
-				void forAllBoundaryEdges(std::function<void(HalfEdge)> f) {
+				template<typename F>
+				void forAllBoundaryEdges(F f) {
 					assert(isInitialized());
 					forAllBoundaryEdges(boundary(), f);
 				}
@@ -1524,8 +1974,8 @@ class Dcel {
 				 * boundary edge of this face.
 				 * \param f A function to call for every boundary edge.
 				 */
-				void forAllBoundaryEdges(HalfEdge startEdge,
-										 std::function<void(HalfEdge)> f) {
+				template<typename F>
+				void forAllBoundaryEdges(HalfEdge startEdge, F f) {
 
 					assert(isInitialized());
 					assert(startEdge.incidentFace() == *this);
@@ -1538,6 +1988,44 @@ class Dcel {
 					} while (edge != startEdge);
 				}
 
+				/**
+				 * Returns a range over the boundary edges of this face,
+				 * starting from the edge returned by boundary(), in clockwise
+				 * order around the face.
+				 *
+				 * \see forAllBoundaryEdges()
+				 */
+				BoundaryEdgeRange boundaryEdges() const {
+					assert(isInitialized());
+					return BoundaryEdgeRange(boundary());
+				}
+
+				/**
+				 * Returns a range over the boundary edges of this face,
+				 * starting from the given edge, in clockwise order around the
+				 * face.
+				 *
+				 * \param startEdge The edge to start from. This must be a
+				 * boundary edge of this face.
+				 */
+				BoundaryEdgeRange boundaryEdges(HalfEdge startEdge) const {
+					assert(isInitialized());
+					assert(startEdge.incidentFace() == *this);
+					return BoundaryEdgeRange(startEdge);
+				}
+
+				/**
+				 * Returns a range over the boundary vertices of this face,
+				 * starting from the vertex returned by boundary().origin(), in
+				 * clockwise order around the face.
+				 *
+				 * \see forAllBoundaryVertices()
+				 */
+				BoundaryVertexRange boundaryVertices() const {
+					assert(isInitialized());
+					return BoundaryVertexRange(boundary());
+				}
+
 				/**
 				 * Performs an action for all boundary vertices of this face,
 				 * starting from the vertex returned by boundary().origin(), in
@@ -1545,7 +2033,8 @@ class Dcel {
 				 *
 				 * \param f A function to call for every boundary vertex.
 				 */
-				void forAllBoundaryVertices(std::function<void(Vertex)> f) {
+				template<typename F>
+				void forAllBoundaryVertices(F f) {
 					assert(isInitialized());
 					forAllBoundaryEdges(boundary(), [f](HalfEdge e) {
 						f(e.origin());
@@ -1564,8 +2053,8 @@ class Dcel {
 				 * all those half-edges together form a BFS tree over the
 				 * faces.)
 				 */
-				void forAllReachableFaces(
-						std::function<void(Face, HalfEdge)> f) {
+				template<typename F>
+				void forAllReachableFaces(F f) {
 
 					assert(isInitialized());
 					forAllReachableFaces([](HalfEdge e) {
@@ -1589,9 +2078,8 @@ class Dcel {
 				 * all those half-edges together form a BFS tree over the
 				 * faces.)
 				 */
-				void forAllReachableFaces(
-						std::function<bool(HalfEdge)> edgeCheck,
-						std::function<void(Face, HalfEdge)> f) {
+				template<typename EdgeCheck, typename F>
+				void forAllReachableFaces(EdgeCheck edgeCheck, F f) {
 
 					assert(isInitialized());
 					std::vector<bool> visited(m_dcel->faceCount(), false);
@@ -1663,14 +2151,14 @@ class Dcel {
 				 * \param dcel The DCEL instance.
 				 * \param id The ID of this face.
 				 */
-				Face(Dcel<VertexData, HalfEdgeData, FaceData>* dcel,
+				Face(Dcel* dcel,
 						int id) : m_dcel(dcel), m_id(id) {
 				}
 
 				/**
 				 * The DCEL this vertex is a part of.
 				 */
-				Dcel<VertexData, HalfEdgeData, FaceData>* m_dcel = nullptr;
+				Dcel* m_dcel = nullptr;
 
 				/**
 				 * The index of this face in the `Dcel::faces()` list, or `-1`
@@ -1702,7 +2190,8 @@ class Dcel {
 			 * The main `Dcel` class may access our pointers. Other classes
 			 * need to go through the `Dcel` class.
 			 */
-			template<typename Vertex, typename HalfEdge, typename Face>
+			template<typename V, typename H, typename F,
+			         template<typename, typename, typename> class S>
 			friend class Dcel;
 
 			public:
@@ -1765,14 +2254,14 @@ class Dcel {
 				 * \param dcel The DCEL instance.
 				 * \param outId The ID of the first half-edge.
 				 */
-				Wedge(Dcel<VertexData, HalfEdgeData, FaceData>* dcel,
+				Wedge(Dcel* dcel,
 						int outId) : m_dcel(dcel), m_outId(outId) {
 				}
 
 				/**
 				 * The DCEL this wedge is a part of.
 				 */
-				Dcel<VertexData, HalfEdgeData, FaceData>* m_dcel = nullptr;
+				Dcel* m_dcel = nullptr;
 
 				/**
 				 * The index of the first half-edge in the `Dcel::halfEdges()`
@@ -1815,7 +2304,7 @@ class Dcel {
 		 * \return The number of vertices.
 		 */
 		int vertexCount() const {
-			return m_vertices.size();
+			return m_storage.vertexCount();
 		}
 
 		/**
@@ -1837,7 +2326,7 @@ class Dcel {
 		 * \return The number of half-edges.
 		 */
 		int halfEdgeCount() const {
-			return m_halfEdges.size();
+			return m_storage.halfEdgeCount();
 		}
 
 		/**
@@ -1859,7 +2348,7 @@ class Dcel {
 		 * \return The number of faces.
 		 */
 		int faceCount() const {
-			return m_faces.size();
+			return m_storage.faceCount();
 		}
 
 		/**
@@ -1914,10 +2403,7 @@ class Dcel {
 		 * \return The new vertex.
 		 */
 		Vertex addVertex() {
-			int id = m_vertices.size();
-			VertexImpl v;
-			m_vertices.push_back(v);
-			return vertex(id);
+			return vertex(m_storage.addVertex());
 		}
 
 		/**
@@ -1933,10 +2419,7 @@ class Dcel {
 			assert(origin.isInitialized());
 			assert(origin.m_dcel == this);
 
-			int id = m_halfEdges.size();
-
-			HalfEdgeImpl e;
-			m_halfEdges.push_back(e);
+			int id = m_storage.addHalfEdge();
 
 			halfEdge(id).setOrigin(origin);
 
@@ -1984,11 +2467,7 @@ class Dcel {
 			assert(boundary.isInitialized());
 			assert(boundary.m_dcel == this);
 
-			int id = m_faces.size();
-
-			FaceImpl f;
-
-			m_faces.push_back(f);
+			int id = m_storage.addFace();
 
 			face(id).setBoundary(boundary);
 
@@ -2033,66 +2512,72 @@ class Dcel {
 		void compact() {
 			assert(isValid(true));
 
-			// first just copy every non-removed element to a new list
+			// first just copy every non-removed element to a new storage
 			// while maintaining mappings from old to new IDs
-			std::vector<VertexImpl> newVertices;
+			Storage<VertexData, HalfEdgeData, FaceData> newStorage;
 			std::vector<int> vertexMapping(vertexCount(), -1);
 			for (int i = 0; i < vertexCount(); i++) {
-				VertexImpl v = m_vertices[i];
-				if (!v.removed) {
-					vertexMapping[i] = newVertices.size();
-					newVertices.push_back(v);
+				if (!m_storage.isVertexRemoved(i)) {
+					vertexMapping[i] = newStorage.addVertex();
+					newStorage.vertexData(vertexMapping[i]) =
+					        std::move(m_storage.vertexData(i));
 				}
 			}
 
-			std::vector<HalfEdgeImpl> newHalfEdges;
 			std::vector<int> halfEdgeMapping(halfEdgeCount(), -1);
 			for (int i = 0; i < halfEdgeCount(); i++) {
-				HalfEdgeImpl e = m_halfEdges[i];
-				if (!e.removed) {
-					halfEdgeMapping[i] = newHalfEdges.size();
-					newHalfEdges.push_back(e);
+				if (!m_storage.isHalfEdgeRemoved(i)) {
+					halfEdgeMapping[i] = newStorage.addHalfEdge();
+					newStorage.halfEdgeData(halfEdgeMapping[i]) =
+					        std::move(m_storage.halfEdgeData(i));
 				}
 			}
 
-			std::vector<FaceImpl> newFaces;
 			std::vector<int> faceMapping(faceCount(), -1);
 			for (int i = 0; i < faceCount(); i++) {
-				FaceImpl e = m_faces[i];
-				if (!e.removed) {
-					faceMapping[i] = newFaces.size();
-					newFaces.push_back(e);
+				if (!m_storage.isFaceRemoved(i)) {
+					faceMapping[i] = newStorage.addFace();
+					newStorage.faceData(faceMapping[i]) =
+					        std::move(m_storage.faceData(i));
 				}
 			}
 
-			// now we need to apply the mappings to everything
-			for (VertexImpl& v : newVertices) {
-				v.m_outgoing = halfEdgeMapping[v.m_outgoing];
-				assert(v.m_outgoing != -1);
+			// now we need to apply the mappings to all pointers
+			for (int i = 0; i < vertexCount(); i++) {
+				if (vertexMapping[i] != -1) {
+					int outgoing = halfEdgeMapping[m_storage.outgoing(i)];
+					assert(outgoing != -1);
+					newStorage.setOutgoing(vertexMapping[i], outgoing);
+				}
 			}
 
-			for (HalfEdgeImpl& e : newHalfEdges) {
-				e.m_origin = vertexMapping[e.m_origin];
-				assert(e.m_origin != -1);
-				e.m_twin = halfEdgeMapping[e.m_twin];
-				assert(e.m_twin != -1);
-				e.m_next = halfEdgeMapping[e.m_next];
-				assert(e.m_next != -1);
-				e.m_previous = halfEdgeMapping[e.m_previous];
-				assert(e.m_previous != -1);
-				e.m_incidentFace = faceMapping[e.m_incidentFace];
-				assert(e.m_incidentFace != -1);
+			for (int i = 0; i < halfEdgeCount(); i++) {
+				int e = halfEdgeMapping[i];
+				if (e == -1) {
+					continue;
+				}
+				newStorage.setOrigin(e, vertexMapping[m_storage.origin(i)]);
+				assert(newStorage.origin(e) != -1);
+				newStorage.setTwin(e, halfEdgeMapping[m_storage.twin(i)]);
+				assert(newStorage.twin(e) != -1);
+				newStorage.setNext(e, halfEdgeMapping[m_storage.next(i)]);
+				assert(newStorage.next(e) != -1);
+				newStorage.setPrevious(e, halfEdgeMapping[m_storage.previous(i)]);
+				assert(newStorage.previous(e) != -1);
+				newStorage.setIncidentFace(e, faceMapping[m_storage.incidentFace(i)]);
+				assert(newStorage.incidentFace(e) != -1);
 			}
 
-			for (FaceImpl& f : newFaces) {
-				f.m_boundary = halfEdgeMapping[f.m_boundary];
-				assert(f.m_boundary != -1);
+			for (int i = 0; i < faceCount(); i++) {
+				if (faceMapping[i] != -1) {
+					int boundary = halfEdgeMapping[m_storage.boundary(i)];
+					assert(boundary != -1);
+					newStorage.setBoundary(faceMapping[i], boundary);
+				}
 			}
 
 			// save the result
-			m_vertices = newVertices;
-			m_halfEdges = newHalfEdges;
-			m_faces = newFaces;
+			m_storage = std::move(newStorage);
 
 			assert(isValid(true));
 		}
@@ -2160,7 +2645,8 @@ class Dcel {
 				 *
 				 * \param f A function to call for every vertex.
 				 */
-				void forAllVertices(std::function<void(Vertex)> f) const {
+				template<typename F>
+				void forAllVertices(F f) const {
 					if (empty()) {
 						return;
 					}
@@ -2266,118 +2752,123 @@ class Dcel {
 		 * \return `true` if this DCEL is valid. `false` if it is invalid.
 		 */
 		bool isValid(bool checkFaces) const {
-			for (int i = 0; i < m_vertices.size(); i++) {
-				VertexImpl v = m_vertices[i];
-				if (v.removed) {
+			const Storage<VertexData, HalfEdgeData, FaceData>& d = m_storage;
+			for (int i = 0; i < vertexCount(); i++) {
+				if (d.isVertexRemoved(i)) {
 					continue;
 				}
-				if (v.m_outgoing == -1) {
+				int outgoing = d.outgoing(i);
+				if (outgoing == -1) {
 					std::cout << "Dcel::isValid(): vertex " << i
 							  << " invalid: outgoing == -1" << std::endl;
 					return false;
 				}
-				if (m_halfEdges[v.m_outgoing].m_origin != i) {
+				if (d.origin(outgoing) != i) {
 					std::cout << "Dcel::isValid(): vertex " << i
 							  << " invalid: outgoing.origin == "
-							  << m_halfEdges[v.m_outgoing].m_origin
+							  << d.origin(outgoing)
 							  << " != " << i << std::endl;
 					return false;
 				}
-				if (m_halfEdges[v.m_outgoing].removed) {
+				if (d.isHalfEdgeRemoved(outgoing)) {
 					std::cout << "Dcel::isValid(): vertex " << i
 					          << " invalid: outgoing == "
-					          << v.m_outgoing
+					          << outgoing
 					          << " which is removed" << std::endl;
 					return false;
 				}
 			}
 
-			for (int i = 0; i < m_halfEdges.size(); i++) {
-				HalfEdgeImpl e = m_halfEdges[i];
-				if (e.removed) {
+			for (int i = 0; i < halfEdgeCount(); i++) {
+				if (d.isHalfEdgeRemoved(i)) {
 					continue;
 				}
-				if (e.m_next == -1) {
+				int next = d.next(i);
+				int previous = d.previous(i);
+				int origin = d.origin(i);
+				int twin = d.twin(i);
+				if (next == -1) {
 					std::cout << "Dcel::isValid(): half-edge " << i
 							  << " invalid: next == -1" << std::endl;
 					return false;
 				}
-				if (e.m_previous == -1) {
+				if (previous == -1) {
 					std::cout << "Dcel::isValid(): half-edge " << i
 							  << " invalid: previous == -1" << std::endl;
 					return false;
 				}
-				if (m_halfEdges[e.m_previous].m_next != i) {
+				if (d.next(previous) != i) {
 					std::cout << "Dcel::isValid(): half-edge " << i
 							  << " invalid: previous.next == "
-							  << m_halfEdges[e.m_previous].m_next
+							  << d.next(previous)
 							  << " != " << i << std::endl;
 					return false;
 				}
-				if (m_halfEdges[e.m_previous].removed) {
+				if (d.isHalfEdgeRemoved(previous)) {
 					std::cout << "Dcel::isValid(): half-edge " << i
 					          << " invalid: previous == "
-					          << e.m_previous
+					          << previous
 					          << " which is removed" << std::endl;
 					return false;
 				}
-				if (m_halfEdges[e.m_next].m_previous != i) {
+				if (d.previous(next) != i) {
 					std::cout << "Dcel::isValid(): half-edge " << i
 							  << " invalid: next.previous == "
-							  << m_halfEdges[e.m_next].m_previous
+							  << d.previous(next)
 							  << " != " << i << std::endl;
 					return false;
 				}
-				if (m_halfEdges[e.m_next].removed) {
+				if (d.isHalfEdgeRemoved(next)) {
 					std::cout << "Dcel::isValid(): half-edge " << i
 					          << " invalid: next == "
-					          << e.m_next
+					          << next
 					          << " which is removed" << std::endl;
 					return false;
 				}
-				if (e.m_origin== -1) {
+				if (origin == -1) {
 					std::cout << "Dcel::isValid(): half-edge " << i
 							  << " invalid: origin == -1" << std::endl;
 					return false;
 				}
-				if (m_vertices[e.m_origin].removed) {
+				if (d.isVertexRemoved(origin)) {
 					std::cout << "Dcel::isValid(): half-edge " << i
 					          << " invalid: origin == "
-					          << e.m_origin
+					          << origin
 					          << " which is removed" << std::endl;
 					return false;
 				}
-				if (e.m_twin == -1) {
+				if (twin == -1) {
 					std::cout << "Dcel::isValid(): half-edge " << i
 							  << " invalid: twin == -1" << std::endl;
 					return false;
 				}
-				if (m_halfEdges[e.m_twin].m_twin != i) {
+				if (d.twin(twin) != i) {
 					std::cout << "Dcel::isValid(): half-edge " << i
 							  << " invalid: twin.twin == "
-							  << m_halfEdges[e.m_twin].m_twin
+							  << d.twin(twin)
 							  << " != " << i << std::endl;
 					return false;
 				}
-				if (m_halfEdges[e.m_twin].removed) {
+				if (d.isHalfEdgeRemoved(twin)) {
 					std::cout << "Dcel::isValid(): half-edge " << i
 					          << " invalid: twin == "
-					          << e.m_twin
+					          << twin
 					          << " which is removed" << std::endl;
 					return false;
 				}
 
 				if (checkFaces) {
-					if (e.m_incidentFace == -1) {
+					int incidentFace = d.incidentFace(i);
+					if (incidentFace == -1) {
 						std::cout << "Dcel::isValid(): half-edge " << i
 								  << " invalid: incidentFace == -1"
 								  << std::endl;
 						return false;
 					}
-					if (m_faces[e.m_incidentFace].removed) {
+					if (d.isFaceRemoved(incidentFace)) {
 						std::cout << "Dcel::isValid(): half-edge " << i
 						          << " invalid: incidentFace == "
-						          << e.m_incidentFace
+						          << incidentFace
 						          << " which is removed" << std::endl;
 						return false;
 					}
@@ -2385,27 +2876,27 @@ class Dcel {
 			}
 
 			if (checkFaces) {
-				for (int i = 0; i < m_faces.size(); i++) {
-					FaceImpl f = m_faces[i];
-					if (f.removed) {
+				for (int i = 0; i < faceCount(); i++) {
+					if (d.isFaceRemoved(i)) {
 						continue;
 					}
-					if (f.m_boundary == -1) {
+					int boundary = d.boundary(i);
+					if (boundary == -1) {
 						std::cout << "Dcel::isValid(): face " << i
 								  << " invalid: boundary == -1" << std::endl;
 						return false;
 					}
-					if (m_halfEdges[f.m_boundary].m_incidentFace != i) {
+					if (d.incidentFace(boundary) != i) {
 						std::cout << "Dcel::isValid(): face " << i
 								  << " invalid: boundary.incidentFace == "
-								  << m_halfEdges[f.m_boundary].m_incidentFace
+								  << d.incidentFace(boundary)
 								  << " != " << i << std::endl;
 						return false;
 					}
-					if (m_halfEdges[f.m_boundary].removed) {
+					if (d.isHalfEdgeRemoved(boundary)) {
 						std::cout << "Dcel::isValid(): face " << i
 						          << " invalid: boundary == "
-						          << f.m_boundary
+						          << boundary
 						          << " which is removed" << std::endl;
 						return false;
 					}
@@ -2433,13 +2924,12 @@ class Dcel {
 			out << "Vertices:\n";
 			out << "--- id ---   --- outgoing ---\n";
 			for (int i = 0; i < vertexCount(); i++) {
-				VertexImpl v = m_vertices[i];
 				out << std::setw(10) << i << "   " <<
-				    std::setw(16) << v.m_outgoing <<
-				    std::setw(4) << (v.removed ? "x" : "");
-				if constexpr (requires {v.m_data.output(out);}) {
+				    std::setw(16) << m_storage.outgoing(i) <<
+				    std::setw(4) << (m_storage.isVertexRemoved(i) ? "x" : "");
+				if constexpr (requires {m_storage.vertexData(i).output(out);}) {
 					out << "    ";
-					v.m_data.output(out);
+					m_storage.vertexData(i).output(out);
 				}
 				out << "\n";
 			}
@@ -2448,17 +2938,16 @@ class Dcel {
 			out << "--- id ---   --- origin ---   --- previous ---   "
 			       "--- next ---   --- twin ---   --- incidentFace ---\n";
 			for (int i = 0; i < halfEdgeCount(); i++) {
-				HalfEdgeImpl e = m_halfEdges[i];
 				out << std::setw(10) << i << "   " <<
-				       std::setw(14) << e.m_origin << "   " <<
-				       std::setw(16) << e.m_previous << "   " <<
-				       std::setw(12) << e.m_next << "   " <<
-				       std::setw(12) << e.m_twin << "   " <<
-				       std::setw(20) << e.m_incidentFace <<
-				       std::setw(4) << (e.removed ? "x" : "");
-				if constexpr (requires {e.m_data.output(out);}) {
+				       std::setw(14) << m_storage.origin(i) << "   " <<
+				       std::setw(16) << m_storage.previous(i) << "   " <<
+				       std::setw(12) << m_storage.next(i) << "   " <<
+				       std::setw(12) << m_storage.twin(i) << "   " <<
+				       std::setw(20) << m_storage.incidentFace(i) <<
+				       std::setw(4) << (m_storage.isHalfEdgeRemoved(i) ? "x" : "");
+				if constexpr (requires {m_storage.halfEdgeData(i).output(out);}) {
 					out << "    ";
-					e.m_data.output(out);
+					m_storage.halfEdgeData(i).output(out);
 				}
 				out << "\n";
 			}
@@ -2466,13 +2955,12 @@ class Dcel {
 			out << "Faces:\n";
 			out << "--- id ---   --- boundary ---\n";
 			for (int i = 0; i < faceCount(); i++) {
-				FaceImpl f = m_faces[i];
 				out << std::setw(10) << i << "   " <<
-				       std::setw(16) << f.m_boundary <<
-				       std::setw(4) << (f.removed ? "x" : "");
-				if constexpr (requires {f.m_data.output(out);}) {
+				       std::setw(16) << m_storage.boundary(i) <<
+				       std::setw(4) << (m_storage.isFaceRemoved(i) ? "x" : "");
+				if constexpr (requires {m_storage.faceData(i).output(out);}) {
 					out << "    ";
-					f.m_data.output(out);
+					m_storage.faceData(i).output(out);
 				}
 				out << "\n";
 			}
@@ -2484,19 +2972,9 @@ class Dcel {
 	protected:
 
 		/**
-		 * The list of vertices.
-		 */
-		std::vector<VertexImpl> m_vertices;
-
-		/**
-		 * The list of half-edges.
+		 * The storage of the vertices, half-edges and faces.
 		 */
-		std::vector<HalfEdgeImpl> m_halfEdges;
-
-		/**
-		 * The list of faces.
-		 */
-		std::vector<FaceImpl> m_faces;
+		Storage<VertexData, HalfEdgeData, FaceData> m_storage;
 };
 
 #endif /* DCEL_H */
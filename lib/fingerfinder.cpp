@@ -1,10 +1,18 @@
 #include "fingerfinder.h"
 
+FingerData::FingerData(const InputDcel& dcel)
+    : halfEdges(dcel.halfEdgeCount()), faces(dcel.faceCount()) {}
+
 FingerFinder::FingerFinder(std::shared_ptr<InputDcel>& dcel,
                                                  const std::shared_ptr<MsComplex>& msComplex,
                                                  double delta,
                                                  std::function<void(int)> progressListener)
-    : m_dcel(dcel), m_msComplex(msComplex), m_delta(delta), m_progressListener(progressListener) {}
+    : m_dcel(dcel), m_msComplex(msComplex), m_delta(delta),
+      m_data(std::make_shared<FingerData>(*dcel)), m_progressListener(progressListener) {}
+
+const std::shared_ptr<FingerData>& FingerFinder::data() const {
+	return m_data;
+}
 
 void
 FingerFinder::signalProgress(int progress) {
@@ -26,16 +34,17 @@ std::vector<InputDcel::Path> FingerFinder::findFingers() {
 	for (size_t i = 0; i < m_dcel->faceCount(); i++) {
 		InputDcel::Face face = m_dcel->face(i);
 		if (m_dcel->isRedLeaf(face)) {
+			FingerData::Face& faceData = m_data->faces[face.id()];
 			auto topEdgeResult = computeTopEdge(face, m_delta);
-			face.data().topEdge = topEdgeResult.first.id();
-			face.data().pathToTopEdge = topEdgeResult.second;
-			face.data().flankingHeight =
-			    m_dcel->halfEdge(face.data().topEdge).data().volumeAbove.heightForVolume(m_delta);
+			faceData.topEdge = topEdgeResult.first.id();
+			faceData.pathToTopEdge = topEdgeResult.second;
+			PiecewiseLinearFunction& topEdgeVolume = m_data->halfEdges[faceData.topEdge].volumeAbove;
+			faceData.flankingHeight = topEdgeVolume.heightForVolume(m_delta);
 			double maximumHeight = maximumVertexHeight(face);
-			double volume = m_dcel->halfEdge(face.data().topEdge).data().volumeAbove(maximumHeight);
+			double volume = topEdgeVolume(maximumHeight);
 			if (volume >= m_delta) {
-				face.data().isSignificant = true;
-				face.data().spurFaces.push_back(topEdgeResult.first.incidentFace().id());
+				faceData.isSignificant = true;
+				faceData.spurFaces.push_back(topEdgeResult.first.incidentFace().id());
 				topEdgeResult.first.incidentFace().forAllReachableFaces(
 					[topEdge = topEdgeResult.first](InputDcel::HalfEdge e) {
 						if (e == topEdge) {
@@ -43,11 +52,11 @@ std::vector<InputDcel::Path> FingerFinder::findFingers() {
 						}
 						return e.data().pairedWithFace || e.twin().data().pairedWithFace;
 					},
-					[&spurFaces = face.data().spurFaces](InputDcel::Face f, InputDcel::HalfEdge) {
+					[&spurFaces = faceData.spurFaces](InputDcel::Face f, InputDcel::HalfEdge) {
 						spurFaces.push_back(f.id());
 					});
-				computeSpurBoundary(topEdgeResult.first, face.data().spurBoundary);
-				face.data().spurBoundary.push_back(topEdgeResult.first.origin().id());
+				computeSpurBoundary(topEdgeResult.first, faceData.spurBoundary);
+				faceData.spurBoundary.push_back(topEdgeResult.first.origin().id());
 			}
 		}
 	}
@@ -67,16 +76,16 @@ std::vector<InputDcel::Path> FingerFinder::findFingers() {
 			// for each spur, put fingers around it
 			for (int i = 0; i < leaves.size(); i++) {
 				InputDcel::Path path;
-				path.addEdge(m_dcel->halfEdge(face.data().topEdge));
+				path.addEdge(m_dcel->halfEdge(m_data->faces[face.id()].topEdge));
 				fingers.push_back(path);
 			}
 		}
 	}*/
 	for (size_t i = 0; i < m_dcel->faceCount(); i++) {
 		InputDcel::Face face = m_dcel->face(i);
-		if (m_dcel->isRedLeaf(face) && face.data().isSignificant) {
-			double flankingHeight = face.data().flankingHeight;
-			std::vector<int> boundary = face.data().spurBoundary;
+		if (m_dcel->isRedLeaf(face) && m_data->faces[face.id()].isSignificant) {
+			double flankingHeight = m_data->faces[face.id()].flankingHeight;
+			std::vector<int> boundary = m_data->faces[face.id()].spurBoundary;
 			int startIndex = -1;
 			for (int i = 0; i < boundary.size(); i++) {
 				if (m_dcel->vertex(boundary[i]).data().p.h < flankingHeight) {
@@ -137,7 +146,7 @@ void FingerFinder::computeVolumesForRedTree(InputDcel::Face face) {
 		}
 		visited[edge.id()] = true;
 		//std::cout << "    " << edge.oppositeFace().data().p << " -> " << edge.incidentFace().data().p << std::endl;
-		edge.data().volumeAbove = volumeAbove(edge);
+		m_data->halfEdges[edge.id()].volumeAbove = volumeAbove(edge);
 		size_t unvisitedCount = 0;
 		InputDcel::HalfEdge unvisited;
 		edge.oppositeFace().forAllBoundaryEdges(
@@ -179,8 +188,7 @@ PiecewiseLinearFunction FingerFinder::volumeAbove(InputDcel::HalfEdge edge) {
 			return;
 		}
 		if (e.data().pairedWithFace || e.twin().data().pairedWithFace) {
-			PiecewiseLinearFunction descendantVolume = e.twin().data().volumeAbove;
-			result = result.add(descendantVolume);
+			result += m_data->halfEdges[e.twin().id()].volumeAbove;
 		}
 	});
 	double cutOffHeight = std::max(edge.origin().data().p.h, edge.destination().data().p.h);
@@ -198,8 +206,9 @@ std::pair<InputDcel::HalfEdge, std::vector<int>> FingerFinder::computeTopEdge(In
 		}
 	});
 	assert(candidate.isInitialized());
-	double candidateHeight = std::min(candidate.data().volumeAbove.heightForVolume(delta),
-	                                  candidate.twin().data().volumeAbove.heightForVolume(delta));
+	double candidateHeight =
+	    std::min(m_data->halfEdges[candidate.id()].volumeAbove.heightForVolume(delta),
+	             m_data->halfEdges[candidate.twin().id()].volumeAbove.heightForVolume(delta));
 	double height;
 	std::vector<int> path;
 	path.push_back(f.id());
@@ -214,8 +223,8 @@ std::pair<InputDcel::HalfEdge, std::vector<int>> FingerFinder::computeTopEdge(In
 		edge.oppositeFace().forAllBoundaryEdges([this, &candidate, &candidateHeight, height,
 		                                         &higherCount, delta](InputDcel::HalfEdge e) {
 			if (e.data().pairedWithFace || e.twin().data().pairedWithFace) {
-				double h = std::min(e.data().volumeAbove.heightForVolume(delta),
-				                    e.twin().data().volumeAbove.heightForVolume(delta));
+				double h = std::min(m_data->halfEdges[e.id()].volumeAbove.heightForVolume(delta),
+				                    m_data->halfEdges[e.twin().id()].volumeAbove.heightForVolume(delta));
 				if (h > height) {
 					higherCount++;
 				}
@@ -248,7 +257,7 @@ std::vector<InputDcel::Face> FingerFinder::findSignificantLeafOrder(InputDcel::F
 void FingerFinder::findSignificantLeafOrderForSubtree(InputDcel::HalfEdge edge,
                                                       std::vector<InputDcel::Face>& order) {
 	if (m_dcel->isRedLeaf(edge.incidentFace())) {
-		if (edge.incidentFace().data().isSignificant) {
+		if (m_data->faces[edge.incidentFace().id()].isSignificant) {
 			//std::cout << "    found significant leaf " << edge.incidentFace().data().p << std::endl;
 			order.push_back(edge.incidentFace());
 		}
@@ -7,6 +7,66 @@
 
 #include "mscomplex.h"
 
+/**
+ * The data that the FingerFinder computes for the half-edges and faces of an
+ * InputDcel.
+ *
+ * This is stored separately from the InputDcel, so that the InputDcel does
+ * not need to store it for every half-edge and face when fingers are not
+ * computed.
+ */
+class FingerData {
+
+	public:
+
+		/**
+		 * The data for a half-edge.
+		 */
+		class HalfEdge {
+
+			public:
+
+				/**
+				 * The volume of the part of the red tree that arises when we
+				 * cut the red tree at this half-edge.
+				 */
+				PiecewiseLinearFunction volumeAbove;
+		};
+
+		/**
+		 * The data for a face.
+		 */
+		class Face {
+
+			public:
+
+				/**
+				 * The ID of the half edge that forms the top edge of this
+				 * face. Only defined for leaves in the red tree.
+				 */
+				int topEdge = -1;
+
+				/// Holds face IDs
+				std::vector<int> pathToTopEdge;
+				std::vector<int> spurFaces;
+				/// Holds vertex IDs
+				std::vector<int> spurBoundary;
+
+				double flankingHeight;
+				bool isSignificant = false;
+		};
+
+		/**
+		 * Creates empty data for all half-edges and faces of the given DCEL.
+		 */
+		FingerData(const InputDcel& dcel);
+
+		/// The data of the half-edges, indexed by half-edge ID.
+		std::vector<HalfEdge> halfEdges;
+		/// The data of the faces, indexed by face ID.
+		std::vector<Face> faces;
+};
+
 class FingerFinder {
 
 	public:
@@ -15,18 +75,27 @@ class FingerFinder {
 
 		std::vector<InputDcel::Path> findFingers();
 
+		/**
+		 * Returns the data computed by findFingers() for the half-edges and
+		 * faces of the DCEL.
+		 */
+		const std::shared_ptr<FingerData>& data() const;
+
 	private:
 		std::shared_ptr<InputDcel> m_dcel;
 		const std::shared_ptr<MsComplex> m_msComplex;
 		double m_delta;
 
+		/// The data computed for the half-edges and faces of the DCEL.
+		std::shared_ptr<FingerData> m_data;
+
 		/**
 		 * Returns a piecewise cubic function representing the volume of sand
 		 * above any faces reachable from this halfedge by following edge-face
 		 * gradient pairs.
 		 *
-		 * This method assumes that the volumeAbove fields of all descendants
-		 * have already been set.
+		 * This method assumes that the volumeAbove of all descendants have
+		 * already been set.
 		 *
 		 * \param edge The halfedge to return the sand function of.
 		 * \return The resulting sand function.
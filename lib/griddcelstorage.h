@@ -0,0 +1,304 @@
+#ifndef GRIDDCELSTORAGE_H
+#define GRIDDCELSTORAGE_H
+
+#include <cassert>
+
+#include "dcel.h"
+
+/**
+ * \brief Storage policy for the Dcel that can represent a rectangular grid
+ * implicitly.
+ *
+ * In its default (explicit) mode, this policy behaves like DcelSoaStorage.
+ *
+ * Alternatively, the storage can be switched to grid mode using
+ * initializeGrid(). In that mode, it represents the subdivision formed by a
+ * 4-connected grid of `width` × `height` vertices without storing any pointers
+ * at all: all of them are computed arithmetically from the IDs of the
+ * elements. Only the element data is stored. The grid cannot be modified;
+ * calling any setter in grid mode is an error.
+ *
+ * In grid mode, the elements are numbered as follows.
+ *
+ * * The vertex at grid coordinate (x, y) has ID `y * width + x`.
+ * * Each edge has two consecutive half-edge IDs `2k` and `2k + 1`, which are
+ *   each other's twins. The edges between (x, y) and (x + 1, y) come first,
+ *   with `k = y * (width - 1) + x`; the half-edge `2k` points in positive
+ *   x-direction. Then the edges between (x, y) and (x, y + 1) follow, with
+ *   `k = (width - 1) * height + y * width + x`; the half-edge `2k` points in
+ *   positive y-direction.
+ * * The face whose top-left corner is (x, y) has ID `y * (width - 1) + x`.
+ *   The outer face is the last face.
+ *
+ * Directions are numbered as in GridTraversal: 0 is towards positive x, 1
+ * towards negative y, 2 towards negative x, and 3 towards positive y. Around
+ * each vertex, the outgoing half-edges are in counter-clockwise order (if the
+ * y-coordinate increases in downwards direction), which is the order of
+ * increasing direction.
+ *
+ * \tparam VertexData The vertex data type.
+ * \tparam HalfEdgeData The half-edge data type.
+ * \tparam FaceData The face data type.
+ */
+template<typename VertexData, typename HalfEdgeData, typename FaceData>
+class GridDcelStorage : public DcelSoaStorage<VertexData, HalfEdgeData, FaceData> {
+
+		using Base = DcelSoaStorage<VertexData, HalfEdgeData, FaceData>;
+
+	public:
+
+		/**
+		 * Switches this storage to grid mode, representing a grid of the
+		 * given size. The storage needs to be empty.
+		 *
+		 * \param width The number of vertices in x-direction. Needs to be at
+		 * least 2.
+		 * \param height The number of vertices in y-direction. Needs to be at
+		 * least 2.
+		 */
+		void initializeGrid(int width, int height) {
+			assert(Base::vertexCount() == 0 && Base::halfEdgeCount() == 0 && Base::faceCount() == 0);
+			assert(width >= 2 && height >= 2);
+			m_width = width;
+			m_height = height;
+			m_horizontalEdgeCount = (width - 1) * height;
+			Base::m_vertexData.resize(width * height);
+			Base::m_halfEdgeData.resize(2 * (m_horizontalEdgeCount + width * (height - 1)));
+			Base::m_faceData.resize((width - 1) * (height - 1) + 1);
+		}
+
+		/// Returns whether this storage is in grid mode.
+		bool isGrid() const {
+			return m_width != 0;
+		}
+
+		/// Returns the ID of the vertex at the given grid coordinate.
+		/// \note Only valid in grid mode.
+		int gridVertex(int x, int y) const {
+			assert(isGrid());
+			return y * m_width + x;
+		}
+
+		/// Returns the ID of the half-edge leaving the given grid coordinate in
+		/// the given direction, or `-1` if that half-edge would leave the grid.
+		/// \note Only valid in grid mode.
+		int gridHalfEdge(int x, int y, int direction) const {
+			assert(isGrid());
+			switch (direction) {
+				case 0:
+					return x < m_width - 1 ? 2 * (y * (m_width - 1) + x) : -1;
+				case 1:
+					return y > 0 ? 2 * (m_horizontalEdgeCount + (y - 1) * m_width + x) + 1
+					             : -1;
+				case 2:
+					return x > 0 ? 2 * (y * (m_width - 1) + x - 1) + 1 : -1;
+				default:
+					return y < m_height - 1 ? 2 * (m_horizontalEdgeCount + y * m_width + x)
+					                        : -1;
+			}
+		}
+
+		/// Returns the ID of the outer face.
+		/// \note Only valid in grid mode.
+		int gridOuterFace() const {
+			assert(isGrid());
+			return (m_width - 1) * (m_height - 1);
+		}
+
+		/// \name Vertices
+		///@{
+		int addVertex() {
+			assert(!isGrid());
+			return Base::addVertex();
+		}
+		int outgoing(int v) const {
+			if (isGrid()) {
+				for (int direction = 0; direction < 4; direction++) {
+					int e = gridHalfEdge(v % m_width, v / m_width, direction);
+					if (e != -1) {
+						return e;
+					}
+				}
+				return -1;
+			}
+			return Base::outgoing(v);
+		}
+		void setOutgoing(int v, int e) {
+			assert(!isGrid());
+			Base::setOutgoing(v, e);
+		}
+		bool isVertexRemoved(int v) const {
+			return !isGrid() && Base::isVertexRemoved(v);
+		}
+		void setVertexRemoved(int v) {
+			assert(!isGrid());
+			Base::setVertexRemoved(v);
+		}
+		///@}
+
+		/// \name Half-edges
+		///@{
+		int addHalfEdge() {
+			assert(!isGrid());
+			return Base::addHalfEdge();
+		}
+		int origin(int e) const {
+			if (isGrid()) {
+				GridHalfEdge g = decode(e);
+				return gridVertex(g.x, g.y);
+			}
+			return Base::origin(e);
+		}
+		void setOrigin(int e, int v) {
+			assert(!isGrid());
+			Base::setOrigin(e, v);
+		}
+		int twin(int e) const {
+			if (isGrid()) {
+				return e ^ 1;
+			}
+			return Base::twin(e);
+		}
+		void setTwin(int e, int twin) {
+			assert(!isGrid());
+			Base::setTwin(e, twin);
+		}
+		int previous(int e) const {
+			if (isGrid()) {
+				// the previous outgoing half-edge around the origin,
+				// reversed
+				GridHalfEdge g = decode(e);
+				for (int i = 3; i > 0; i--) {
+					int previousOutgoing =
+					        gridHalfEdge(g.x, g.y, (g.direction + i) % 4);
+					if (previousOutgoing != -1) {
+						return previousOutgoing ^ 1;
+					}
+				}
+				return e ^ 1;
+			}
+			return Base::previous(e);
+		}
+		void setPrevious(int e, int previous) {
+			assert(!isGrid());
+			Base::setPrevious(e, previous);
+		}
+		int next(int e) const {
+			if (isGrid()) {
+				// the next outgoing half-edge around the destination, after
+				// the twin
+				GridHalfEdge g = decode(e ^ 1);
+				for (int i = 1; i < 4; i++) {
+					int nextOutgoing =
+					        gridHalfEdge(g.x, g.y, (g.direction + i) % 4);
+					if (nextOutgoing != -1) {
+						return nextOutgoing;
+					}
+				}
+				return e ^ 1;
+			}
+			return Base::next(e);
+		}
+		void setNext(int e, int next) {
+			assert(!isGrid());
+			Base::setNext(e, next);
+		}
+		int incidentFace(int e) const {
+			if (isGrid()) {
+				GridHalfEdge g = decode(e);
+				switch (g.direction) {
+					case 0:
+						return g.y < m_height - 1 ? gridFace(g.x, g.y) : gridOuterFace();
+					case 1:
+						return g.x < m_width - 1 ? gridFace(g.x, g.y - 1) : gridOuterFace();
+					case 2:
+						return g.y > 0 ? gridFace(g.x - 1, g.y - 1) : gridOuterFace();
+					default:
+						return g.x > 0 ? gridFace(g.x - 1, g.y) : gridOuterFace();
+				}
+			}
+			return Base::incidentFace(e);
+		}
+		void setIncidentFace(int e, int f) {
+			assert(!isGrid());
+			Base::setIncidentFace(e, f);
+		}
+		bool isHalfEdgeRemoved(int e) const {
+			return !isGrid() && Base::isHalfEdgeRemoved(e);
+		}
+		void setHalfEdgeRemoved(int e) {
+			assert(!isGrid());
+			Base::setHalfEdgeRemoved(e);
+		}
+		///@}
+
+		/// \name Faces
+		///@{
+		int addFace() {
+			assert(!isGrid());
+			return Base::addFace();
+		}
+		int boundary(int f) const {
+			if (isGrid()) {
+				if (f == gridOuterFace()) {
+					return gridHalfEdge(0, m_height - 1, 0);
+				}
+				return gridHalfEdge(f % (m_width - 1), f / (m_width - 1), 0);
+			}
+			return Base::boundary(f);
+		}
+		void setBoundary(int f, int e) {
+			assert(!isGrid());
+			Base::setBoundary(f, e);
+		}
+		bool isFaceRemoved(int f) const {
+			return !isGrid() && Base::isFaceRemoved(f);
+		}
+		void setFaceRemoved(int f) {
+			assert(!isGrid());
+			Base::setFaceRemoved(f);
+		}
+		///@}
+
+	private:
+
+		/// A half-edge in grid mode, described by the grid coordinate of its
+		/// origin and its direction.
+		struct GridHalfEdge {
+			int x;
+			int y;
+			int direction;
+		};
+
+		/// Computes the origin and direction of the given half-edge in grid
+		/// mode.
+		GridHalfEdge decode(int e) const {
+			int k = e / 2;
+			bool reversed = e % 2 == 1;
+			if (k < m_horizontalEdgeCount) {
+				int x = k % (m_width - 1);
+				int y = k / (m_width - 1);
+				return reversed ? GridHalfEdge{x + 1, y, 2} : GridHalfEdge{x, y, 0};
+			}
+			k -= m_horizontalEdgeCount;
+			int x = k % m_width;
+			int y = k / m_width;
+			return reversed ? GridHalfEdge{x, y + 1, 1} : GridHalfEdge{x, y, 3};
+		}
+
+		/// Returns the ID of the face whose top-left corner is the given grid
+		/// coordinate.
+		int gridFace(int x, int y) const {
+			return y * (m_width - 1) + x;
+		}
+
+		/// The number of vertices in x-direction in grid mode, or 0 if this
+		/// storage is in explicit mode.
+		int m_width = 0;
+		/// The number of vertices in y-direction in grid mode.
+		int m_height = 0;
+		/// The number of edges in x-direction in grid mode.
+		int m_horizontalEdgeCount = 0;
+};
+
+#endif // GRIDDCELSTORAGE_H
@@ -0,0 +1,163 @@
+#include "gridtraversal.h"
+
+#include <cassert>
+#include <queue>
+
+static constexpr int directionDx[] = {1, 0, -1, 0};
+static constexpr int directionDy[] = {0, -1, 0, 1};
+
+GridTraversal::GridTraversal(const HeightMap& heightMap, const Boundary& boundary) :
+    m_heightMap(heightMap), m_boundary(boundary.rasterize()),
+    m_ids(heightMap.width() * heightMap.height(), -1) {}
+
+HeightMap::Coordinate GridTraversal::applyDirection(HeightMap::Coordinate c, int direction) {
+	return {c.m_x + directionDx[direction], c.m_y + directionDy[direction]};
+}
+
+int GridTraversal::directionBetween(HeightMap::Coordinate c1, HeightMap::Coordinate c2) {
+	for (int i = 0; i < 4; i++) {
+		if (c2.m_x == c1.m_x + directionDx[i] && c2.m_y == c1.m_y + directionDy[i]) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+int GridTraversal::cell(HeightMap::Coordinate c) const {
+	return c.m_y * m_heightMap.width() + c.m_x;
+}
+
+bool GridTraversal::coversHeightMap() const {
+	const int width = m_heightMap.width();
+	const int height = m_heightMap.height();
+	const Path& path = m_boundary.path();
+	if (width < 2 || height < 2 || path.length() != 2 * (width + height) - 4) {
+		return false;
+	}
+
+	// The path is closed and has exactly as many edges as there are
+	// coordinates on the border of the heightmap. Hence, it runs along the
+	// entire border if and only if it visits every border coordinate once.
+	std::vector<bool> onPath(width * height, false);
+	for (int i = 0; i < path.length(); i++) {
+		HeightMap::Coordinate c = path.m_points[i];
+		bool onBorder = c.m_x == 0 || c.m_x == width - 1 || c.m_y == 0 || c.m_y == height - 1;
+		if (!m_heightMap.isInBounds(c) || !onBorder || onPath[cell(c)]) {
+			return false;
+		}
+		onPath[cell(c)] = true;
+	}
+	return true;
+}
+
+int GridTraversal::idAt(HeightMap::Coordinate c) const {
+	return m_ids[cell(c)];
+}
+
+void GridTraversal::run(
+        const std::function<void(int id, HeightMap::Coordinate c)>& discovered,
+        const std::function<void(int id, HeightMap::Coordinate c,
+                                 const std::vector<Neighbor>& neighbors)>& visited) {
+	const Path& path = m_boundary.path();
+
+	// Preparation: keep track of which vertices are on the boundary, and in
+	// which direction their incoming boundary edge goes.
+	std::vector<signed char> incomingBoundaryEdge(m_ids.size(), -1);
+	for (int i = 0; i < path.m_points.size() - 1; i++) {
+		HeightMap::Coordinate p1 = path.m_points[i];
+		HeightMap::Coordinate p2 = path.m_points[i + 1];
+		incomingBoundaryEdge[cell(p2)] = directionBetween(p2, p1);
+	}
+
+	// Do a BFS through the area between the boundary edges to find all vertices
+	// and edges that lie on the boundary or inside it.
+	std::vector<bool> isVisited(m_ids.size(), false);
+	std::queue<HeightMap::Coordinate> queue;
+	int idCount = 0;
+	std::vector<Neighbor> neighbors;
+	neighbors.reserve(4);
+
+	HeightMap::Coordinate start = path.start();
+	queue.push(start);
+	m_ids[cell(start)] = idCount++;
+	discovered(m_ids[cell(start)], start);
+
+	while (!queue.empty()) {
+		HeightMap::Coordinate coordinate = queue.front();
+		queue.pop();
+		if (isVisited[cell(coordinate)]) {
+			continue;
+		}
+		isVisited[cell(coordinate)] = true;
+		int id = m_ids[cell(coordinate)];
+		assert(id != -1);
+
+		// If the source vertex is on the inside, we don't care in which order
+		// we consider its incident edges. However, if the source vertex is on
+		// the boundary, we want to consider its incident edges starting from
+		// the incident (incoming) boundary edge b.
+		int startDirection = 0;
+		if (incomingBoundaryEdge[cell(coordinate)] != -1) {
+			startDirection = incomingBoundaryEdge[cell(coordinate)];
+		}
+
+		// Now consider the incident edges, starting from the start edge we just
+		// determined.
+		neighbors.clear();
+		for (int i = 0; i < 4; i++) {
+			int direction = (i + startDirection) % 4;
+
+			// Ignore edges that go out of bounds.
+			HeightMap::Coordinate target = applyDirection(coordinate, direction);
+			if (!m_heightMap.isInBounds(target)) {
+				continue;
+			}
+
+			// Assign an ID to the destination vertex if it doesn't have one
+			// yet.
+			if (m_ids[cell(target)] == -1) {
+				m_ids[cell(target)] = idCount++;
+				discovered(m_ids[cell(target)], target);
+			}
+			neighbors.push_back(Neighbor{m_ids[cell(target)], direction});
+
+			// Add the target vertex to the queue.
+			queue.push(target);
+
+			// If the edge we just added was the incoming boundary edge, then
+			// this was the last edge on the inside, hence we should stop.
+			if (incomingBoundaryEdge[cell(target)] == (direction + 2) % 4) {
+				break;
+			}
+		}
+		visited(id, coordinate, neighbors);
+	}
+}
+
+void GridTraversal::forAllBoundaryElements(
+        const std::function<void(int id, HeightMap::Coordinate c, BoundaryStatus status,
+                                 std::optional<int> permeableRegion)>& markVertex,
+        const std::function<void(int from, int to, HeightMap::Coordinate c,
+                                 int direction, BoundaryStatus status,
+                                 std::optional<int> permeableRegion)>& markEdge) const {
+	const Path& path = m_boundary.path();
+	auto mark = [&](int i, BoundaryStatus status, std::optional<int> permeableRegion) {
+		HeightMap::Coordinate c1 = path.m_points[i];
+		HeightMap::Coordinate c2 = path.m_points[(i + 1) % path.length()];
+		markVertex(idAt(c1), c1, status, permeableRegion);
+		markVertex(idAt(c2), c2, status, permeableRegion);
+		markEdge(idAt(c1), idAt(c2), c1, directionBetween(c1, c2), status, permeableRegion);
+	};
+
+	// Mark adjacencies on the boundary as being on an impermeable or a
+	// permeable section of said boundary.
+	for (int i = 0; i < path.length(); i++) {
+		mark(i, BoundaryStatus::IMPERMEABLE, std::nullopt);
+	}
+	for (int regionId = 0; regionId < m_boundary.permeableRegions().size(); regionId++) {
+		const Boundary::Region& region = m_boundary.permeableRegions()[regionId];
+		for (int i = region.m_start; i != region.m_end; i = (i + 1) % path.length()) {
+			mark(i, BoundaryStatus::PERMEABLE, i);
+		}
+	}
+}
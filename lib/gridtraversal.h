@@ -0,0 +1,113 @@
+#ifndef GRIDTRAVERSAL_H
+#define GRIDTRAVERSAL_H
+
+#include <functional>
+#include <optional>
+#include <vector>
+
+#include "boundary.h"
+#include "boundarystatus.h"
+#include "heightmap.h"
+
+/**
+ * Breadth-first traversal of the heightmap coordinates that lie on or inside a
+ * boundary.
+ *
+ * This traversal determines the vertex IDs and the (counter-clockwise) order
+ * of the adjacencies of both the InputGraph and the InputDcel built from a
+ * heightmap, so that both structures number their elements identically.
+ *
+ * Vertex IDs are assigned in the order in which coordinates are discovered.
+ * Because the traversal is breadth-first, coordinates are also visited in
+ * that order; that is, the coordinate with ID `i` is visited only after all
+ * coordinates with IDs smaller than `i` have been visited.
+ */
+class GridTraversal {
+
+	public:
+
+		/// A neighbor of a coordinate, as reported by run().
+		struct Neighbor {
+			/// The ID of the neighbor.
+			int id;
+			/// The direction from the visited coordinate to the neighbor:
+			/// 0 is towards positive x, 1 towards negative y, 2 towards
+			/// negative x, and 3 towards positive y.
+			int direction;
+		};
+
+		/**
+		 * Prepares a traversal of the given heightmap.
+		 *
+		 * \param heightMap The heightmap.
+		 * \param boundary The boundary. Everything inside this boundary is
+		 * traversed. This is rasterized before use.
+		 */
+		GridTraversal(const HeightMap& heightMap, const Boundary& boundary);
+
+		/**
+		 * Runs the traversal.
+		 *
+		 * \param discovered Called when a coordinate is assigned an ID. This
+		 * happens in order of increasing IDs.
+		 * \param visited Called when the neighbors of a coordinate are known.
+		 * The neighbors are given in counter-clockwise order; for coordinates
+		 * on the boundary they start from the incoming boundary edge. This
+		 * too happens in order of increasing IDs.
+		 */
+		void run(const std::function<void(int id, HeightMap::Coordinate c)>& discovered,
+		         const std::function<void(int id, HeightMap::Coordinate c,
+		                                  const std::vector<Neighbor>& neighbors)>& visited);
+
+		/**
+		 * Reports the boundary status of the vertices and edges on the
+		 * boundary. Impermeable parts are reported first, followed by the
+		 * permeable regions, so that later calls should overwrite earlier
+		 * ones.
+		 *
+		 * \note The reported IDs are only valid after run(); before that, they
+		 * are `-1`.
+		 *
+		 * \param markVertex Called for a vertex on the boundary, with its ID
+		 * and coordinate.
+		 * \param markEdge Called for an edge on the boundary, with the IDs of
+		 * its endpoints, the coordinate of the first endpoint and the
+		 * direction from the first to the second endpoint.
+		 */
+		void forAllBoundaryElements(
+		        const std::function<void(int id, HeightMap::Coordinate c, BoundaryStatus status,
+		                                 std::optional<int> permeableRegion)>& markVertex,
+		        const std::function<void(int from, int to, HeightMap::Coordinate c,
+		                                 int direction, BoundaryStatus status,
+		                                 std::optional<int> permeableRegion)>& markEdge) const;
+
+		/// Returns whether the rasterized boundary runs exactly along the
+		/// border of the heightmap, so that the traversal covers every
+		/// coordinate of the heightmap.
+		bool coversHeightMap() const;
+
+		/// Returns the ID assigned to the given coordinate, or -1 if it is not
+		/// inside the boundary.
+		int idAt(HeightMap::Coordinate c) const;
+
+		/// Returns the coordinate obtained by going one step in the given
+		/// direction from the starting coordinate `c`.
+		static HeightMap::Coordinate applyDirection(HeightMap::Coordinate c, int direction);
+
+		/// Returns the direction between the two given (adjacent)
+		/// coordinates, or -1 if they are not adjacent.
+		static int directionBetween(HeightMap::Coordinate c1, HeightMap::Coordinate c2);
+
+	private:
+		/// Returns the index of the given coordinate in the row-major arrays.
+		int cell(HeightMap::Coordinate c) const;
+
+		/// The heightmap we are traversing.
+		const HeightMap& m_heightMap;
+		/// The rasterized boundary.
+		Boundary m_boundary;
+		/// For each coordinate (row-major), the ID assigned to it, or -1.
+		std::vector<int> m_ids;
+};
+
+#endif // GRIDTRAVERSAL_H
@@ -25,6 +25,10 @@ void HeightMap::setElevationAt(Coordinate c, double elevation) {
 	setElevationAt(c.m_x, c.m_y, elevation);
 }
 
+double* HeightMap::data() {
+	return m_data.data();
+}
+
 int HeightMap::width() const {
 	return m_width;
 }
@@ -80,6 +80,11 @@ class HeightMap {
 		/// `isInBounds(c)`.
 		void setElevationAt(Coordinate c, double elevation);
 
+		/// Returns the elevation values, in row-major order: the elevation at
+		/// (x, y) is stored at `data()[width() * y + x]`. This allows filling
+		/// the heightmap without a call to \ref setElevationAt() per value.
+		double* data();
+
 		/// Returns the width of this heightmap.
 		int width() const;
 		/// Returns the height of this heightmap.
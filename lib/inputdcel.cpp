@@ -1,10 +1,11 @@
 #include "inputdcel.h"
 
 #include <algorithm>
+#include <cmath>
 #include <limits>
 
-#include <algorithm>
-#include <limits>
+#include "gridtraversal.h"
+#include "parallel.h"
 
 void InputDcelVertex::output(std::ostream& out) {
 	out << p;
@@ -22,34 +23,35 @@ InputDcel::InputDcel(const InputGraph& g) {
 		v.data().boundaryStatus = g[i].boundaryStatus;
 		v.data().permeableRegion = g[i].permeableRegion;
 	}
+	buildVertexRaster();
 
-	// Stores for each vertex the outgoing half-edges, in order of adj.
-	// `heAdj[v][i]` stores the half-edge corresponding to `g[v].adj[i]`.
-	std::vector<std::vector<int>> heAdj;
-	heAdj.reserve(g.vertexCount());
-	for (int v = 0; v < g.vertexCount(); v++) {
-		heAdj.emplace_back(g[v].adj.size(), -1);
-	}
+	// Stores for each adjacency the corresponding half-edge. The adjacencies
+	// are numbered as in the flat adjacency array of the graph, that is,
+	// `heAdj[g[v].adj.indexOf(i)]` stores the half-edge corresponding to
+	// `g[v].adj[i]`.
+	std::vector<int> heAdj(g.adjacencyCount(), -1);
 
 	// For each vertex, create its incident edges.
 	for (int v = 0; v < g.vertexCount(); v++) {
-		for (int i = 0; i < g[v].adj.size(); i++) {
-			const InputGraph::Adjacency& a = g[v].adj[i];
+		const InputGraph::AdjacencyList adj = g[v].adj;
+		for (int i = 0; i < adj.size(); i++) {
 
 			// Ensure that we generate edges only in one direction, to avoid
 			// duplicates.
-			if (a.from < a.to) {
+			if (v < adj.to(i)) {
+				const InputGraph::Adjacency a = adj[i];
 				HalfEdge e = addEdge(vertex(a.from), vertex(a.to));
 				e.data().boundaryStatus = a.boundaryStatus;
 				e.twin().data().boundaryStatus = a.boundaryStatus;
 				e.data().permeableRegion = a.permeableRegion;
 				e.twin().data().permeableRegion = a.permeableRegion;
-				heAdj[v][i] = e.id();
+				heAdj[adj.indexOf(i)] = e.id();
 
 				// Find v in `g[neighbor].adj`.
-				std::optional<int> backIndex = g[a.to].findAdjacencyTo(a.from);
+				const InputGraph::Vertex neighbor = g[a.to];
+				std::optional<int> backIndex = neighbor.findAdjacencyTo(a.from);
 				assert(backIndex.has_value());
-				heAdj[a.to][*backIndex] = e.id() + 1;
+				heAdj[neighbor.adj.indexOf(*backIndex)] = e.id() + 1;
 			}
 		}
 	}
@@ -57,12 +59,15 @@ InputDcel::InputDcel(const InputGraph& g) {
 	// Set the outgoing, next and previous pointers.
 	for (int i = 0; i < vertexCount(); i++) {
 		Vertex v = vertex(i);
+		const InputGraph::AdjacencyList adj = g[i].adj;
+		const int degree = adj.size();
 
-		if (heAdj[i].size() > 0) {
-			v.setOutgoing(halfEdge(heAdj[i][0]));
+		if (degree > 0) {
+			v.setOutgoing(halfEdge(heAdj[adj.indexOf(0)]));
 		}
-		for (int j = 0; j < g[i].adj.size(); j++) {
-			halfEdge(heAdj[i][j]).twin().setNext(halfEdge(heAdj[i][(j + 1) % heAdj[i].size()]));
+		for (int j = 0; j < degree; j++) {
+			halfEdge(heAdj[adj.indexOf(j)]).twin().setNext(
+			    halfEdge(heAdj[adj.indexOf((j + 1) % degree)]));
 		}
 	}
 
@@ -73,72 +78,189 @@ InputDcel::InputDcel(const InputGraph& g) {
 	// outer face. Hence, we simply take the half-edge from vertex 0 to its
 	// first adjacency in the list; its incident face has to be the outer face.
 	assert(g[0].boundaryStatus != BoundaryStatus::INTERIOR);
-	m_outerFaceId = halfEdge(heAdj[0][0]).incidentFace().id();
-
-	setEdgeAndFaceCoordinates();
+	m_outerFaceId = halfEdge(heAdj[g[0].adj.indexOf(0)]).incidentFace().id();
 }
 
-void InputDcel::setEdgeAndFaceCoordinates() {
-	for (size_t i = 0; i < halfEdgeCount(); i++) {
-		HalfEdge e = halfEdge(i);
-		e.data().p = (e.origin().data().p + e.destination().data().p) * 0.5;
-		e.data().p.h = std::max(e.origin().data().p.h, e.destination().data().p.h);
+InputDcel::InputDcel(const HeightMap& heightMap, const Boundary& boundary) {
+	const int width = heightMap.width();
+	GridTraversal traversal(heightMap, boundary);
+
+#if !defined(INPUT_DCEL_AOS_STORAGE) && !defined(INPUT_DCEL_SOA_STORAGE)
+	// If the boundary encloses the entire heightmap, we don't need to store
+	// the topology at all.
+	if (traversal.coversHeightMap()) {
+		m_storage.initializeGrid(width, heightMap.height());
+		for (int y = 0; y < heightMap.height(); y++) {
+			for (int x = 0; x < width; x++) {
+				m_storage.vertexData(m_storage.gridVertex(x, y)).p =
+				        Point{static_cast<double>(x), static_cast<double>(y),
+				              heightMap.elevationAt(x, y)};
+			}
+		}
+		traversal.forAllBoundaryElements(
+		    [this](int, HeightMap::Coordinate c, BoundaryStatus status,
+		           std::optional<int> permeableRegion) {
+			    InputDcelVertex& v = m_storage.vertexData(m_storage.gridVertex(c.m_x, c.m_y));
+			    v.boundaryStatus = status;
+			    v.permeableRegion = permeableRegion;
+		    },
+		    [this](int, int, HeightMap::Coordinate c, int direction, BoundaryStatus status,
+		           std::optional<int> permeableRegion) {
+			    HalfEdge e = halfEdge(m_storage.gridHalfEdge(c.m_x, c.m_y, direction));
+			    e.data().boundaryStatus = status;
+			    e.twin().data().boundaryStatus = status;
+			    e.data().permeableRegion = permeableRegion;
+			    e.twin().data().permeableRegion = permeableRegion;
+		    });
+		m_outerFaceId = m_storage.gridOuterFace();
+		// vertex IDs follow from the coordinates (see vertexIdAt())
+		m_rasterWidth = width;
+		m_rasterHeight = heightMap.height();
+		return;
 	}
-	for (size_t i = 0; i < faceCount(); i++) {
-		Face f = face(i);
-		if (f == outerFace()) {
-			f.data().p = {-1, -1, -std::numeric_limits<double>::infinity()};
-		} else {
-			Point sum;
-			double max = -std::numeric_limits<double>::infinity();
-			int count = 0;
-			f.forAllBoundaryVertices([&sum, &max, &count](Vertex v) {
-				sum += v.data().p;
-				max = std::max(max, v.data().p.h);
-				count++;
-			});
-			f.data().p = sum * (1.0 / count);
-			f.data().p.h = max;
+#endif
+
+	// For each heightmap coordinate (row-major), the half-edges corresponding
+	// to the edges towards the right and downwards neighbor, or -1 if these
+	// have not been created (yet). The stored half-edge always has the vertex
+	// with the lower ID as its origin.
+	std::vector<int> rightEdge(width * heightMap.height(), -1);
+	std::vector<int> downEdge(width * heightMap.height(), -1);
+	auto edgeSlot = [&](HeightMap::Coordinate c, int direction) -> int& {
+		switch (direction) {
+			case 0:
+				return rightEdge[c.m_y * width + c.m_x];
+			case 1:
+				return downEdge[(c.m_y - 1) * width + c.m_x];
+			case 2:
+				return rightEdge[c.m_y * width + c.m_x - 1];
+			default:
+				return downEdge[c.m_y * width + c.m_x];
+		}
+	};
+	auto outgoingEdge = [this](int edgeId, int origin) {
+		HalfEdge e = halfEdge(edgeId);
+		return e.origin().id() == origin ? e : e.twin();
+	};
+
+	// As the traversal visits vertices in order of their IDs, we generate the
+	// half-edges in the same order as InputDcel(const InputGraph&) does. When
+	// a vertex is visited, the edges to its neighbors with lower IDs have
+	// already been created, so all outgoing half-edges are known and we can
+	// set the next pointers right away.
+	int outerEdge = -1;
+	std::vector<HalfEdge> outgoing;
+	outgoing.reserve(4);
+	m_rasterWidth = width;
+	m_rasterHeight = heightMap.height();
+	m_vertexRaster.assign(width * heightMap.height(), -1);
+	traversal.run(
+	    [this, &heightMap, width](int id, HeightMap::Coordinate c) {
+		    Vertex v = addVertex();
+		    assert(v.id() == id);
+		    m_vertexRaster[c.m_y * width + c.m_x] = id;
+		    v.data().p = Point{static_cast<double>(c.m_x), static_cast<double>(c.m_y),
+		                       heightMap.elevationAt(c)};
+	    },
+	    [&](int id, HeightMap::Coordinate c,
+	        const std::vector<GridTraversal::Neighbor>& neighbors) {
+		    outgoing.clear();
+		    for (const GridTraversal::Neighbor& neighbor : neighbors) {
+			    int& slot = edgeSlot(c, neighbor.direction);
+			    if (slot == -1) {
+				    assert(id < neighbor.id);
+				    slot = addEdge(vertex(id), vertex(neighbor.id)).id();
+			    }
+			    outgoing.push_back(outgoingEdge(slot, id));
+		    }
+		    if (outgoing.empty()) {
+			    return;
+		    }
+		    vertex(id).setOutgoing(outgoing[0]);
+		    for (int j = 0; j < outgoing.size(); j++) {
+			    outgoing[j].twin().setNext(outgoing[(j + 1) % outgoing.size()]);
+		    }
+		    if (id == 0) {
+			    outerEdge = outgoing[0].id();
+		    }
+	    });
+
+	traversal.forAllBoundaryElements(
+	    [this](int v, HeightMap::Coordinate, BoundaryStatus status,
+	           std::optional<int> permeableRegion) {
+		    vertex(v).data().boundaryStatus = status;
+		    vertex(v).data().permeableRegion = permeableRegion;
+	    },
+	    [&](int, int, HeightMap::Coordinate c, int direction, BoundaryStatus status,
+	        std::optional<int> permeableRegion) {
+		    HalfEdge e = halfEdge(edgeSlot(c, direction));
+		    e.data().boundaryStatus = status;
+		    e.twin().data().boundaryStatus = status;
+		    e.data().permeableRegion = permeableRegion;
+		    e.twin().data().permeableRegion = permeableRegion;
+	    });
+
+	addFaces();
+
+	// Mark the outer face. Vertex 0 is on the boundary, and its outgoing
+	// half-edges are in counter-clockwise order starting from the outer face
+	// (see InputDcel(const InputGraph&)).
+	assert(vertex(0).data().boundaryStatus != BoundaryStatus::INTERIOR);
+	m_outerFaceId = halfEdge(outerEdge).incidentFace().id();
+}
+
+bool InputDcel::containsNodata() const {
+	for (int i = 0; i < vertexCount(); i++) {
+		if (std::isnan(m_storage.vertexData(i).p.h)) {
+			return true;
 		}
 	}
+	return false;
 }
 
-void InputDcel::computeGradientFlow() {
+void InputDcel::computeGradientFlow(int threadCount) {
+
+	// Each of the passes below reads only data that is not modified in the
+	// same pass, and writes only to elements “owned” by the element it
+	// handles: a vertex owns its outgoing half-edges, a face its boundary
+	// half-edges, and an edge (pair of twin half-edges) the face that it is
+	// paired with. Hence, the elements of one pass can be handled in parallel,
+	// and the result is identical to handling them sequentially.
 
 	// Vertex-edge pairings: pair each vertex with the outgoing half-edge to the
 	// lowest neighbor (if it is lower than the vertex itself).
-	for (int i = 0; i < vertexCount(); i++) {
+	parallelFor(vertexCount(), threadCount, [this](int i) {
 		Vertex v = vertex(i);
 
 		// Don't pair boundary vertices on a permeable region.
 		if (v.data().boundaryStatus == BoundaryStatus::PERMEABLE) {
-			continue;
+			return;
 		}
 
 		InputDcel::HalfEdge pairedEdge;
-		v.forAllOutgoingEdges([&pairedEdge](HalfEdge e) {
+		for (HalfEdge e : v.outgoingEdges()) {
 			if (!pairedEdge.isInitialized() ||
 			    e.destination().data().p < pairedEdge.destination().data().p) {
 				pairedEdge = e;
 			}
-		});
+		}
 		if (pairedEdge.isInitialized() && pairedEdge.destination().data().p < v.data().p) {
 			v.data().pairedWithEdge = pairedEdge.id();
 			pairedEdge.data().pairedWithVertex = true;
 		}
-	}
+	});
 
 	// Find the highest edge and the second-highest edge of each face.
-	for (int i = 0; i < faceCount(); i++) {
+	parallelFor(faceCount(), threadCount, [this](int i) {
 		Face f = face(i);
 
 		// First find the half-edge with the highest origin.
 		InputDcel::HalfEdge highestEdge;
-		f.forAllBoundaryEdges([&highestEdge](HalfEdge e) {
+		for (HalfEdge e : f.boundaryEdges()) {
 			if (!highestEdge.isInitialized() || e.origin().data().p > highestEdge.origin().data().p) {
 				highestEdge = e;
 			}
-		});
+		}
 
 		// Now the highest edge on the face boundary can be either that edge or
 		// its predecessor, and the other one is the second-highest edge on the
@@ -150,19 +272,19 @@ void InputDcel::computeGradientFlow() {
 			highestEdge.data().highestOfFace = true;
 			highestEdge.previous().data().secondHighestOfFace = true;
 		}
-	}
+	});
 
 	auto highestBoundaryVertexNotInEdge = [](Face f, HalfEdge e) -> Vertex {
 		Vertex result;
-		f.forAllBoundaryVertices([&result, &e](Vertex v) {
+		for (Vertex v : f.boundaryVertices()) {
 			if (v == e.origin() || v == e.destination()) {
-				return;
+				continue;
 			}
 			if (!result.isInitialized() ||
 				v.data().p > result.data().p) {
 				result = v;
 			}
-		});
+		}
 		return result;
 	};
 
@@ -171,18 +293,17 @@ void InputDcel::computeGradientFlow() {
 	// choose the lower face to pair the edge with. Here, “lower” means
 	// lexicographically lower, i.e., we check the opposite edge of f and f',
 	// and see which one has the lowest maximum.
-	for (int i = 0; i < halfEdgeCount(); i++) {
-		HalfEdge e = halfEdge(i);
+	auto pairWithFace = [this, &highestBoundaryVertexNotInEdge](HalfEdge e) {
 
 		// Don't pair boundary edges on a permeable region.
 		if (e.data().boundaryStatus == BoundaryStatus::PERMEABLE) {
-			continue;
+			return;
 		}
 		// Do pair boundary edges on an impermeable region, but not to the outer
 		// face.
 		if (e.data().boundaryStatus == BoundaryStatus::IMPERMEABLE &&
 		    e.incidentFace() == outerFace()) {
-			continue;
+			return;
 		}
 
 		if (e.data().highestOfFace) {
@@ -201,23 +322,22 @@ void InputDcel::computeGradientFlow() {
 				assert(!e.twin().data().pairedWithFace);
 			}
 		}
-	}
+	};
 
 	// Secondary edge-face pairings: similar to ordinary edge-face pairings, but
 	// now we allow each edge to pair with an incident face f if it is the
 	// second-highest edge of f.
-	for (int i = 0; i < halfEdgeCount(); i++) {
-		HalfEdge e = halfEdge(i);
+	auto pairWithFaceSecondary = [this, &highestBoundaryVertexNotInEdge](HalfEdge e) {
 
 		// Don't pair boundary edges on a permeable region.
 		if (e.data().boundaryStatus == BoundaryStatus::PERMEABLE) {
-			continue;
+			return;
 		}
 		// Do pair boundary edges on an impermeable region, but not to the outer
 		// face.
 		if (e.data().boundaryStatus == BoundaryStatus::IMPERMEABLE &&
 		    e.incidentFace() == outerFace()) {
-			continue;
+			return;
 		}
 
 		// Explicitly check if this edge hasn't already been paired to something
@@ -227,7 +347,7 @@ void InputDcel::computeGradientFlow() {
 		// double-pairing the edge.)
 		if (e.data().pairedWithVertex || e.data().pairedWithFace ||
 		    e.twin().data().pairedWithVertex || e.twin().data().pairedWithFace) {
-			continue;
+			return;
 		}
 
 		if (e.data().secondHighestOfFace && e.incidentFace().data().pairedWithEdge == -1) {
@@ -243,7 +363,26 @@ void InputDcel::computeGradientFlow() {
 				e.data().pairedWithFace = true;
 			}
 		}
-	}
+	};
+
+	// The pairing of a half-edge reads the pairing of its twin, so we handle
+	// both half-edges of an edge together, the one with the lower ID first (as
+	// a sequential loop over the half-edges would).
+	auto forBothHalfEdges = [this](int i, auto f) {
+		HalfEdge e = halfEdge(i);
+		if (e.twin().id() < i) {
+			return;
+		}
+		f(e);
+		f(e.twin());
+	};
+	parallelFor(halfEdgeCount(), threadCount, [&forBothHalfEdges, &pairWithFace](int i) {
+		forBothHalfEdges(i, pairWithFace);
+	});
+	parallelFor(halfEdgeCount(), threadCount,
+	            [&forBothHalfEdges, &pairWithFaceSecondary](int i) {
+		forBothHalfEdges(i, pairWithFaceSecondary);
+	});
 }
 
 bool InputDcel::isCritical(Vertex vertex) const {
@@ -261,18 +400,27 @@ bool InputDcel::isCritical(Face face) const {
 	return face.data().pairedWithEdge == -1 && face.id() != m_outerFaceId;
 }
 
-InputDcel::Path InputDcel::gradientPath(HalfEdge startingEdge) {
-
-	InputDcel::Path result;
+InputDcel::GradientPath InputDcel::gradientPath(HalfEdge startingEdge) {
+	return GradientPath(this, startingEdge);
+}
 
-	HalfEdge edge = startingEdge;
-	result.addEdge(edge);
+Point InputDcel::position(HalfEdge edge) {
+	Point result = (edge.origin().data().p + edge.destination().data().p) * 0.5;
+	result.h = std::max(edge.origin().data().p.h, edge.destination().data().p.h);
+	return result;
+}
 
-	while (edge.destination().data().pairedWithEdge != -1) {
-		edge = halfEdge(edge.destination().data().pairedWithEdge);
-		result.addEdge(edge);
+Point InputDcel::position(Face face) {
+	Point sum;
+	double max = -std::numeric_limits<double>::infinity();
+	int count = 0;
+	for (Vertex v : face.boundaryVertices()) {
+		sum += v.data().p;
+		max = std::max(max, v.data().p.h);
+		count++;
 	}
-
+	Point result = sum * (1.0 / count);
+	result.h = max;
 	return result;
 }
 
@@ -285,23 +433,93 @@ bool InputDcel::isAscending(HalfEdge edge) {
 }
 
 PiecewiseLinearFunction InputDcel::volumeAbove(InputDcel::Face face) {
-	PiecewiseLinearFunction result;
-	face.forAllBoundaryVertices([&result](InputDcel::Vertex v) {
-		result = result.add(PiecewiseLinearFunction{v.data().p});
+	std::pmr::vector<double> heights;
+	for (InputDcel::Vertex v : face.boundaryVertices()) {
+		heights.push_back(v.data().p.h);
+	}
+	return PiecewiseLinearFunction::sumOfPillars(std::move(heights));
+}
+
+InputDcel::Vertex InputDcel::vertexAt(double x, double y) {
+	int id = vertexIdAt(x, y);
+	if (id == -1) {
+		return {};
+	}
+	return vertex(id);
+}
+
+std::vector<InputDcel::Vertex> InputDcel::verticesAt(const std::vector<Point>& positions,
+                                                     int threadCount) {
+	std::vector<Vertex> result(positions.size());
+	parallelFor(positions.size(), threadCount, [this, &positions, &result](int i) {
+		int id = vertexIdAt(positions[i].x, positions[i].y);
+		if (id != -1) {
+			result[i] = vertex(id);
+		}
 	});
 	return result;
 }
 
-InputDcel::Vertex InputDcel::vertexAt(double x, double y) {
+void InputDcel::buildVertexRaster() {
+	// the raster only works if all vertices are on integer coordinates
+	m_rasterWidth = 0;
+	m_rasterHeight = 0;
 	for (int i = 0; i < vertexCount(); i++) {
-		if (vertex(i).data().p.x == x && vertex(i).data().p.y == y
-		        && vertex(i).data().p.h <
-		                    std::numeric_limits<double>::infinity()) {
-			return vertex(i);
+		const Point& p = m_storage.vertexData(i).p;
+		if (p.x < 0 || p.y < 0 || p.x != std::floor(p.x) || p.y != std::floor(p.y) ||
+		    p.x >= std::numeric_limits<int>::max() || p.y >= std::numeric_limits<int>::max()) {
+			m_rasterWidth = 0;
+			m_rasterHeight = 0;
+			return;
 		}
+		m_rasterWidth = std::max(m_rasterWidth, static_cast<int>(p.x) + 1);
+		m_rasterHeight = std::max(m_rasterHeight, static_cast<int>(p.y) + 1);
 	}
-	return {};
+	if (static_cast<long>(m_rasterWidth) * m_rasterHeight > 4L * vertexCount() + 1024) {
+		// too sparse to be worth it
+		m_rasterWidth = 0;
+		m_rasterHeight = 0;
+		return;
+	}
+
+	// if several vertices share a position, the one with the lowest ID that
+	// is in bounds wins
+	m_vertexRaster.assign(static_cast<long>(m_rasterWidth) * m_rasterHeight, -1);
+	for (int i = 0; i < vertexCount(); i++) {
+		const Point& p = m_storage.vertexData(i).p;
+		int32_t& slot = m_vertexRaster[static_cast<int>(p.y) * m_rasterWidth + static_cast<int>(p.x)];
+		if (slot == -1 && p.h < std::numeric_limits<double>::infinity()) {
+			slot = i;
+		}
+	}
+}
+
+int InputDcel::vertexIdAt(double x, double y) const {
+	if (m_rasterWidth == 0) {
+		// no raster: fall back to scanning all vertices
+		for (int i = 0; i < vertexCount(); i++) {
+			const Point& p = m_storage.vertexData(i).p;
+			if (p.x == x && p.y == y && p.h < std::numeric_limits<double>::infinity()) {
+				return i;
+			}
+		}
+		return -1;
+	}
+
+	// the negated comparisons also reject NaN
+	if (!(x >= 0 && x < m_rasterWidth && y >= 0 && y < m_rasterHeight) ||
+	    x != std::floor(x) || y != std::floor(y)) {
+		return -1;
+	}
+	int index = static_cast<int>(y) * m_rasterWidth + static_cast<int>(x);
+	// without a raster, the vertices form a full grid in row-major order
+	int id = m_vertexRaster.empty() ? index : m_vertexRaster[index];
+	if (id == -1 || !(m_storage.vertexData(id).p.h < std::numeric_limits<double>::infinity())) {
+		return -1;
+	}
+	return id;
 }
+
 void InputDcel::pair(Vertex v, HalfEdge e) {
 	assert(e.origin() == v);
 	assert(v.data().pairedWithEdge == -1 || v.data().pairedWithEdge == e.id());
@@ -345,22 +563,22 @@ void InputDcel::unpair(HalfEdge e, Face f) {
 bool InputDcel::isBlueLeaf(Vertex v) const {
 	assert(v.isInitialized());
 	int count = 0;
-	v.forAllOutgoingEdges([&count](HalfEdge e) {
+	for (HalfEdge e : v.outgoingEdges()) {
 		if (e.data().pairedWithVertex || e.twin().data().pairedWithVertex) {
 			count++;
 		}
-	});
+	}
 	return count == 1;
 }
 
 bool InputDcel::isRedLeaf(Face f) const {
 	assert(f.isInitialized());
 	int count = 0;
-	f.forAllBoundaryEdges([&count](HalfEdge e) {
+	for (HalfEdge e : f.boundaryEdges()) {
 		if (e.data().pairedWithFace || e.twin().data().pairedWithFace) {
 			count++;
 		}
-	});
+	}
 	return count == 1;
 }
 
@@ -1,10 +1,17 @@
 #ifndef INPUTDCEL_H
 #define INPUTDCEL_H
 
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
 #include <optional>
+#include <vector>
 
+#include "boundary.h"
 #include "boundarystatus.h"
 #include "dcel.h"
+#include "griddcelstorage.h"
+#include "heightmap.h"
 #include "inputgraph.h"
 #include "point.h"
 #include "piecewiselinearfunction.h"
@@ -57,11 +64,6 @@ class InputDcelHalfEdge {
 
 	public:
 
-		/**
-		 * A point in the center of this edge.
-		 */
-		Point p;
-
 		/**
 		 * Whether this half-edge is the highest half-edge (lexicographically)
 		 * of its incident face.
@@ -93,12 +95,6 @@ class InputDcelHalfEdge {
 		 */
 		mutable int msVertex = -1;
 
-		/**
-		 * The volume of the part of the red tree that arises when we cut the
-		 * red tree at this half-edge. Set by the \ref FingerFinder.
-		 */
-		PiecewiseLinearFunction volumeAbove;
-
 		/// Whether this edge is on the boundary. This value is identical for
 		/// both twin half-edges.
 		BoundaryStatus boundaryStatus = BoundaryStatus::INTERIOR;
@@ -115,11 +111,6 @@ class InputDcelFace {
 
 	public:
 
-		/**
-		 * A point in the center of this face.
-		 */
-		Point p;
-
 		/**
 		 * Boundary half-edge this face is gradient-paired with, if any.
 		 */
@@ -137,32 +128,214 @@ class InputDcelFace {
 		 * changed.
 		 */
 		mutable int msFace = -1;
+};
 
-		/**
-		 * The ID of the half edge that forms the top edge of this face. Only
-		 * defined for leaves in the red tree. Set by the \ref FingerFinder.
-		 */
-		int topEdge = -1;
-
-#ifdef EXPERIMENTAL_FINGERS_SUPPORT
-		/// Holds face IDs
-		std::vector<int> pathToTopEdge;
-		std::vector<int> spurFaces;
-		/// Holds vertex IDs
-		std::vector<int> spurBoundary;
-
-		double flankingHeight;
-		bool isSignificant = false;
+/**
+ * The storage policy of the InputDcel.
+ *
+ * This is GridDcelStorage, unless `INPUT_DCEL_AOS_STORAGE` or
+ * `INPUT_DCEL_SOA_STORAGE` is defined, in which case DcelAosStorage or
+ * DcelSoaStorage is used, respectively. These alternatives exist only to
+ * compare the storage policies in the benchmarks.
+ */
+#if defined(INPUT_DCEL_AOS_STORAGE)
+template<typename VertexData, typename HalfEdgeData, typename FaceData>
+using InputDcelStorage = DcelAosStorage<VertexData, HalfEdgeData, FaceData>;
+#elif defined(INPUT_DCEL_SOA_STORAGE)
+template<typename VertexData, typename HalfEdgeData, typename FaceData>
+using InputDcelStorage = DcelSoaStorage<VertexData, HalfEdgeData, FaceData>;
+#else
+template<typename VertexData, typename HalfEdgeData, typename FaceData>
+using InputDcelStorage = GridDcelStorage<VertexData, HalfEdgeData, FaceData>;
 #endif
-};
 
 /**
  * A DCEL that we generated from the InputGraph.
+ *
+ * If the DCEL covers an entire rectangular heightmap, its topology is not
+ * stored explicitly but computed from the element IDs; see GridDcelStorage.
  */
-class InputDcel : public Dcel<InputDcelVertex, InputDcelHalfEdge, InputDcelFace> {
+class InputDcel : public Dcel<InputDcelVertex, InputDcelHalfEdge, InputDcelFace,
+                              InputDcelStorage> {
 
 	public:
 
+		/**
+		 * A gradient-descent path, as computed by gradientPath().
+		 *
+		 * Such a path is fully determined by its first half-edge and the
+		 * vertex-edge gradient pairs of the DCEL, so instead of storing all
+		 * of its half-edges, this class stores only the first one (and the
+		 * length of the path). The other half-edges are found on the fly when
+		 * iterating over the path.
+		 *
+		 * \note Because of this, the gradient pairs of the DCEL should not
+		 * change while a GradientPath is in use.
+		 */
+		class GradientPath {
+
+			public:
+
+				/**
+				 * Forward iterator over the half-edges of a GradientPath.
+				 */
+				class Iterator {
+
+					public:
+						using iterator_category = std::forward_iterator_tag;
+						using value_type = HalfEdge;
+						using difference_type = std::ptrdiff_t;
+						using pointer = void;
+						using reference = HalfEdge;
+
+						Iterator() = default;
+						Iterator(InputDcel* dcel, int edge) :
+						    m_dcel(dcel), m_edge(edge) {
+						}
+
+						HalfEdge operator*() const {
+							return m_dcel->halfEdge(m_edge);
+						}
+
+						Iterator& operator++() {
+							m_edge = m_dcel->halfEdge(m_edge).destination()
+							             .data().pairedWithEdge;
+							return *this;
+						}
+
+						Iterator operator++(int) {
+							Iterator result = *this;
+							++*this;
+							return result;
+						}
+
+						bool operator==(const Iterator& other) const {
+							return m_edge == other.m_edge;
+						}
+
+						bool operator!=(const Iterator& other) const {
+							return !(*this == other);
+						}
+
+					private:
+						InputDcel* m_dcel = nullptr;
+						/// The current half-edge, or `-1` at the end.
+						int m_edge = -1;
+				};
+
+				/**
+				 * Constructs an empty path.
+				 */
+				GradientPath() = default;
+
+				/**
+				 * Constructs the gradient-descent path starting with the given
+				 * half-edge.
+				 *
+				 * \param dcel The DCEL.
+				 * \param startingEdge The first half-edge of the path.
+				 */
+				GradientPath(InputDcel* dcel, HalfEdge startingEdge) :
+				    m_dcel(dcel), m_start(startingEdge.id()) {
+					for ([[maybe_unused]] HalfEdge e : *this) {
+						m_length++;
+					}
+				}
+
+				/// Returns whether this path is empty.
+				bool empty() const {
+					return m_start == -1;
+				}
+
+				/// Returns the number of half-edges in this path.
+				int length() const {
+					return m_length;
+				}
+
+				/// Returns the first half-edge of this path. If this path is
+				/// empty, returns an uninitialized half-edge.
+				HalfEdge firstEdge() const {
+					if (empty()) {
+						return HalfEdge();
+					}
+					return m_dcel->halfEdge(m_start);
+				}
+
+				/// Returns the first vertex of this path. If this path is
+				/// empty, returns an uninitialized vertex.
+				Vertex origin() const {
+					if (empty()) {
+						return Vertex();
+					}
+					return firstEdge().origin();
+				}
+
+				/// Returns the last vertex of this path. If this path is
+				/// empty, returns an uninitialized vertex.
+				///
+				/// \note This takes time linear in the length of the path.
+				Vertex destination() const {
+					Vertex result;
+					for (HalfEdge e : *this) {
+						result = e.destination();
+					}
+					return result;
+				}
+
+				Iterator begin() const {
+					return empty() ? end() : Iterator(m_dcel, m_start);
+				}
+
+				Iterator end() const {
+					return Iterator(m_dcel, -1);
+				}
+
+				/**
+				 * Performs an action for all vertices on this path, in order
+				 * from the beginning to the end of the path.
+				 *
+				 * \param f A function to call for every vertex.
+				 */
+				template<typename F>
+				void forAllVertices(F f) const {
+					if (empty()) {
+						return;
+					}
+					f(origin());
+					for (HalfEdge e : *this) {
+						f(e.destination());
+					}
+				}
+
+				/**
+				 * Returns this path as a Path, which stores all half-edges
+				 * explicitly.
+				 */
+				Path toPath() const {
+					Path result;
+					for (HalfEdge e : *this) {
+						result.addEdge(e);
+					}
+					return result;
+				}
+
+				/**
+				 * Returns the reversed variant of this path.
+				 * \return The reversed path.
+				 */
+				Path reversed() const {
+					return toPath().reversed();
+				}
+
+			private:
+				/// The DCEL this path lives in.
+				InputDcel* m_dcel = nullptr;
+				/// The ID of the first half-edge of this path.
+				int m_start = -1;
+				/// The number of half-edges in this path.
+				int m_length = 0;
+		};
+
 		/**
 		 * Creates an empty InputDcel.
 		 */
@@ -181,14 +354,42 @@ class InputDcel : public Dcel<InputDcelVertex, InputDcelHalfEdge, InputDcelFace>
 		InputDcel(const InputGraph& g);
 
 		/**
-		 * Sets the center coordinates for all edges and faces.
+		 * Creates a InputDcel directly from the part of the given heightmap
+		 * that is within the given boundary.
+		 *
+		 * This results in the same DCEL as `InputDcel(InputGraph(heightMap,
+		 * boundary))`, but avoids materializing the intermediate InputGraph.
+		 *
+		 * If the (rasterized) boundary runs along the border of the
+		 * heightmap, the DCEL is a complete grid, and it is stored implicitly
+		 * (see GridDcelStorage). In that case the vertex with coordinate
+		 * (x, y) has ID `y * width + x`, and the half-edge and face IDs are
+		 * as described in GridDcelStorage. Otherwise, the vertex, half-edge
+		 * and face IDs are the same as those of `InputDcel(InputGraph(
+		 * heightMap, boundary))`.
+		 *
+		 * \note The heightmap needs to have height at least 2; otherwise
+		 * behavior is undefined.
+		 *
+		 * \param heightMap The heightmap.
+		 * \param boundary The boundary. Everything inside this boundary is
+		 * included in the DCEL.
+		 */
+		InputDcel(const HeightMap& heightMap, const Boundary& boundary);
+
+		/**
+		 * Checks if the terrain contains nodata values.
 		 */
-		void setEdgeAndFaceCoordinates();
+		bool containsNodata() const;
 
 		/**
 		 * Computes vertex-edge and edge-face gradient pairs.
+		 *
+		 * The result does not depend on the number of threads used.
+		 *
+		 * \param threadCount The number of threads to use.
 		 */
-		void computeGradientFlow();
+		void computeGradientFlow(int threadCount = 1);
 
 		/**
 		 * Checks if this vertex is critical (i.e., if it is a minimum).
@@ -212,7 +413,27 @@ class InputDcel : public Dcel<InputDcelVertex, InputDcelHalfEdge, InputDcelFace>
 		 * in the direction of the gradient path to trace.
 		 * \return The path (starting with `startingEdge`).
 		 */
-		InputDcel::Path gradientPath(HalfEdge startingEdge);
+		GradientPath gradientPath(HalfEdge startingEdge);
+
+		/**
+		 * Returns a point in the center of the given half-edge. Its height is
+		 * the height of the highest endpoint of the half-edge.
+		 *
+		 * \param edge The half-edge.
+		 * \return The center point.
+		 */
+		static Point position(HalfEdge edge);
+
+		/**
+		 * Returns a point in the center of the given face. Its height is the
+		 * height of the highest boundary vertex of the face.
+		 *
+		 * \note The result is meaningless for the outer face.
+		 *
+		 * \param face The face.
+		 * \return The center point.
+		 */
+		static Point position(Face face);
 
 		/**
 		 * Checks whether the given half-edge is descending, that is, whether
@@ -248,6 +469,10 @@ class InputDcel : public Dcel<InputDcelVertex, InputDcelHalfEdge, InputDcelFace>
 		/**
 		 * Returns the vertex at the given position.
 		 *
+		 * This takes constant time if the vertices lie on integer
+		 * coordinates, which is always the case for DCELs created from a
+		 * heightmap.
+		 *
 		 * \param x The x-coordinate.
 		 * \param y The y-coordinate.
 		 * \return The vertex at that position, or an uninitialized vertex if
@@ -255,6 +480,19 @@ class InputDcel : public Dcel<InputDcelVertex, InputDcelHalfEdge, InputDcelFace>
 		 */
 		Vertex vertexAt(double x, double y);
 
+		/**
+		 * Returns the vertices at the given positions, like vertexAt(), for
+		 * many positions at once.
+		 *
+		 * \param positions The positions to look up. Their heights are
+		 * ignored.
+		 * \param threadCount The number of threads to use.
+		 * \return For each position, the vertex at that position, or an
+		 * uninitialized vertex if the position is out of bounds.
+		 */
+		std::vector<Vertex> verticesAt(const std::vector<Point>& positions,
+		                               int threadCount = 1);
+
 		void pair(Vertex v, HalfEdge e);
 		void pair(HalfEdge e, Face f);
 
@@ -268,7 +506,25 @@ class InputDcel : public Dcel<InputDcelVertex, InputDcelHalfEdge, InputDcelFace>
 		Face outerFace();
 
 	private:
+		/// Fills m_vertexRaster from the vertex positions, if they are all on
+		/// integer coordinates.
+		void buildVertexRaster();
+		/// Returns the ID of the vertex at the given position, or -1 if
+		/// there is none.
+		int vertexIdAt(double x, double y) const;
+
 		int m_outerFaceId;
+
+		/// The size of the raster of vertex positions, or 0 × 0 if the
+		/// vertices do not lie on integer coordinates (in that case
+		/// vertexIdAt() scans all vertices).
+		int m_rasterWidth = 0;
+		int m_rasterHeight = 0;
+		/// For each position in the raster (in row-major order), the ID of
+		/// the vertex at that position, or -1 if there is none. If this is
+		/// empty but the raster size is not, the vertices form a full grid,
+		/// and the ID of a vertex is its position in the raster.
+		std::vector<int32_t> m_vertexRaster;
 };
 
 #endif // INPUTDCEL_H
@@ -1,47 +1,71 @@
 #include <algorithm>
 #include <cassert>
 #include <cmath>
-#include <queue>
 
 #include "inputgraph.h"
 #include "boundarystatus.h"
+#include "gridtraversal.h"
 
-InputGraph::Vertex::Vertex(int id) : id(id) {}
+InputGraph::AdjacencyList::AdjacencyList(const InputGraph* graph, int from) :
+    m_graph(graph), m_from(from) {}
 
-std::optional<int> InputGraph::Vertex::findAdjacencyTo(int to) const {
-	auto it = std::find(adj.begin(), adj.end(), InputGraph::Adjacency{id, to});
-	if (it == adj.end()) {
-		return std::nullopt;
-	} else {
-		return std::distance(adj.begin(), it);
+int InputGraph::AdjacencyList::size() const {
+	return m_graph->m_adjacencyOffsets[m_from + 1] - m_graph->m_adjacencyOffsets[m_from];
+}
+
+InputGraph::Adjacency InputGraph::AdjacencyList::operator[](int i) const {
+	int index = indexOf(i);
+	Adjacency a(m_from, m_graph->m_adjacencyTargets[index]);
+	if (m_graph->m_adjacencyOnBoundary[index]) {
+		if (m_graph->m_adjacencyPermeable[index]) {
+			a.boundaryStatus = BoundaryStatus::PERMEABLE;
+			a.permeableRegion = permeableRegionOf(index, m_graph->m_adjacencyPermeable,
+			                                      m_graph->m_adjacencyPermeableRegion);
+		} else {
+			a.boundaryStatus = BoundaryStatus::IMPERMEABLE;
+		}
 	}
+	return a;
 }
 
-void InputGraph::Vertex::addAdjacencyAfter(int to) {
-	adj.emplace_back(id, to);
+int InputGraph::AdjacencyList::to(int i) const {
+	return m_graph->m_adjacencyTargets[indexOf(i)];
 }
 
-void InputGraph::Vertex::addAdjacencyBefore(int to) {
-	adj.insert(adj.begin(), Adjacency{id, to});
+int InputGraph::AdjacencyList::indexOf(int i) const {
+	assert(i >= 0 && i < size());
+	return m_graph->m_adjacencyOffsets[m_from] + i;
 }
 
-static constexpr int directionDx[] = {1, 0, -1, 0};
-static constexpr int directionDy[] = {0, -1, 0, 1};
+InputGraph::Vertex::Vertex(const InputGraph* graph, int id) :
+    id(id), adj(graph, id), p(graph->m_points[id]),
+    boundaryStatus(graph->m_vertexPermeable[id] ? BoundaryStatus::PERMEABLE
+                                                : BoundaryStatus::IMPERMEABLE),
+    permeableRegion(permeableRegionOf(id, graph->m_vertexPermeable,
+                                      graph->m_vertexPermeableRegion)) {}
 
-/// Returns the coordinate obtained by going one step in the given
-/// direction from the starting coordinate `c`.
-HeightMap::Coordinate applyDirection(HeightMap::Coordinate c, int direction) {
-	return {c.m_x + directionDx[direction], c.m_y + directionDy[direction]};
+InputGraph::Vertex::Vertex(InputGraph* graph, int id) :
+    Vertex(static_cast<const InputGraph*>(graph), id) {
+	m_graph = graph;
 }
 
-/// Returns the direction between the two given coordinates.
-int directionBetween(HeightMap::Coordinate c1, HeightMap::Coordinate c2) {
-	for (int i = 0; i < 4; i++) {
-		if (c2.m_x == c1.m_x + directionDx[i] && c2.m_y == c1.m_y + directionDy[i]) {
+std::optional<int> InputGraph::Vertex::findAdjacencyTo(int to) const {
+	for (int i = 0; i < adj.size(); i++) {
+		if (adj.to(i) == to) {
 			return i;
 		}
 	}
-	return -1;
+	return std::nullopt;
+}
+
+void InputGraph::Vertex::addAdjacencyAfter(int to) {
+	assert(m_graph != nullptr);
+	m_graph->insertAdjacency(id, adj.size(), to);
+}
+
+void InputGraph::Vertex::addAdjacencyBefore(int to) {
+	assert(m_graph != nullptr);
+	m_graph->insertAdjacency(id, 0, to);
 }
 
 InputGraph::InputGraph() {}
@@ -50,108 +74,36 @@ InputGraph::InputGraph(const HeightMap& heightMap) :
     InputGraph(heightMap, Boundary(heightMap)) {}
 
 InputGraph::InputGraph(const HeightMap& heightMap, Boundary boundary) {
-	boundary = boundary.rasterize();
-	m_vertexMap =
-	    std::vector<std::vector<int>>(heightMap.width(), std::vector<int>(heightMap.height(), -1));
-
-	// Preparation: keep track of which vertices are on the boundary, and in
-	// which directions its two boundary edges go.
-	std::vector<std::vector<bool>> vertexOnBoundary(heightMap.width(),
-	                                                std::vector<bool>(heightMap.height(), false));
-	std::vector<std::vector<int>> incomingBoundaryEdge(heightMap.width(),
-	                                                   std::vector<int>(heightMap.height(), -1));
-	std::vector<std::vector<int>> outgoingBoundaryEdge(heightMap.width(),
-	                                                   std::vector<int>(heightMap.height(), -1));
-	for (int i = 0; i < boundary.path().m_points.size() - 1; i++) {
-		HeightMap::Coordinate p1 = boundary.path().m_points[i];
-		HeightMap::Coordinate p2 = boundary.path().m_points[i + 1];
-		vertexOnBoundary[p1.m_x][p1.m_y] = true;
-		incomingBoundaryEdge[p2.m_x][p2.m_y] = directionBetween(p2, p1);
-		outgoingBoundaryEdge[p1.m_x][p1.m_y] = directionBetween(p1, p2);
-	}
-
-	// Do a BFS through the area between the boundary edges to find all vertices
-	// and edges that lie on the boundary or inside it.
-	std::vector<std::vector<bool>> visited(
-	        heightMap.width(), std::vector<bool>(heightMap.height(), false));
-	std::queue<HeightMap::Coordinate> queue;
-	HeightMap::Coordinate start = boundary.path().start();
-	queue.push(boundary.path().start());
-
-	// Insert the first vertex.
-	m_vertexMap[start.m_x][start.m_y] =
-	    addVertex(Point{static_cast<double>(start.m_x), static_cast<double>(start.m_y),
-	                    heightMap.elevationAt(start.m_x, start.m_y)});
-
-	while (!queue.empty()) {
-		HeightMap::Coordinate coordinate = queue.front();
-		queue.pop();
-		if (visited[coordinate.m_x][coordinate.m_y]) {
-			continue;
-		}
-		visited[coordinate.m_x][coordinate.m_y] = true;
-		int vertexId = m_vertexMap[coordinate.m_x][coordinate.m_y];
-		assert(vertexId != -1);
-
-		// If the source vertex is on the inside, we don't care in which order
-		// we consider its incident edges. However, if the source vertex is on
-		// the boundary, we want to consider its incident edges starting from
-		// the incident (incoming) boundary edge b.
-		int startDirection = 0;
-		if (vertexOnBoundary[coordinate.m_x][coordinate.m_y]) {
-			startDirection = incomingBoundaryEdge[coordinate.m_x][coordinate.m_y];
-		}
-
-		// Now consider the incident edges, starting from the start edge we just
-		// determined.
-		for (int i = 0; i < 4; i++) {
-			int direction = (i + startDirection) % 4;
-
-			// Ignore edges that go out of bounds.
-			HeightMap::Coordinate target = applyDirection(coordinate, direction);
-			if (!heightMap.isInBounds(target)) {
-				continue;
-			}
-
-			// Add the edge to the graph (adding the destination vertex if it
-			// doesn't exist yet).
-			if (m_vertexMap[target.m_x][target.m_y] == -1) {
-				m_vertexMap[target.m_x][target.m_y] = addVertex(Point{
-					static_cast<double>(target.m_x), static_cast<double>(target.m_y),
-					heightMap.elevationAt(target.m_x, target.m_y)});
-			}
-			(*this)[vertexId].addAdjacencyAfter(m_vertexMap[target.m_x][target.m_y]);
-
-			// Add the target vertex to the queue.
-			queue.push(target);
-
-			// If the edge we just added was the incoming boundary edge, then
-			// this was the last edge on the inside, hence we should stop.
-			if (incomingBoundaryEdge[target.m_x][target.m_y] == (direction + 2) % 4) {
-				break;
-			}
-		}
-	}
-
-	// Mark adjacencies on the boundary as being on an impermeable or a
-	// permeable section of said boundary.
-	for (int i = 0; i < boundary.path().length(); i++) {
-		HeightMap::Coordinate c1 = boundary.path().m_points[i];
-		HeightMap::Coordinate c2 = boundary.path().m_points[(i + 1) % boundary.path().length()];
-		markVertex(c1, BoundaryStatus::IMPERMEABLE);
-		markVertex(c2, BoundaryStatus::IMPERMEABLE);
-		markEdge(c1, c2, BoundaryStatus::IMPERMEABLE);
-	}
-	for (int regionId = 0; regionId < boundary.permeableRegions().size(); regionId++) {
-		const Boundary::Region& region  = boundary.permeableRegions()[regionId];
-		for (int i = region.m_start; i != region.m_end; i = (i + 1) % boundary.path().length()) {
-			HeightMap::Coordinate c1 = boundary.path().m_points[i];
-			HeightMap::Coordinate c2 = boundary.path().m_points[(i + 1) % boundary.path().length()];
-			markVertex(c1, BoundaryStatus::PERMEABLE, i);
-			markVertex(c2, BoundaryStatus::PERMEABLE, i);
-			markEdge(c1, c2, BoundaryStatus::PERMEABLE, i);
-		}
-	}
+	// The traversal visits vertices in order of their IDs, so we can append the
+	// adjacency list of each vertex to the flat adjacency array directly when
+	// visiting it.
+	GridTraversal traversal(heightMap, boundary);
+	traversal.run(
+	    [this, &heightMap](int, HeightMap::Coordinate c) {
+		    addVertex(Point{static_cast<double>(c.m_x), static_cast<double>(c.m_y),
+		                    heightMap.elevationAt(c)});
+	    },
+	    [this]([[maybe_unused]] int id, HeightMap::Coordinate,
+	           const std::vector<GridTraversal::Neighbor>& neighbors) {
+		    assert(id == static_cast<int>(m_adjacencyOffsets.size()) - 1);
+		    for (const GridTraversal::Neighbor& neighbor : neighbors) {
+			    m_adjacencyTargets.push_back(neighbor.id);
+		    }
+		    m_adjacencyOffsets.push_back(m_adjacencyTargets.size());
+	    });
+	assert(m_adjacencyOffsets.size() == m_points.size() + 1);
+	m_adjacencyOnBoundary.resize(m_adjacencyTargets.size(), false);
+	m_adjacencyPermeable.resize(m_adjacencyTargets.size(), false);
+
+	traversal.forAllBoundaryElements(
+	    [this](int v, HeightMap::Coordinate, BoundaryStatus status,
+	           std::optional<int> permeableRegion) {
+		    markVertex(v, status, permeableRegion);
+	    },
+	    [this](int v, int v2, HeightMap::Coordinate, int, BoundaryStatus status,
+	           std::optional<int> permeableRegion) {
+		    markEdge(v, v2, status, permeableRegion);
+	    });
 }
 
 std::vector<HeightMap::Coordinate> neighborsOf(HeightMap::Coordinate v) {
@@ -167,65 +119,104 @@ std::vector<HeightMap::Coordinate> neighborsOf(HeightMap::Coordinate v) {
 	return result;
 }
 
-void InputGraph::markVertex(HeightMap::Coordinate c, BoundaryStatus status,
-                            std::optional<int> permeableRegion) {
-	int v = m_vertexMap[c.m_x][c.m_y];
-	(*this)[v].boundaryStatus = status;
-	(*this)[v].permeableRegion = permeableRegion;
+void InputGraph::insertAdjacency(int from, int i, int to) {
+	int index = m_adjacencyOffsets[from] + i;
+	m_adjacencyTargets.insert(m_adjacencyTargets.begin() + index, to);
+	m_adjacencyOnBoundary.insert(m_adjacencyOnBoundary.begin() + index, false);
+	m_adjacencyPermeable.insert(m_adjacencyPermeable.begin() + index, false);
+	for (int v = from + 1; v < m_adjacencyOffsets.size(); v++) {
+		m_adjacencyOffsets[v]++;
+	}
+
+	// Shift the permeable region indices of the adjacencies after the new one.
+	if (!m_adjacencyPermeableRegion.empty()) {
+		std::unordered_map<int, int> shifted;
+		for (const auto& [a, region] : m_adjacencyPermeableRegion) {
+			shifted[a >= index ? a + 1 : a] = region;
+		}
+		m_adjacencyPermeableRegion = std::move(shifted);
+	}
 }
 
-void InputGraph::markEdge(HeightMap::Coordinate c1, HeightMap::Coordinate c2, BoundaryStatus status,
-              std::optional<int> permeableRegion) {
-	int v = m_vertexMap[c1.m_x][c1.m_y];
-	int v2 = m_vertexMap[c2.m_x][c2.m_y];
+std::optional<int> InputGraph::permeableRegionOf(
+        int i, const std::vector<bool>& permeable,
+        const std::unordered_map<int, int>& permeableRegions) {
+	if (!permeable[i]) {
+		return std::nullopt;
+	}
+	auto it = permeableRegions.find(i);
+	if (it == permeableRegions.end()) {
+		return std::nullopt;
+	}
+	return it->second;
+}
 
-	std::optional<int> adjIndex = (*this)[v].findAdjacencyTo(v2);
-	assert(adjIndex.has_value());
-	(*this)[v].adj[*adjIndex].boundaryStatus = status;
-	(*this)[v].adj[*adjIndex].permeableRegion = permeableRegion;
+void InputGraph::markVertex(int v, BoundaryStatus status, std::optional<int> permeableRegion) {
+	assert(status != BoundaryStatus::INTERIOR);
+	m_vertexPermeable[v] = status == BoundaryStatus::PERMEABLE;
+	if (permeableRegion.has_value()) {
+		m_vertexPermeableRegion[v] = *permeableRegion;
+	} else {
+		m_vertexPermeableRegion.erase(v);
+	}
+}
 
-	adjIndex = (*this)[v2].findAdjacencyTo(v);
-	assert(adjIndex.has_value());
-	(*this)[v2].adj[*adjIndex].boundaryStatus = status;
-	(*this)[v2].adj[*adjIndex].permeableRegion = permeableRegion;
+void InputGraph::markEdge(int v, int v2, BoundaryStatus status,
+                          std::optional<int> permeableRegion) {
+	for (auto [from, to] : {std::pair{v, v2}, std::pair{v2, v}}) {
+		std::optional<int> adjIndex = (*this)[from].findAdjacencyTo(to);
+		assert(adjIndex.has_value());
+		int index = m_adjacencyOffsets[from] + *adjIndex;
+		m_adjacencyOnBoundary[index] = status != BoundaryStatus::INTERIOR;
+		m_adjacencyPermeable[index] = status == BoundaryStatus::PERMEABLE;
+		if (permeableRegion.has_value()) {
+			m_adjacencyPermeableRegion[index] = *permeableRegion;
+		} else {
+			m_adjacencyPermeableRegion.erase(index);
+		}
+	}
 }
 
-InputGraph::Vertex& InputGraph::operator[](int i) {
-	return m_verts[i];
+InputGraph::Vertex InputGraph::operator[](int i) {
+	return Vertex(this, i);
 }
 
-const InputGraph::Vertex& InputGraph::operator[](int i) const {
-	return m_verts[i];
+const InputGraph::Vertex InputGraph::operator[](int i) const {
+	return Vertex(this, i);
 }
 
 int InputGraph::vertexCount() const {
-	return m_verts.size();
+	return m_points.size();
 }
 
 int InputGraph::addVertex() {
-	Vertex v(m_verts.size());
-	m_verts.push_back(v);
-	return m_verts.size() - 1;
+	int index = addVertex(Point());
+	m_adjacencyOffsets.push_back(m_adjacencyTargets.size());
+	return index;
 }
 
 int InputGraph::addVertex(Point p) {
-	int index = addVertex();
-	(*this)[index].p = p;
-	return index;
+	// Note: this does not extend m_adjacencyOffsets, as the constructor fills
+	// in the adjacency lists of the vertices after creating them.
+	m_points.push_back(p);
+	m_vertexPermeable.push_back(false);
+	return m_points.size() - 1;
 }
 
 int InputGraph::edgeCount() const {
-	int count = 0;
-	for (int i = 0; i < m_verts.size(); i++) {
-		count += m_verts[i].adj.size();
-	}
-	return count / 2;
+	return adjacencyCount() / 2;
+}
+
+int InputGraph::adjacencyCount() const {
+	return m_adjacencyTargets.size();
 }
 
 void InputGraph::clearAllEdges() {
-	for (auto v : m_verts) {
-		v.adj.clear();
-	}
+	std::fill(m_adjacencyOffsets.begin(), m_adjacencyOffsets.end(), 0);
+	m_adjacencyTargets.clear();
+	m_adjacencyOnBoundary.clear();
+	m_adjacencyPermeable.clear();
+	m_adjacencyPermeableRegion.clear();
 }
 
 bool InputGraph::isAscending(const InputGraph::Adjacency& a) const {
@@ -233,8 +224,8 @@ bool InputGraph::isAscending(const InputGraph::Adjacency& a) const {
 }
 
 bool InputGraph::containsNodata() const {
-	for (auto v : m_verts) {
-		if (std::isnan(v.p.h)) {
+	for (const Point& p : m_points) {
+		if (std::isnan(p.h)) {
 			return true;
 		}
 	}
@@ -1,6 +1,8 @@
 #ifndef GRAPH_H
 #define GRAPH_H
 
+#include <optional>
+#include <unordered_map>
 #include <vector>
 
 #include "boundary.h"
@@ -51,71 +53,128 @@ class InputGraph {
 		};
 
 		/**
-		 * A vertex in a graph.
+		 * The adjacency list of a vertex.
+		 *
+		 * This is a lightweight view into the flat adjacency arrays of the
+		 * graph; the adjacencies are materialized when accessed.
 		 */
-		struct Vertex {
-
-			/**
-			 * Creates a new vertex with the given ID.
-			 *
-			 * \param id The ID. Should be equal to the position in the vertices
-			 * list of the graph.
-			 */
-			explicit Vertex(int id);
-
-			/**
-			 * The adjacent vertices.
-			 *
-			 * The adjacencies are put in this list in counter-clockwise order
-			 * (if we assume that the y-coordinate increases in downwards
-			 * direction).
-			 */
-			std::vector<Adjacency> adj;
-
-			/**
-			 * The ID of this vertex.
-			 */
-			int id;
-
-			/**
-			 * The position (x and y-coordinate and height value) of this
-			 * vertex.
-			 */
-			Point p;
-
-			/// Whether this vertex is on the boundary.
-			BoundaryStatus boundaryStatus = BoundaryStatus::IMPERMEABLE;
-
-			/// When `boundaryStatus == BoundaryStatus::PERMEABLE`, this stores the
-			/// index of that permeable region.
-			std::optional<int> permeableRegion;
-
-			/// Finds the index of the adjacency to the given vertex, if it
-			/// exists.
-			std::optional<int> findAdjacencyTo(int to) const;
-
-			/**
-			 * Adds an adjacency to the back of the adjacency list of this
-			 * vertex.
-			 *
-			 * The following calls are equivalent:
-			 *
-			 * ```
-			 * v.addAdjacency(to);
-			 * v.adj.push_back(Adjacency(v._id, to));
-			 * ```
-			 *
-			 * \param to The destination vertex.
-			 */
-			void addAdjacencyAfter(int to);
+		class AdjacencyList {
+
+			public:
+				/**
+				 * Creates the adjacency list of the given vertex.
+				 *
+				 * \param graph The graph the vertex is part of.
+				 * \param from The ID of the vertex.
+				 */
+				AdjacencyList(const InputGraph* graph, int from);
+
+				/// Returns the number of adjacencies in this list.
+				int size() const;
+
+				/// Returns the `i`th adjacency in this list.
+				Adjacency operator[](int i) const;
+
+				/// Returns the destination vertex of the `i`th adjacency in
+				/// this list. This is equivalent to, but cheaper than,
+				/// `(*this)[i].to`.
+				int to(int i) const;
+
+				/// Returns the index of the `i`th adjacency in this list in the
+				/// flat adjacency array of the graph; see \ref adjacencyCount().
+				int indexOf(int i) const;
+
+			private:
+				/// The graph we are a view into.
+				const InputGraph* m_graph;
+				/// The ID of the origin vertex.
+				int m_from;
+		};
 
-			/**
-			 * Adds an adjacency to the front of the adjacency list of this
-			 * vertex.
-			 *
-			 * \param to The destination vertex.
-			 */
-			void addAdjacencyBefore(int to);
+		/**
+		 * A vertex in a graph.
+		 *
+		 * This is a handle that refers to the flat vertex and adjacency arrays
+		 * of the graph. Like a reference, it is invalidated when vertices are
+		 * added to the graph.
+		 */
+		class Vertex {
+
+			public:
+				/**
+				 * Creates a read-only handle to the vertex with the given ID.
+				 *
+				 * \param graph The graph the vertex is part of.
+				 * \param id The ID.
+				 */
+				Vertex(const InputGraph* graph, int id);
+
+				/**
+				 * Creates a handle to the vertex with the given ID, which
+				 * allows adding adjacencies to the vertex.
+				 *
+				 * \param graph The graph the vertex is part of.
+				 * \param id The ID.
+				 */
+				Vertex(InputGraph* graph, int id);
+
+				/**
+				 * The ID of this vertex.
+				 */
+				int id;
+
+				/**
+				 * The adjacent vertices.
+				 *
+				 * The adjacencies are put in this list in counter-clockwise
+				 * order (if we assume that the y-coordinate increases in
+				 * downwards direction).
+				 */
+				AdjacencyList adj;
+
+				/**
+				 * The position (x and y-coordinate and height value) of this
+				 * vertex.
+				 */
+				const Point& p;
+
+				/// Whether this vertex is on the boundary.
+				BoundaryStatus boundaryStatus;
+
+				/// When `boundaryStatus == BoundaryStatus::PERMEABLE`, this stores
+				/// the index of that permeable region.
+				std::optional<int> permeableRegion;
+
+				/// Finds the index of the adjacency to the given vertex, if it
+				/// exists.
+				std::optional<int> findAdjacencyTo(int to) const;
+
+				/**
+				 * Adds an adjacency to the back of the adjacency list of this
+				 * vertex.
+				 *
+				 * \note This takes constant time if this vertex is the vertex
+				 * with the highest ID that has adjacencies; otherwise it takes
+				 * time linear in the size of the graph.
+				 *
+				 * \param to The destination vertex.
+				 */
+				void addAdjacencyAfter(int to);
+
+				/**
+				 * Adds an adjacency to the front of the adjacency list of this
+				 * vertex.
+				 *
+				 * \note This takes time linear in the size of the graph.
+				 *
+				 * \param to The destination vertex.
+				 */
+				void addAdjacencyBefore(int to);
+
+			private:
+				/// The graph, if this handle allows modification, or `nullptr`
+				/// otherwise.
+				InputGraph* m_graph = nullptr;
 		};
 
 		/**
@@ -152,7 +211,7 @@ class InputGraph {
 		 * \param i The index.
 		 * \return The vertex.
 		 */
-		Vertex& operator[](int i);
+		Vertex operator[](int i);
 
 		/**
 		 * Returns the `i`th vertex in the graph.
@@ -160,7 +219,7 @@ class InputGraph {
 		 * \param i The index.
 		 * \return The vertex.
 		 */
-		const Vertex& operator[](int i) const;
+		const Vertex operator[](int i) const;
 
 		/**
 		 * Returns the number of vertices in the graph.
@@ -180,6 +239,17 @@ class InputGraph {
 		 */
 		int edgeCount() const;
 
+		/**
+		 * Returns the number of adjacencies in the graph, that is, twice the
+		 * number of edges.
+		 *
+		 * The adjacencies of all vertices are stored consecutively in one
+		 * flat array, ordered by the ID of their origin vertex; hence they are
+		 * numbered from 0 to `adjacencyCount() - 1`. See
+		 * \ref AdjacencyList::indexOf().
+		 */
+		int adjacencyCount() const;
+
 		/**
 		 * Removes all edges in the graph.
 		 */
@@ -215,23 +285,59 @@ class InputGraph {
 		 */
 		std::vector<HeightMap::Coordinate> neighborsOf(HeightMap::Coordinate v);
 
+		/// Inserts an adjacency from `from` to `to` at position `i` in the
+		/// adjacency list of `from`.
+		void insertAdjacency(int from, int i, int to);
+
+		/// Returns the permeable region index stored for element `i` in the
+		/// given side tables.
+		static std::optional<int> permeableRegionOf(
+		        int i, const std::vector<bool>& permeable,
+		        const std::unordered_map<int, int>& permeableRegions);
+
 		/// Marks a vertex with the given boundary status and permeable region.
-		void markVertex(HeightMap::Coordinate c, BoundaryStatus status,
+		void markVertex(int v, BoundaryStatus status,
 					std::optional<int> permeableRegion = std::nullopt);
 		/// Marks an edge (i.e., both adjacencies representing that edge) with
 		/// the given boundary status and permeable region.
-		void markEdge(HeightMap::Coordinate c1, HeightMap::Coordinate c2, BoundaryStatus status,
+		void markEdge(int v, int v2, BoundaryStatus status,
 					std::optional<int> permeableRegion = std::nullopt);
 
 		/**
-		 * List of the vertices.
+		 * The positions of the vertices, indexed by vertex ID.
+		 */
+		std::vector<Point> m_points;
+
+		/**
+		 * Offsets of the adjacency lists in \ref m_adjacencyTargets. The
+		 * adjacencies of vertex `v` are stored at positions
+		 * `m_adjacencyOffsets[v]` up to (but not including)
+		 * `m_adjacencyOffsets[v + 1]`. This has one more element than there
+		 * are vertices.
+		 */
+		std::vector<int> m_adjacencyOffsets{0};
+
+		/**
+		 * Destination vertex IDs of all adjacencies, grouped by origin
+		 * vertex, in the order of the adjacency lists.
 		 */
-		std::vector<Vertex> m_verts;
-	
-		/// Mapping from HeightMap coordinates to vertex IDs. m_vertexMap[x][y]
-		/// is the index of the InputGraph vertex representing this HeightMap
-		/// coordinate.
-		std::vector<std::vector<int>> m_vertexMap;
+		std::vector<int> m_adjacencyTargets;
+
+		/// For each vertex, whether it is on a permeable part of the boundary.
+		/// All other vertices are reported as `BoundaryStatus::IMPERMEABLE`.
+		std::vector<bool> m_vertexPermeable;
+		/// The permeable region index of the vertices that are on a permeable
+		/// part of the boundary, if set.
+		std::unordered_map<int, int> m_vertexPermeableRegion;
+
+		/// For each adjacency, whether it is on the boundary.
+		std::vector<bool> m_adjacencyOnBoundary;
+		/// For each adjacency, whether it is on a permeable part of the
+		/// boundary.
+		std::vector<bool> m_adjacencyPermeable;
+		/// The permeable region index of the adjacencies that are on a
+		/// permeable part of the boundary, if set.
+		std::unordered_map<int, int> m_adjacencyPermeableRegion;
 };
 
 // comparison operators for Adjacency
@@ -0,0 +1,163 @@
+#include "binaryheightmapreader.h"
+
+#include <QFile>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+/// Reads a little-endian value of type T.
+template <typename T>
+static T readLittleEndian(const char* data) {
+	char bytes[sizeof(T)];
+	if constexpr (std::endian::native == std::endian::little) {
+		std::memcpy(bytes, data, sizeof(T));
+	} else {
+		std::reverse_copy(data, data + sizeof(T), bytes);
+	}
+	T value;
+	std::memcpy(&value, bytes, sizeof(T));
+	return value;
+}
+
+/// Converts `count` consecutive little-endian values of type T into doubles,
+/// replacing the nodata value by \ref HeightMap::nodata.
+template <typename T>
+static void readValues(const char* data, int count, double nodata, double* target) {
+	if constexpr (std::is_same_v<T, double> && std::endian::native == std::endian::little) {
+		std::memcpy(target, data, count * sizeof(double));
+	} else {
+		for (int i = 0; i < count; i++) {
+			target[i] = readLittleEndian<T>(data + i * sizeof(T));
+		}
+	}
+	if (!std::isnan(nodata)) {
+		std::replace(target, target + count, nodata, HeightMap::nodata);
+	}
+}
+
+/// Copies the values of a file with values of type T into the heightmap.
+template <typename T>
+static void readRaster(const char* data, int tileWidth, int tileHeight, double nodata,
+                       HeightMap& heightMap) {
+	const int width = heightMap.width();
+	const int height = heightMap.height();
+	if (tileWidth == 0) {
+		for (int y = 0; y < height; y++) {
+			readValues<T>(data + static_cast<std::ptrdiff_t>(width) * y * sizeof(T), width, nodata,
+			              heightMap.data() + static_cast<std::ptrdiff_t>(width) * y);
+		}
+		return;
+	}
+	const int columns = (width + static_cast<std::ptrdiff_t>(tileWidth) - 1) / tileWidth;
+	const int rows = (height + static_cast<std::ptrdiff_t>(tileHeight) - 1) / tileHeight;
+	const std::ptrdiff_t tileSize = static_cast<std::ptrdiff_t>(tileWidth) * tileHeight * sizeof(T);
+	for (int row = 0; row < rows; row++) {
+		for (int column = 0; column < columns; column++) {
+			const char* tile = data + (static_cast<std::ptrdiff_t>(row) * columns + column) * tileSize;
+			int x = column * tileWidth;
+			int count = std::min(tileWidth, width - x);
+			for (int ty = 0; ty < tileHeight && row * tileHeight + ty < height; ty++) {
+				int y = row * tileHeight + ty;
+				readValues<T>(tile + static_cast<std::ptrdiff_t>(tileWidth) * ty * sizeof(T), count,
+				              nodata, heightMap.data() + static_cast<std::ptrdiff_t>(width) * y + x);
+			}
+		}
+	}
+}
+
+HeightMap
+BinaryHeightMapReader::readBinaryFile(
+        const QString& fileName, QString& error, Units& units) {
+
+	QFile file(fileName);
+	if (!file.open(QIODevice::ReadOnly)) {
+		error = QString("File could not be read (%1)").arg(file.errorString());
+		return HeightMap();
+	}
+	const qint64 size = file.size();
+	if (size < headerSize) {
+		error = QString("File is too small to contain a header");
+		return HeightMap();
+	}
+	// the mapping is removed when the file is closed
+	const char* data = reinterpret_cast<const char*>(file.map(0, size));
+	if (data == nullptr) {
+		error = QString("File could not be read (%1)").arg(file.errorString());
+		return HeightMap();
+	}
+
+	if (std::memcmp(data, "TTHEIGHT", 8) != 0) {
+		error = QString("File is not a TopoTide binary heightmap");
+		return HeightMap();
+	}
+	uint32_t fileVersion = readLittleEndian<uint32_t>(data + 8);
+	if (fileVersion != version) {
+		error = QString("Unsupported version %1 (expected %2)").arg(fileVersion).arg(version);
+		return HeightMap();
+	}
+	uint32_t valueSize = readLittleEndian<uint32_t>(data + 12);
+	if (valueSize != sizeof(float) && valueSize != sizeof(double)) {
+		error = QString("Value size should be 4 or 8 bytes (was %1)").arg(valueSize);
+		return HeightMap();
+	}
+	int32_t width = readLittleEndian<int32_t>(data + 16);
+	int32_t height = readLittleEndian<int32_t>(data + 20);
+	if (width <= 0 || height <= 0) {
+		error = QString("Width and height should be positive (were %1 and %2)")
+		            .arg(width).arg(height);
+		return HeightMap();
+	}
+	int32_t tileWidth = readLittleEndian<int32_t>(data + 24);
+	int32_t tileHeight = readLittleEndian<int32_t>(data + 28);
+	if (tileWidth < 0 || tileHeight < 0 || (tileWidth == 0) != (tileHeight == 0)) {
+		error = QString("Invalid tile size %1 x %2").arg(tileWidth).arg(tileHeight);
+		return HeightMap();
+	}
+	double xRes = readLittleEndian<double>(data + 32);
+	double yRes = readLittleEndian<double>(data + 40);
+	if (!(xRes > 0) || !(yRes > 0)) {
+		error = QString("Resolution should be positive (was %1 x %2)").arg(xRes).arg(yRes);
+		return HeightMap();
+	}
+	double nodata = readLittleEndian<double>(data + 48);
+
+	// the heightmap is indexed by int, and the padded raster should fit in a
+	// qint64 number of bytes
+	if (static_cast<qint64>(width) * height > std::numeric_limits<int>::max()) {
+		error = QString("Heightmap of %1 x %2 is too large").arg(width).arg(height);
+		return HeightMap();
+	}
+	qint64 paddedWidth = width;
+	qint64 paddedHeight = height;
+	if (tileWidth > 0) {
+		paddedWidth = (width + static_cast<qint64>(tileWidth) - 1) / tileWidth * tileWidth;
+		paddedHeight = (height + static_cast<qint64>(tileHeight) - 1) / tileHeight * tileHeight;
+	}
+	if (paddedWidth > (std::numeric_limits<qint64>::max() - headerSize) / valueSize / paddedHeight) {
+		error = QString("Heightmap of %1 x %2 is too large").arg(width).arg(height);
+		return HeightMap();
+	}
+	if (size != headerSize + paddedWidth * paddedHeight * valueSize) {
+		error = QString("File should contain %1 x %2 = %3 elevation values "
+		                "(encountered %4 bytes of data)")
+		            .arg(width).arg(height).arg(static_cast<qint64>(width) * height)
+		            .arg(size - headerSize);
+		return HeightMap();
+	}
+
+	HeightMap heightMap(width, height);
+	if (valueSize == sizeof(double)) {
+		readRaster<double>(data + headerSize, tileWidth, tileHeight, nodata, heightMap);
+	} else {
+		readRaster<float>(data + headerSize, tileWidth, tileHeight, nodata, heightMap);
+	}
+	units.m_xResolution = xRes;
+	units.m_yResolution = yRes;
+	return heightMap;
+}
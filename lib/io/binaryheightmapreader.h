@@ -0,0 +1,63 @@
+#ifndef BINARYHEIGHTMAPREADER_H
+#define BINARYHEIGHTMAPREADER_H
+
+#include <QString>
+
+#include "../heightmap.h"
+#include "../units.h"
+
+/**
+ * Class that handles reading a TopoTide binary heightmap file (`.tthm`).
+ *
+ * This format stores the raw elevation values, so that it can be read
+ * without any parsing. A file consists of a header of \ref headerSize bytes,
+ * followed by the elevation values. All numbers are little-endian.
+ *
+ * | Offset | Type       | Contents                                        |
+ * |--------|------------|-------------------------------------------------|
+ * | 0      | `char[8]`  | the magic string `TTHEIGHT`                     |
+ * | 8      | `uint32`   | the format version (currently 1)                |
+ * | 12     | `uint32`   | the size of each value: 4 (`float`) or 8 (`double`) |
+ * | 16     | `int32`    | the width                                       |
+ * | 20     | `int32`    | the height                                      |
+ * | 24     | `int32`    | the tile width, or 0 if the file is not tiled   |
+ * | 28     | `int32`    | the tile height, or 0 if the file is not tiled  |
+ * | 32     | `double`   | the x-resolution                                |
+ * | 40     | `double`   | the y-resolution                                |
+ * | 48     | `double`   | the value that marks nodata (may be NaN)        |
+ * | 56     | `uint64`   | reserved (0)                                    |
+ *
+ * If the file is not tiled, the values are stored in row-major order. If it
+ * is tiled, the tiles are stored in row-major order, and each tile stores
+ * its values in row-major order. Tiles on the right and bottom edge are
+ * padded to the full tile size.
+ */
+class BinaryHeightMapReader {
+
+	public:
+
+		/// The size of the header, in bytes.
+		static constexpr int headerSize = 64;
+		/// The format version this reader supports.
+		static constexpr int version = 1;
+
+		/**
+		 * Reads a binary heightmap file and outputs a corresponding river
+		 * heightmap.
+		 *
+		 * The file is memory-mapped, and the values are copied directly
+		 * into the heightmap.
+		 *
+		 * \param fileName The file name of the binary file.
+		 * \param error Reference to a QString to store an error message, in
+		 * case the file is malformed.
+		 * \param units Reference to a Units object to store the units in. If
+		 * the file is malformed, this Units object is unchanged.
+		 * \return The resulting heightmap. If the file is malformed, this
+		 * results a 0x0 heightmap.
+		 */
+		static HeightMap readBinaryFile(
+		        const QString& fileName, QString& error, Units& units);
+};
+
+#endif // BINARYHEIGHTMAPREADER_H
@@ -0,0 +1,96 @@
+#include "binaryheightmapwriter.h"
+
+#include <QSaveFile>
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <vector>
+
+#include "binaryheightmapreader.h"
+
+/// Appends a value of type T to the buffer, in little-endian byte order.
+template <typename T>
+static void writeLittleEndian(std::vector<char>& buffer, T value) {
+	char bytes[sizeof(T)];
+	std::memcpy(bytes, &value, sizeof(T));
+	if constexpr (std::endian::native != std::endian::little) {
+		std::reverse(bytes, bytes + sizeof(T));
+	}
+	buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+/// Appends the elevation values of a row of the heightmap (or `count`
+/// nodata values, if the row is out of bounds) to the buffer.
+template <typename T>
+static void writeRow(std::vector<char>& buffer, const HeightMap& heightMap, int x, int y,
+                     int count) {
+	for (int i = 0; i < count; i++) {
+		double elevation = heightMap.isInBounds(x + i, y) ? heightMap.elevationAt(x + i, y)
+		                                                  : HeightMap::nodata;
+		writeLittleEndian<T>(buffer, static_cast<T>(elevation));
+	}
+}
+
+/// Writes the elevation values in the layout described in
+/// BinaryHeightMapReader, one row (or row of tiles) at a time.
+template <typename T>
+static bool writeRaster(QSaveFile& file, const HeightMap& heightMap, int tileSize) {
+	std::vector<char> buffer;
+	if (tileSize == 0) {
+		for (int y = 0; y < heightMap.height(); y++) {
+			buffer.clear();
+			writeRow<T>(buffer, heightMap, 0, y, heightMap.width());
+			if (file.write(buffer.data(), buffer.size()) != static_cast<qint64>(buffer.size())) {
+				return false;
+			}
+		}
+		return true;
+	}
+	const int columns = (heightMap.width() + tileSize - 1L) / tileSize;
+	const int rows = (heightMap.height() + tileSize - 1L) / tileSize;
+	for (int row = 0; row < rows; row++) {
+		buffer.clear();
+		for (int column = 0; column < columns; column++) {
+			for (int ty = 0; ty < tileSize; ty++) {
+				writeRow<T>(buffer, heightMap, column * tileSize, row * tileSize + ty, tileSize);
+			}
+		}
+		if (file.write(buffer.data(), buffer.size()) != static_cast<qint64>(buffer.size())) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool BinaryHeightMapWriter::writeBinaryFile(const HeightMap& heightMap, const QString& fileName,
+                                            const Units& units, Precision precision,
+                                            int tileSize) {
+	QSaveFile file(fileName);
+	if (!file.open(QIODevice::WriteOnly)) {
+		return false;
+	}
+
+	const uint32_t valueSize = precision == Precision::SINGLE ? sizeof(float) : sizeof(double);
+	std::vector<char> header(std::begin("TTHEIGHT"), std::end("TTHEIGHT") - 1);
+	writeLittleEndian<uint32_t>(header, BinaryHeightMapReader::version);
+	writeLittleEndian<uint32_t>(header, valueSize);
+	writeLittleEndian<int32_t>(header, heightMap.width());
+	writeLittleEndian<int32_t>(header, heightMap.height());
+	writeLittleEndian<int32_t>(header, tileSize);
+	writeLittleEndian<int32_t>(header, tileSize);
+	writeLittleEndian<double>(header, units.m_xResolution);
+	writeLittleEndian<double>(header, units.m_yResolution);
+	// nodata values are stored as NaN
+	writeLittleEndian<double>(header, HeightMap::nodata);
+	writeLittleEndian<uint64_t>(header, 0);
+	if (file.write(header.data(), header.size()) != BinaryHeightMapReader::headerSize) {
+		return false;
+	}
+
+	bool ok = precision == Precision::SINGLE ? writeRaster<float>(file, heightMap, tileSize)
+	                                         : writeRaster<double>(file, heightMap, tileSize);
+	return ok && file.commit();
+}
@@ -0,0 +1,44 @@
+#ifndef BINARYHEIGHTMAPWRITER_H
+#define BINARYHEIGHTMAPWRITER_H
+
+#include <QString>
+
+#include "../heightmap.h"
+#include "../units.h"
+
+/**
+ * Class that handles writing a TopoTide binary heightmap file (`.tthm`). See
+ * BinaryHeightMapReader for a description of the format.
+ */
+class BinaryHeightMapWriter {
+
+	public:
+
+		/// The type in which the elevation values are stored.
+		enum class Precision {
+			/// 4-byte `float`s, which take half the space but lose precision.
+			SINGLE,
+			/// 8-byte `double`s, which store the values exactly.
+			DOUBLE
+		};
+
+		/**
+		 * Writes a binary heightmap file. The file is written to a
+		 * temporary file first, so that it never exists in a partially
+		 * written state.
+		 *
+		 * \param heightMap The heightmap to output.
+		 * \param fileName The file name of the binary file.
+		 * \param units Reference to a Units object to read the units from.
+		 * \param precision The type to store the elevation values in.
+		 * \param tileSize The width and height of the tiles, or 0 to store
+		 * the values row by row.
+		 * \return Whether writing the file succeeded.
+		 */
+		static bool writeBinaryFile(const HeightMap& heightMap, const QString& fileName,
+		                            const Units& units,
+		                            Precision precision = Precision::DOUBLE,
+		                            int tileSize = 0);
+};
+
+#endif // BINARYHEIGHTMAPWRITER_H
@@ -1,38 +1,71 @@
 #include "esrigridreader.h"
 
 #include <QFile>
-#include <QRegularExpression>
-#include <QStringList>
-#include <QTextStream>
 
-#include <limits>
+#include <algorithm>
+#include <cctype>
+#include <charconv>
 #include <stdexcept>
+#include <string_view>
+#include <vector>
 
-HeightMap
-EsriGridReader::readGridFile(
-        const QString& fileName, QString& error, Units& units) {
-	HeightMap heightMap = readGridFile(fileName, error, units, QLocale::C);
-	if (!heightMap.isEmpty()) {
-		return heightMap;
-	}
-
-	// some ESRI grid files in practice use a comma as a decimal separator,
-	// so if we have an error, retry with the Dutch locale
-	// we ignore the error here, because if both parsing attempts failed, then
-	// it is most likely that something else was wrong, so then we want the
-	// original error message to explain that
-	QString _;
-	heightMap = readGridFile(fileName, _, units, QLocale::Dutch);
-	if (!heightMap.isEmpty()) {
-		error = "";
-		return heightMap;
-	}
-	return HeightMap();
+#include "../parallel.h"
+
+static bool isWhitespace(char c) {
+	return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+/// Returns the token starting at or after `position`, and moves `position`
+/// past it. Returns an empty token if there are no tokens left.
+static std::string_view nextToken(const char*& position, const char* end) {
+	while (position != end && isWhitespace(*position)) {
+		position++;
+	}
+	const char* begin = position;
+	while (position != end && !isWhitespace(*position)) {
+		position++;
+	}
+	return std::string_view(begin, position - begin);
+}
+
+/// Parses an integer, which should span the entire token. A leading `+` is
+/// allowed, but not in combination with a `-`.
+static bool parseInt(std::string_view token, int& result) {
+	if (token.size() > 1 && token[0] == '+' && token[1] != '-') {
+		token.remove_prefix(1);
+	}
+	auto [end, error] = std::from_chars(token.data(), token.data() + token.size(), result);
+	return error == std::errc() && end == token.data() + token.size();
+}
+
+/// Parses a floating-point number, which should span the entire token, with
+/// the given decimal separator.
+static bool parseNumber(std::string_view token, char decimalSeparator, double& result) {
+	if (token.size() > 1 && token[0] == '+' && token[1] != '-') {
+		token.remove_prefix(1);
+	}
+	if (decimalSeparator != '.') {
+		// std::from_chars only accepts a point, so replace the separator in a
+		// copy of the token
+		char buffer[64];
+		if (token.size() > sizeof(buffer) || token.find('.') != std::string_view::npos) {
+			return false;
+		}
+		std::replace_copy(token.begin(), token.end(), buffer, decimalSeparator, '.');
+		auto [end, error] = std::from_chars(buffer, buffer + token.size(), result);
+		return error == std::errc() && end == buffer + token.size();
+	}
+	auto [end, error] = std::from_chars(token.data(), token.data() + token.size(), result);
+	return error == std::errc() && end == token.data() + token.size();
+}
+
+static QString toQString(std::string_view token) {
+	return QString::fromUtf8(token.data(), token.size());
 }
 
 HeightMap
 EsriGridReader::readGridFile(
-        const QString& fileName, QString& error, Units& units, QLocale locale) {
+        const QString& fileName, QString& error, Units& units, int threadCount) {
 
 	QFile file(fileName);
 	if (!file.open(QIODevice::ReadOnly)) {
@@ -40,33 +73,73 @@ EsriGridReader::readGridFile(
 		return HeightMap();
 	}
 
-	QTextStream stream(&file);
-	QStringList tokens = stream.readAll().split(QRegularExpression("\\s+"), Qt::SkipEmptyParts);
+	// map the file into memory, so that we can parse it without copying it
+	// first; the mapping is removed when the file is closed
+	const char* data = nullptr;
+	const qint64 size = file.size();
+	if (size > 0) {
+		data = reinterpret_cast<const char*>(file.map(0, size));
+		if (data == nullptr) {
+			error = QString("File could not be read (%1)").arg(file.errorString());
+			return HeightMap();
+		}
+	}
+	const char* const end = data + size;
 
-	// first build a map of key-value pairs in the header
-	Header header;
-	bool ok;
-	int i = 0;
-	while (tokens.size() > i && tokens[i][0].isLetter()) {
-		QString key = tokens[i];
-		if (tokens.size() < i + 2) {
-			error = QString("Missing value for %1").arg(key);
+	// first collect the key-value pairs in the header
+	std::vector<std::pair<std::string_view, std::string_view>> entries;
+	const char* position = data;
+	while (true) {
+		const char* keyStart = position;
+		std::string_view key = nextToken(position, end);
+		if (key.empty() || !std::isalpha(static_cast<unsigned char>(key[0]))) {
+			position = keyStart;
+			break;
+		}
+		std::string_view value = nextToken(position, end);
+		if (value.empty()) {
+			error = QString("Missing value for %1").arg(toQString(key));
 			return HeightMap();
 		}
-		int intValue = tokens[i + 1].toInt(&ok);
-		if (ok) {
-			header[key.toLower()] = intValue;
+		entries.emplace_back(key, value);
+	}
+	const char* const bodyBegin = position;
+
+	// some ESRI grid files in practice use a comma as a decimal separator;
+	// we assume that this is the case for the elevation values if the header
+	// or the first row of elevation values contains a comma
+	char decimalSeparator = '.';
+	for (const auto& [key, value] : entries) {
+		if (value.find(',') != std::string_view::npos) {
+			decimalSeparator = ',';
+		}
+	}
+	const char* firstRowBegin = bodyBegin;
+	while (firstRowBegin != end && isWhitespace(*firstRowBegin)) {
+		firstRowBegin++;
+	}
+	const char* firstRowEnd = std::find(firstRowBegin, end, '\n');
+	if (std::find(firstRowBegin, firstRowEnd, ',') != firstRowEnd) {
+		decimalSeparator = ',';
+	}
+
+	// each header value is parsed with the separator it contains, as the
+	// header may use a point even if the elevation values use a comma
+	Header header;
+	for (const auto& [key, value] : entries) {
+		int intValue;
+		double doubleValue;
+		if (parseInt(value, intValue)) {
+			header[toQString(key).toLower()] = intValue;
+		} else if (parseNumber(value,
+		                       value.find(',') != std::string_view::npos ? ',' : '.',
+		                       doubleValue)) {
+			header[toQString(key).toLower()] = doubleValue;
 		} else {
-			double doubleValue = locale.toDouble(tokens[i + 1], &ok);
-			if (ok) {
-				header[key.toLower()] = doubleValue;
-			} else {
-				error = QString("%1 should be numeric (was [%2])").
-						arg(key, tokens[i + 1]);
-				return HeightMap();
-			}
+			error = QString("%1 should be numeric (was [%2])").
+					arg(toQString(key), toQString(value));
+			return HeightMap();
 		}
-		i += 2;
 	}
 
 	int width, height;
@@ -81,43 +154,91 @@ EsriGridReader::readGridFile(
 		return HeightMap();
 	}
 
-	if (tokens.size() - i != width * height) {
+	// split the elevation data into chunks of roughly equal size, one per
+	// thread, such that no chunk boundary falls inside a token
+	const qint64 bodySize = end - bodyBegin;
+	const int chunkCount =
+	        std::max<qint64>(1, std::min<qint64>(threadCount, bodySize / (1 << 16)));
+	std::vector<const char*> chunkBegin(chunkCount + 1);
+	chunkBegin[0] = bodyBegin;
+	chunkBegin[chunkCount] = end;
+	for (int i = 1; i < chunkCount; i++) {
+		const char* boundary = std::max(chunkBegin[i - 1], bodyBegin + bodySize * i / chunkCount);
+		while (boundary != end && !isWhitespace(*boundary)) {
+			boundary++;
+		}
+		chunkBegin[i] = boundary;
+	}
+
+	// count the tokens in each chunk, to know where in the heightmap each
+	// chunk starts
+	std::vector<qint64> chunkStart(chunkCount + 1, 0);
+	parallelFor(chunkCount, threadCount, [&chunkBegin, &chunkStart](int i) {
+		const char* p = chunkBegin[i];
+		qint64 count = 0;
+		while (!nextToken(p, chunkBegin[i + 1]).empty()) {
+			count++;
+		}
+		chunkStart[i + 1] = count;
+	});
+	for (int i = 0; i < chunkCount; i++) {
+		chunkStart[i + 1] += chunkStart[i];
+	}
+	const qint64 valueCount = chunkStart[chunkCount];
+	if (valueCount != static_cast<qint64>(width) * height) {
 		error = QString("File should contain %1 x %2 = %3 elevation measures "
 		                "(encountered %4)")
-		            .arg(width).arg(height).arg(width * height)
-		            .arg(tokens.size() - i);
+		            .arg(width).arg(height).arg(static_cast<qint64>(width) * height)
+		            .arg(valueCount);
 		return HeightMap();
 	}
 
-	double minHeight = std::numeric_limits<double>::infinity();
-	double maxHeight = -std::numeric_limits<double>::infinity();
-	std::vector<double> elevations;
-	elevations.reserve(width * height);
-	for (; i < tokens.size(); i++) {
-		double elevation = locale.toDouble(tokens[i], &ok);
-		if (!ok) {
-			error = QString("Elevation data should be numbers "
-							"(encountered [%1])")
-						.arg(tokens[i]);
-			return HeightMap();
-		}
-		elevations.push_back(elevation);
-		if (elevation != nodata) {
-			minHeight = std::min(minHeight, elevation);
-			maxHeight = std::max(maxHeight, elevation);
-		}
-	}
-	
+	// parse the chunks in parallel; each chunk writes to its own range of
+	// the heightmap
 	HeightMap heightMap(width, height);
-	for (int y = 0; y < height; ++y) {
-		for (int x = 0; x < width; ++x) {
-			double elevation = elevations[width * y + x];
+	std::vector<std::string_view> invalidToken(chunkCount);
+	auto parseChunk = [&](int i, char separator) {
+		const char* p = chunkBegin[i];
+		int x = chunkStart[i] % width;
+		int y = chunkStart[i] / width;
+		std::string_view token;
+		while (!(token = nextToken(p, chunkBegin[i + 1])).empty()) {
+			double elevation;
+			if (!parseNumber(token, separator, elevation)) {
+				invalidToken[i] = token;
+				return;
+			}
 			if (elevation != nodata) {
 				heightMap.setElevationAt(x, y, elevation);
 			}
-			i++;
+			if (++x == width) {
+				x = 0;
+				y++;
+			}
+		}
+	};
+	parallelFor(chunkCount, threadCount, [&parseChunk, decimalSeparator](int i) {
+		parseChunk(i, decimalSeparator);
+	});
+	for (int i = 0; i < chunkCount; i++) {
+		if (invalidToken[i].empty()) {
+			continue;
+		}
+		// a comma may only occur later in the file; in that case we try
+		// again with a comma as the decimal separator
+		if (decimalSeparator == '.' && invalidToken[i].find(',') != std::string_view::npos) {
+			invalidToken[i] = std::string_view();
+			parseChunk(i, ',');
+			if (invalidToken[i].empty()) {
+				continue;
+			}
 		}
+		error = QString("Elevation data should be numbers "
+		                "(encountered [%1])")
+		            .arg(toQString(invalidToken[i]));
+		return HeightMap();
 	}
+
 	units.m_xResolution = res;
 	units.m_yResolution = res;
 	return heightMap;
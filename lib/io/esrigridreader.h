@@ -2,8 +2,8 @@
 #define ESRIGRIDREADER_H
 
 #include <unordered_map>
+#include <variant>
 
-#include <QLocale>
 #include <QString>
 
 #include "../heightmap.h"
@@ -12,6 +12,11 @@
 /**
  * Class that handles reading an ESRI grid file (a.k.a. ASCII GRID),
  * transforming it into a QImage for the HeightMap to use.
+ *
+ * The file is memory-mapped instead of read into a string, and the elevation
+ * values are parsed in parallel, directly into the heightmap. Both a point
+ * and a comma are supported as the decimal separator; which one is used is
+ * detected from the header and the first row of elevation values.
  */
 class EsriGridReader {
 
@@ -25,16 +30,15 @@ class EsriGridReader {
 		 * case there is a syntax error in the text file.
 		 * \param units Reference to a Units object to store the units in. If
 		 * there was a syntax error, this Units object is unchanged.
+		 * \param threadCount The number of threads to use for parsing the
+		 * elevation values.
 		 * \return The resulting heightmap. If there was a syntax error, this
 		 * results a 0x0 heightmap.
 		 */
 		static HeightMap readGridFile(
-		        const QString& fileName, QString& error, Units& units);
+		        const QString& fileName, QString& error, Units& units, int threadCount = 1);
 
 	private:
-		static HeightMap readGridFile(
-		        const QString& fileName, QString& error, Units& units, QLocale locale);
-
 		using Header = std::unordered_map<QString, std::variant<int, double>>;
 
 		/**
@@ -1,12 +1,17 @@
 #include "gdalreader.h"
 
+#include <cpl_conv.h>
 #include <cpl_error.h>
 #include <gdal_priv.h>
 
-HeightMap
-GdalReader::readGdalFile(
-        const QString& fileName, QString& error, Units& units) {
+#include <algorithm>
+#include <cstddef>
+#include <string>
 
+/// Opens the given file with GDAL, and returns its first raster band, or
+/// `nullptr` (with `error` set) if that fails.
+static GDALRasterBand* openFirstBand(const QString& fileName, GDALDatasetUniquePtr& dataset,
+                                     QString& error) {
 	std::string fileNameString = fileName.toStdString();
 	const char* fileNameCharArray = fileNameString.c_str();
 
@@ -15,48 +20,89 @@ GdalReader::readGdalFile(
 	});
 
 	GDALAllRegister();
-	GDALDatasetUniquePtr dataset(GDALDataset::FromHandle(GDALOpen(fileNameCharArray, GA_ReadOnly)));
+	dataset.reset(GDALDataset::FromHandle(GDALOpen(fileNameCharArray, GA_ReadOnly)));
 	if (!dataset) {
 		error = CPLGetLastErrorMsg();
-		return HeightMap();
+		return nullptr;
 	}
 	if (dataset->GetRasterCount() < 1) {
 		error = "Dataset did not have any bands";
+		return nullptr;
+	}
+	return dataset->GetRasterBand(1);
+}
+
+HeightMap
+GdalReader::readGdalFile(
+        const QString& fileName, QString& error, Units& units,
+        int threadCount, std::optional<Window> window) {
+
+	// drivers that support it (such as GeoTIFF) decode blocks in parallel
+	// if a single read spans multiple blocks; the option is restored when
+	// this function returns, so that it doesn't affect other GDAL calls
+	CPLConfigOptionSetter numThreads("GDAL_NUM_THREADS",
+	                                 std::to_string(std::max(1, threadCount)).c_str(), false);
+
+	GDALDatasetUniquePtr dataset;
+	GDALRasterBand* band = openFirstBand(fileName, dataset, error);
+	if (band == nullptr) {
 		return HeightMap();
 	}
-	GDALRasterBand* band = dataset->GetRasterBand(1);
 	int width = band->GetXSize();
 	int height = band->GetYSize();
 
-	int hasNoData;
-	double nodata = band->GetNoDataValue(&hasNoData);
-
-	std::vector<double> buffer(width * height);
-	CPLErr ioError = band->RasterIO(GF_Read, 0, 0, width, height, buffer.data(), width, height, GDT_Float64, 0, 0);
-	if (ioError != 0) {
-		error = CPLGetLastErrorMsg();
+	Window region = window.value_or(Window{0, 0, width, height});
+	if (region.m_x < 0 || region.m_y < 0 || region.m_width <= 0 || region.m_height <= 0 ||
+	    region.m_x + region.m_width > width || region.m_y + region.m_height > height) {
+		error = QString("Window (%1, %2, %3 x %4) does not fit in the raster (%5 x %6)")
+		            .arg(region.m_x).arg(region.m_y)
+		            .arg(region.m_width).arg(region.m_height)
+		            .arg(width).arg(height);
 		return HeightMap();
 	}
 
-	double minHeight = std::numeric_limits<double>::infinity();
-	double maxHeight = -std::numeric_limits<double>::infinity();
-	for (int i = 0; i < buffer.size(); i++) {
-		if (!hasNoData || buffer[i] != nodata) {
-			minHeight = std::min(minHeight, buffer[i]);
-			maxHeight = std::max(maxHeight, buffer[i]);
-		}
-	}
+	int hasNoData;
+	double nodata = band->GetNoDataValue(&hasNoData);
+
+	// read one row of blocks at a time, so that GDAL never needs to decode a
+	// block twice, while the reads are still large enough to be parallelized
+	int blockWidth;
+	int blockHeight;
+	band->GetBlockSize(&blockWidth, &blockHeight);
+	blockHeight = std::max(1, blockHeight);
 
 	HeightMap heightMap(width, height);
-	int i = 0;
-	for (int y = 0; y < height; ++y) {
-		for (int x = 0; x < width; ++x) {
-			double elevation = buffer[i];
-			if (!hasNoData || elevation != nodata) {
-				heightMap.setElevationAt(x, y, elevation);
+	const GSpacing lineSpace = static_cast<GSpacing>(width) * sizeof(double);
+	int y = region.m_y;
+	while (y < region.m_y + region.m_height) {
+		int rows = std::min(blockHeight - y % blockHeight, region.m_y + region.m_height - y);
+		double* target = heightMap.data() + static_cast<std::ptrdiff_t>(width) * y + region.m_x;
+		CPLErr ioError = band->RasterIO(GF_Read, region.m_x, y, region.m_width, rows, target,
+		                                region.m_width, rows, GDT_Float64, sizeof(double),
+		                                lineSpace, nullptr);
+		if (ioError != CE_None) {
+			error = CPLGetLastErrorMsg();
+			return HeightMap();
+		}
+		if (hasNoData) {
+			for (int row = 0; row < rows; row++) {
+				double* line = target + static_cast<std::ptrdiff_t>(width) * row;
+				std::replace(line, line + region.m_width, nodata, HeightMap::nodata);
 			}
-			i++;
 		}
+		y += rows;
 	}
 	return heightMap;
 }
+
+bool GdalReader::readRasterSize(
+        const QString& fileName, int& width, int& height, QString& error) {
+	GDALDatasetUniquePtr dataset;
+	GDALRasterBand* band = openFirstBand(fileName, dataset, error);
+	if (band == nullptr) {
+		return false;
+	}
+	width = band->GetXSize();
+	height = band->GetYSize();
+	return true;
+}
@@ -1,6 +1,8 @@
 #ifndef GDALREADER_H
 #define GDALREADER_H
 
+#include <optional>
+
 #include <QString>
 
 #include "../heightmap.h"
@@ -14,20 +16,56 @@ class GdalReader {
 
 	public:
 
+		/// A rectangular part of a raster, in pixels.
+		struct Window {
+			/// The x-coordinate of the leftmost column.
+			int m_x;
+			/// The y-coordinate of the topmost row.
+			int m_y;
+			/// The number of columns.
+			int m_width;
+			/// The number of rows.
+			int m_height;
+		};
+
 		/**
 		 * Reads a raster file using GDAL and outputs a corresponding river
 		 * heightmap.
 		 *
+		 * The raster is read one row of blocks at a time (in the block size
+		 * the file is stored in), directly into the heightmap.
+		 *
 		 * \param fileName The file name of the grid file.
 		 * \param error Reference to a QString to store an error message, in
 		 * case there is a syntax error in the text file.
 		 * \param units Reference to a Units object to store the units in. If
 		 * there was a syntax error, this Units object is unchanged.
+		 * \param threadCount The number of threads GDAL may use for decoding
+		 * the raster (see `GDAL_NUM_THREADS`), for drivers that support this.
+		 * \param window If given, only the elevation values in this part of
+		 * the raster are read; the other values in the heightmap are \ref
+		 * HeightMap::nodata. The heightmap still has the size of the entire
+		 * raster, so that coordinates do not change.
 		 * \return The resulting heightmap. If there was a syntax error, this
 		 * results a 0x0 heightmap.
 		 */
 		static HeightMap readGdalFile(
-		        const QString& fileName, QString& error, Units& units);
+		        const QString& fileName, QString& error, Units& units,
+		        int threadCount = 1, std::optional<Window> window = std::nullopt);
+
+		/**
+		 * Reads the size of a raster file using GDAL, without reading the
+		 * raster itself.
+		 *
+		 * \param fileName The file name of the grid file.
+		 * \param width Reference to store the width of the raster in.
+		 * \param height Reference to store the height of the raster in.
+		 * \param error Reference to a QString to store an error message, in
+		 * case the file cannot be read.
+		 * \return Whether reading the size succeeded.
+		 */
+		static bool readRasterSize(
+		        const QString& fileName, int& width, int& height, QString& error);
 };
 
 #endif // GDALREADER_H
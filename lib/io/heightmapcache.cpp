@@ -0,0 +1,61 @@
+#include "heightmapcache.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QStandardPaths>
+
+#include "binaryheightmapreader.h"
+#include "binaryheightmapwriter.h"
+
+HeightMapCache::HeightMapCache(const QString& directory) : m_directory(directory) {}
+
+QString HeightMapCache::defaultDirectory() {
+	return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/heightmaps";
+}
+
+HeightMap HeightMapCache::read(const QString& sourceFileName, Units& units) const {
+	QString fileName = entryFileName(sourceFileName);
+	if (!QFileInfo::exists(fileName)) {
+		return HeightMap();
+	}
+	QString error;
+	return BinaryHeightMapReader::readBinaryFile(fileName, error, units);
+}
+
+bool HeightMapCache::write(const QString& sourceFileName, const HeightMap& heightMap,
+                           const Units& units) const {
+	QDir directory(m_directory);
+	if (!directory.mkpath(".")) {
+		return false;
+	}
+	QString fileName = entryFileName(sourceFileName);
+	if (!BinaryHeightMapWriter::writeBinaryFile(heightMap, fileName, units)) {
+		return false;
+	}
+
+	// remove the entries for older versions of the source file
+	const QStringList entries =
+	        directory.entryList({entryPrefix(sourceFileName) + "-*.tthm"}, QDir::Files);
+	for (const QString& entry : entries) {
+		if (directory.filePath(entry) != fileName) {
+			directory.remove(entry);
+		}
+	}
+	return true;
+}
+
+QString HeightMapCache::entryPrefix(const QString& sourceFileName) const {
+	QByteArray path = QFileInfo(sourceFileName).absoluteFilePath().toUtf8();
+	return QString::fromLatin1(
+	    QCryptographicHash::hash(path, QCryptographicHash::Sha1).toHex().left(16));
+}
+
+QString HeightMapCache::entryFileName(const QString& sourceFileName) const {
+	QFileInfo source(sourceFileName);
+	return QDir(m_directory).filePath(QString("%1-%2-%3.tthm")
+	                                      .arg(entryPrefix(sourceFileName))
+	                                      .arg(source.size())
+	                                      .arg(source.lastModified().toMSecsSinceEpoch()));
+}
@@ -0,0 +1,67 @@
+#ifndef HEIGHTMAPCACHE_H
+#define HEIGHTMAPCACHE_H
+
+#include <QString>
+
+#include "../heightmap.h"
+#include "../units.h"
+
+/**
+ * A cache of heightmaps read from DEM files, stored as TopoTide binary
+ * heightmap files (see BinaryHeightMapReader), so that opening the same DEM
+ * again does not need to parse or decode it.
+ *
+ * Cache entries are keyed on the absolute path, the size and the
+ * modification time of the source file, so that an entry is not used
+ * anymore once the source file changes.
+ */
+class HeightMapCache {
+
+	public:
+
+		/**
+		 * Creates a cache that stores its entries in the given directory.
+		 * The directory is created when the first entry is written.
+		 */
+		explicit HeightMapCache(const QString& directory);
+
+		/**
+		 * Returns the default cache directory, in the user's cache location.
+		 */
+		static QString defaultDirectory();
+
+		/**
+		 * Reads the cached heightmap for the given source file.
+		 *
+		 * \param sourceFileName The file name of the DEM file.
+		 * \param units Reference to a Units object to store the units in.
+		 * If there is no cache entry, this Units object is unchanged.
+		 * \return The cached heightmap, or a 0x0 heightmap if there is no
+		 * up-to-date cache entry.
+		 */
+		HeightMap read(const QString& sourceFileName, Units& units) const;
+
+		/**
+		 * Stores the heightmap read from the given source file in the
+		 * cache, replacing older entries for the same file.
+		 *
+		 * \param sourceFileName The file name of the DEM file.
+		 * \param heightMap The heightmap read from the file.
+		 * \param units The units read from the file.
+		 * \return Whether storing the entry succeeded.
+		 */
+		bool write(const QString& sourceFileName, const HeightMap& heightMap,
+		           const Units& units) const;
+
+	private:
+		/// Returns the prefix shared by all entries of the given source file.
+		QString entryPrefix(const QString& sourceFileName) const;
+		/// Returns the file name of the entry for the current version of the
+		/// given source file.
+		QString entryFileName(const QString& sourceFileName) const;
+
+		/// The directory the entries are stored in.
+		QString m_directory;
+};
+
+#endif // HEIGHTMAPCACHE_H
@@ -1,9 +1,50 @@
 #include "textfilereader.h"
 
 #include <QFile>
-#include <QRegularExpression>
-#include <QStringList>
-#include <QTextStream>
+
+#include <cctype>
+#include <charconv>
+#include <string_view>
+
+/// Returns the token starting at or after `position`, and moves `position`
+/// past it. Returns an empty token if there are no tokens left. `line` and
+/// `lineStart` keep track of the line number and the start of the current
+/// line.
+static std::string_view nextToken(const char*& position, const char* end,
+                                  int& line, const char*& lineStart) {
+	while (position != end && std::isspace(static_cast<unsigned char>(*position))) {
+		if (*position == '\n') {
+			line++;
+			lineStart = position + 1;
+		}
+		position++;
+	}
+	const char* begin = position;
+	while (position != end && !std::isspace(static_cast<unsigned char>(*position))) {
+		position++;
+	}
+	return std::string_view(begin, position - begin);
+}
+
+/// Returns a description of the location of a token, for error messages.
+static QString location(std::string_view token, int line, const char* lineStart) {
+	return QString("line %1, column %2").arg(line).arg(token.data() - lineStart + 1);
+}
+
+static QString toQString(std::string_view token) {
+	return QString::fromUtf8(token.data(), token.size());
+}
+
+/// Parses a number (of type int or double), which should span the entire
+/// token. A leading `+` is allowed, but not in combination with a `-`.
+template <typename T>
+static bool parse(std::string_view token, T& result) {
+	if (token.size() > 1 && token[0] == '+' && token[1] != '-') {
+		token.remove_prefix(1);
+	}
+	auto [end, error] = std::from_chars(token.data(), token.data() + token.size(), result);
+	return error == std::errc() && end == token.data() + token.size();
+}
 
 HeightMap
 TextFileReader::readTextFile(
@@ -15,25 +56,39 @@ TextFileReader::readTextFile(
 		return HeightMap();
 	}
 
-	QTextStream stream(&file);
-	QStringList numbers = stream.readAll().split(QRegularExpression("\\s+"),
-	                                             Qt::SkipEmptyParts);
-
-	if (numbers.size() < 6) {
-		error = QString("Premature end of file (should contain at least "
-		                "six numbers indicating the width, height, "
-		                "x-resolution, y-resolution, "
-		                "minimum height, maximum height)");
-		return HeightMap();
+	// map the file into memory, and parse it in a single pass without
+	// copying it
+	const char* data = nullptr;
+	const qint64 size = file.size();
+	if (size > 0) {
+		data = reinterpret_cast<const char*>(file.map(0, size));
+		if (data == nullptr) {
+			error = QString("File could not be read (%1)").arg(file.errorString());
+			return HeightMap();
+		}
 	}
+	const char* const end = data + size;
+	const char* position = data;
+	int line = 1;
+	const char* lineStart = data;
 
-	bool ok;
+	std::string_view header[6];
+	for (std::string_view& token : header) {
+		token = nextToken(position, end, line, lineStart);
+		if (token.empty()) {
+			error = QString("Premature end of file (should contain at least "
+			                "six numbers indicating the width, height, "
+			                "x-resolution, y-resolution, "
+			                "minimum height, maximum height)");
+			return HeightMap();
+		}
+	}
 
 	// parse width and height
-	int width = numbers[0].toInt(&ok);
-	if (!ok) {
+	int width;
+	if (!parse(header[0], width)) {
 		error = QString("Width should be an integer (was [%1])").
-		        arg(numbers[0]);
+		        arg(toQString(header[0]));
 		return HeightMap();
 	}
 	if (width <= 0) {
@@ -41,10 +96,10 @@ TextFileReader::readTextFile(
 		return HeightMap();
 	}
 
-	int height = numbers[1].toInt(&ok);
-	if (!ok) {
+	int height;
+	if (!parse(header[1], height)) {
 		error = QString("Height should be an integer (was [%1])").
-		        arg(numbers[1]);
+		        arg(toQString(header[1]));
 		return HeightMap();
 	}
 	if (height <= 0) {
@@ -52,10 +107,10 @@ TextFileReader::readTextFile(
 		return HeightMap();
 	}
 
-	double xRes = numbers[2].toDouble(&ok);
-	if (!ok) {
+	double xRes;
+	if (!parse(header[2], xRes)) {
 		error = QString("x-resolution should be a number (was [%1])").
-		        arg(numbers[2]);
+		        arg(toQString(header[2]));
 		return HeightMap();
 	}
 	if (xRes <= 0) {
@@ -64,10 +119,10 @@ TextFileReader::readTextFile(
 		return HeightMap();
 	}
 
-	double yRes = numbers[3].toDouble(&ok);
-	if (!ok) {
+	double yRes;
+	if (!parse(header[3], yRes)) {
 		error = QString("y-resolution should be a number (was [%1])").
-		        arg(numbers[3]);
+		        arg(toQString(header[3]));
 		return HeightMap();
 	}
 	if (yRes <= 0) {
@@ -78,44 +133,63 @@ TextFileReader::readTextFile(
 
 	// minHeight and maxHeight are not used anymore, but are still read for
 	// compatibility with old files
-	[[maybe_unused]] double minHeight = numbers[4].toDouble(&ok);
-	if (!ok) {
+	[[maybe_unused]] double minHeight;
+	if (!parse(header[4], minHeight)) {
 		error = QString("Minimum height should be a number (was [%1])").
-		        arg(numbers[4]);
+		        arg(toQString(header[4]));
 		return HeightMap();
 	}
 
-	[[maybe_unused]] double maxHeight = numbers[5].toDouble(&ok);
-	if (!ok) {
+	[[maybe_unused]] double maxHeight;
+	if (!parse(header[5], maxHeight)) {
 		error = QString("Maximum height should be a number (was [%1])").
-		        arg(numbers[5]);
+		        arg(toQString(header[5]));
 		return HeightMap();
 	}
 
-	if (numbers.size() != 6 + width * height) {
+	// read the elevation data row by row, in the order in which it is stored
+	// in the heightmap
+	const qint64 expectedCount = static_cast<qint64>(width) * height;
+	HeightMap heightMap(width, height);
+	qint64 count = 0;
+	int x = 0;
+	int y = 0;
+	std::string_view token;
+	while (!(token = nextToken(position, end, line, lineStart)).empty()) {
+		if (count == expectedCount) {
+			error = QString("File should contain %1 x %2 = %3 elevation measures "
+			                "(encountered more at %4)")
+			        .arg(width)
+			        .arg(height)
+			        .arg(expectedCount)
+			        .arg(location(token, line, lineStart));
+			return HeightMap();
+		}
+		double elevation;
+		if (!parse(token, elevation)) {
+			error = QString("Elevation data should be numbers "
+			                "(encountered [%1] at %2)")
+			        .arg(toQString(token), location(token, line, lineStart));
+			return HeightMap();
+		}
+		heightMap.setElevationAt(x, y, elevation);
+		count++;
+		if (++x == width) {
+			x = 0;
+			y++;
+		}
+	}
+
+	if (count != expectedCount) {
 		error = QString("File should contain %1 x %2 = %3 elevation measures "
 		                "(encountered %4)")
 		        .arg(width)
 		        .arg(height)
-		        .arg(width * height)
-		        .arg(numbers.size() - 6);
+		        .arg(expectedCount)
+		        .arg(count);
 		return HeightMap();
 	}
 
-	HeightMap heightMap(width, height);
-	for (int x = 0; x < width; ++x) {
-		for (int y = 0; y < height; ++y) {
-			double elevation = numbers[6 + width * y + x].toDouble(&ok);
-			if (!ok) {
-				error = QString("Elevation data should be numbers "
-				                "(encountered [%1])").
-				        arg(numbers[6 + width * y + x]);
-				return HeightMap();
-			}
-
-			heightMap.setElevationAt(x, y, elevation);
-		}
-	}
 	units.m_xResolution = xRes;
 	units.m_yResolution = yRes;
 	return heightMap;
@@ -1,13 +1,19 @@
 #include "mergetree.h"
 
 #include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+
+#include "parallel.h"
+#include "unionfind.h"
 
 MergeTree::MergeTree(const std::shared_ptr<MsComplex>& msc) : m_msc(msc) {
 	// add all maxima (MS faces)
 	std::vector<int> faceToNodeIdMap(m_msc->faceCount(), -1);
 	for (int i = 0; i < m_msc->faceCount(); i++) {
 		MsComplex::Face face = m_msc->face(i);
-		int nodeId = addNode(face, face.data().maximum.data().p, {});
+		int nodeId = addNode(face, face.data().p, {});
 		faceToNodeIdMap[i] = nodeId;
 	}
 
@@ -23,26 +29,62 @@ MergeTree::MergeTree(const std::shared_ptr<MsComplex>& msc) : m_msc(msc) {
 		return v1.data().p > v2.data().p;
 	});
 
+	// We sweep downwards over the saddles, maintaining the subtrees built so
+	// far in a union-find structure on the faces. For each subtree, we store
+	// the root node and the piece of the subtree's total sand function that
+	// is valid at the current height of the sweep. The latter needs to be
+	// updated whenever the sweep passes a breakpoint of one of the sand
+	// functions of the faces, so we sort those breakpoints as well.
+	UnionFind faceSets(m_msc->faceCount());
+	std::vector<int> rootOfSet = faceToNodeIdMap;
+	std::vector<LinearFunction> volumeAboveOfSet;
+	volumeAboveOfSet.reserve(m_msc->faceCount());
+	std::vector<Breakpoint> breakpoints;
+	for (int i = 0; i < m_msc->faceCount(); i++) {
+		const PiecewiseLinearFunction& volumeAbove = m_msc->face(i).data().volumeAbove;
+		volumeAboveOfSet.push_back(volumeAbove.functions().back());
+		for (int j = 0; j < volumeAbove.breakpoints().size(); j++) {
+			breakpoints.push_back(Breakpoint{volumeAbove.breakpoints()[j], i, j});
+		}
+	}
+	std::sort(breakpoints.begin(), breakpoints.end(), [](const Breakpoint& b1, const Breakpoint& b2) {
+		return b1.height > b2.height;
+	});
+	int nextBreakpoint = 0;
+
 	// add a merge tree vertex for each saddle
 	for (int i = 0; i < saddles.size(); i++) {
 		MsComplex::Vertex saddle = saddles[i];
 		assert(saddle.data().type == VertexType::saddle);
-		MsComplex::Face f1 = saddle.outgoing().incidentFace();
-		MsComplex::Face f2 = saddle.outgoing().nextOutgoing().incidentFace();
-
-		int f1NodeId = faceToNodeIdMap[f1.id()];
-		assert(f1NodeId != -1);
-		int f1RootId = findRootOfSubtree(f1NodeId);
+		double height = saddle.data().p.h;
+
+		// move the sweep down to the saddle (a sand function uses the piece
+		// below a breakpoint at the breakpoint itself)
+		while (nextBreakpoint < breakpoints.size() &&
+		       breakpoints[nextBreakpoint].height >= height) {
+			const Breakpoint& breakpoint = breakpoints[nextBreakpoint];
+			const std::pmr::vector<LinearFunction>& functions =
+			    m_msc->face(breakpoint.face).data().volumeAbove.functions();
+			LinearFunction& volumeAbove = volumeAboveOfSet[faceSets.findSet(breakpoint.face)];
+			volumeAbove = volumeAbove.add(functions[breakpoint.index])
+			                  .subtract(functions[breakpoint.index + 1]);
+			nextBreakpoint++;
+		}
 
-		int f2NodeId = faceToNodeIdMap[f2.id()];
-		assert(f2NodeId != -1);
-		int f2RootId = findRootOfSubtree(f2NodeId);
+		int f1SetId = faceSets.findSet(saddle.outgoing().incidentFace().id());
+		int f2SetId = faceSets.findSet(saddle.outgoing().nextOutgoing().incidentFace().id());
 
-		if (f1RootId != f2RootId) {
-			int newNodeId = addNode(saddle, saddle.data().p, {f1RootId, f2RootId});
-			m_nodes[newNodeId].m_volumeAbove = computeVolumeAbove(m_nodes[newNodeId]);
+		if (f1SetId != f2SetId) {
+			int newNodeId = addNode(saddle, saddle.data().p, {rootOfSet[f1SetId], rootOfSet[f2SetId]});
+			faceSets.merge(f1SetId, f2SetId);
+			rootOfSet[f1SetId] = newNodeId;
+			volumeAboveOfSet[f1SetId] = volumeAboveOfSet[f1SetId].add(volumeAboveOfSet[f2SetId]);
+			m_nodes[newNodeId].m_volumeAbove = volumeAboveOfSet[f1SetId](height);
 		}
 	}
+
+	buildAncestorIndex();
+	numberLeaves();
 }
 
 const MergeTree::Node& MergeTree::root() const {
@@ -58,7 +100,7 @@ const MergeTree::Node& MergeTree::get(int index) const {
 int MergeTree::addNode(std::variant<MsComplex::Vertex, MsComplex::Face> criticalSimplex, Point p,
                        std::vector<int> children) {
 	int index = m_nodes.size();
-	Node node{index, children, -1, p, 0, criticalSimplex};
+	Node node{index, children, -1, p, 0, criticalSimplex, -1, -1};
 	for (int childIndex : children) {
 		assert(childIndex >= 0 && childIndex < m_nodes.size());
 		m_nodes[childIndex].m_parent = index;
@@ -67,17 +109,10 @@ int MergeTree::addNode(std::variant<MsComplex::Vertex, MsComplex::Face> critical
 	return index;
 }
 
-int MergeTree::findRootOfSubtree(int index) {
-	while (m_nodes[index].m_parent != -1) {
-		assert(index >= 0 && index < m_nodes.size());
-		index = m_nodes[index].m_parent;
-	}
-	return index;
-}
-
 void MergeTree::sort(std::function<bool(Node&, Node&)> comparator) {
 	Node& root = m_nodes.back();
 	sort(root, comparator);
+	numberLeaves();
 }
 
 void MergeTree::sort(Node& root, std::function<bool(Node&, Node&)> comparator) {
@@ -88,32 +123,106 @@ void MergeTree::sort(Node& root, std::function<bool(Node&, Node&)> comparator) {
 	}
 }
 
-double MergeTree::computeVolumeAbove(Node& node) {
-	return computeVolumeAbove(node, node.m_p.h);
+void MergeTree::buildAncestorIndex() {
+	// level 0: the parents
+	std::vector<int> parents(m_nodes.size());
+	for (int i = 0; i < m_nodes.size(); i++) {
+		parents[i] = m_nodes[i].m_parent;
+	}
+	m_ancestors.clear();
+	m_ancestors.push_back(std::move(parents));
+
+	// level k: the 2^(k-1)-th ancestors of the 2^(k-1)-th ancestors
+	bool hasAncestors = true;
+	while (hasAncestors) {
+		const std::vector<int>& previous = m_ancestors.back();
+		std::vector<int> level(m_nodes.size(), -1);
+		hasAncestors = false;
+		for (int i = 0; i < m_nodes.size(); i++) {
+			if (previous[i] != -1) {
+				level[i] = previous[previous[i]];
+				hasAncestors = hasAncestors || level[i] != -1;
+			}
+		}
+		if (hasAncestors) {
+			m_ancestors.push_back(std::move(level));
+		}
+	}
 }
 
-double MergeTree::computeVolumeAbove(Node& node, double height) {
-	// are we a leaf?
-	if (node.m_children.empty()) {
-		assert(std::holds_alternative<MsComplex::Face>(node.m_criticalSimplex));
-		MsComplex::Face maximum = std::get<MsComplex::Face>(node.m_criticalSimplex);
-		return maximum.data().volumeAbove(height);
+void MergeTree::numberLeaves() {
+	// iterative depth-first search from each root (the tree can be too deep
+	// for recursion); a node is pushed once before and once after its children
+	int leafCount = 0;
+	std::vector<std::pair<int, bool>> stack;
+	for (int i = 0; i < m_nodes.size(); i++) {
+		if (m_nodes[i].m_parent != -1) {
+			continue;
+		}
+		stack.emplace_back(i, false);
+		while (!stack.empty()) {
+			auto [nodeId, visited] = stack.back();
+			stack.pop_back();
+			Node& node = m_nodes[nodeId];
+			if (node.m_children.empty()) {
+				node.m_firstLeaf = leafCount;
+				node.m_lastLeaf = leafCount;
+				leafCount++;
+			} else if (!visited) {
+				node.m_firstLeaf = leafCount;
+				stack.emplace_back(nodeId, true);
+				for (auto child = node.m_children.rbegin(); child != node.m_children.rend();
+				     child++) {
+					stack.emplace_back(*child, false);
+				}
+			} else {
+				node.m_lastLeaf = leafCount - 1;
+			}
+		}
 	}
+}
 
-	// otherwise, we are an internal node
-	double volume = 0;
-	for (int child : node.m_children) {
-		volume += computeVolumeAbove(m_nodes[child], height);
+std::vector<int> MergeTree::leafRaster(int width, int height) const {
+	std::vector<int> raster(static_cast<std::size_t>(width) * height, -1);
+	for (const Node& node : m_nodes) {
+		if (!node.m_children.empty()) {
+			continue;
+		}
+		MsComplex::Face maximum = std::get<MsComplex::Face>(node.m_criticalSimplex);
+		for (InputDcel::Face f : maximum.data().faces) {
+			Point p = InputDcel::position(f);
+			int x = std::floor(p.x);
+			int y = std::floor(p.y);
+			if (x >= 0 && x < width && y >= 0 && y < height) {
+				raster[static_cast<std::size_t>(y) * width + x] = node.m_firstLeaf;
+			}
+		}
 	}
-	return volume;
+	return raster;
 }
 
-std::optional<int> MergeTree::parentAtHeight(int nodeId, double height) {
+std::optional<int> MergeTree::parentAtHeight(int nodeId, double height) const {
+	assert(nodeId >= 0 && nodeId < m_nodes.size());
 	if (m_nodes[nodeId].m_p.h < height) {
 		return std::nullopt;
 	}
-	while (m_nodes[nodeId].m_parent != -1 && m_nodes[m_nodes[nodeId].m_parent].m_p.h > height) {
-		nodeId = m_nodes[nodeId].m_parent;
+	// the heights of the ancestors of a node decrease towards the root, so we
+	// can take the largest jumps that stay above the height first
+	for (int k = m_ancestors.size() - 1; k >= 0; k--) {
+		int ancestor = m_ancestors[k][nodeId];
+		if (ancestor != -1 && m_nodes[ancestor].m_p.h > height) {
+			nodeId = ancestor;
+		}
 	}
 	return nodeId;
 }
+
+std::vector<std::optional<int>> MergeTree::parentsAtHeight(const std::vector<int>& nodeIds,
+                                                           double height,
+                                                           int threadCount) const {
+	std::vector<std::optional<int>> result(nodeIds.size());
+	parallelFor(nodeIds.size(), threadCount, [this, &nodeIds, height, &result](int i) {
+		result[i] = parentAtHeight(nodeIds[i], height);
+	});
+	return result;
+}
@@ -4,6 +4,7 @@
 #include <memory>
 #include <optional>
 #include <variant>
+#include <vector>
 
 #include "mscomplex.h"
 
@@ -20,23 +21,87 @@ class MergeTree {
 				Point m_p;
 				double m_volumeAbove;
 				std::variant<MsComplex::Vertex, MsComplex::Face> m_criticalSimplex;
+				/// The leaves are numbered in depth-first order, so that the
+				/// leaves in the subtree of this node have the consecutive
+				/// numbers `m_firstLeaf, ..., m_lastLeaf`. For a leaf, both
+				/// are its own number.
+				int m_firstLeaf;
+				int m_lastLeaf;
 		};
 
 		const Node& root() const;
 		const Node& get(int index) const;
 
 		void sort(std::function<bool(Node&, Node&)> comparator);
-		std::optional<int> parentAtHeight(int nodeId, double height);
+
+		/**
+		 * Returns the highest ancestor of the given node that is still above
+		 * the given height, that is, the root of the subtree that contains
+		 * the node in the superlevel set at that height. If the node itself
+		 * is below the height, returns `std::nullopt`.
+		 *
+		 * This takes O(log n) time, using an index of the ancestors of every
+		 * node that is built when constructing the merge tree.
+		 *
+		 * \param nodeId The node to start from.
+		 * \param height The height.
+		 * \return The ID of the ancestor.
+		 */
+		std::optional<int> parentAtHeight(int nodeId, double height) const;
+
+		/**
+		 * Runs parentAtHeight() for many nodes at once.
+		 *
+		 * \param nodeIds The nodes to start from.
+		 * \param height The height.
+		 * \param threadCount The number of threads to use.
+		 * \return For each node in `nodeIds`, the result of
+		 * `parentAtHeight(nodeId, height)`.
+		 */
+		std::vector<std::optional<int>> parentsAtHeight(const std::vector<int>& nodeIds,
+		                                                double height,
+		                                                int threadCount = 1) const;
+
+		/**
+		 * Returns a raster of the given size that contains for each cell the
+		 * number of the leaf (see Node::m_firstLeaf) whose MS-face contains
+		 * the cell, or -1 if there is no such leaf. Cell (x, y) corresponds to
+		 * the InputDcel face whose top-left corner is vertex (x, y), and is
+		 * stored at index `y * width + x`.
+		 *
+		 * Combined with the leaf ranges of the nodes, this allows checking
+		 * whether a cell lies in the subtree of a node by comparing two
+		 * integers.
+		 *
+		 * \param width The width of the raster.
+		 * \param height The height of the raster.
+		 * \return The raster.
+		 */
+		std::vector<int> leafRaster(int width, int height) const;
 
 	private:
 		int addNode(std::variant<MsComplex::Vertex, MsComplex::Face> criticalSimplex, Point p,
 					std::vector<int> children);
-		int findRootOfSubtree(int index);
 		void sort(Node& root, std::function<bool(Node&, Node&)> comparator);
-		double computeVolumeAbove(Node& node);
-		double computeVolumeAbove(Node& node, double height);
+		/// Fills `m_ancestors` based on the parent pointers of the nodes.
+		void buildAncestorIndex();
+		/// Sets the leaf numbers and ranges of all nodes.
+		void numberLeaves();
+
+		/// A breakpoint of the sand function of an MS-face.
+		struct Breakpoint {
+			/// The height of the breakpoint.
+			double height;
+			/// The ID of the face.
+			int face;
+			/// The index of the breakpoint in the face's sand function.
+			int index;
+		};
 
 		std::vector<Node> m_nodes;
+		/// The ancestor index: `m_ancestors[k][i]` is the 2^k-th ancestor of
+		/// node `i`, or -1 if it has fewer ancestors.
+		std::vector<std::vector<int>> m_ancestors;
 		int m_rootIndex;
 		std::shared_ptr<MsComplex> m_msc;
 };
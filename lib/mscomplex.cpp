@@ -26,14 +26,14 @@ void MsVertex::output(std::ostream& out) {
 
 void MsHalfEdge::output(std::ostream& out) {
 	if (m_dcelPath.length() > 1) {
-		out << "path from " << m_dcelPath.edges()[0].destination().data().p;
+		out << "path from " << m_dcelPath.firstEdge().destination().data().p;
 	}
 }
 
 void MsFace::output(std::ostream& out) {
 	out << "(" << faces.size() << " faces";
 	if (maximum.isInitialized()) {
-		out << ", maximum " << maximum.data().p;
+		out << ", maximum " << p;
 	}
 	out << ")";
 }
@@ -43,7 +43,7 @@ MsComplex::dcelPath(MsComplex::HalfEdge e) {
 	if (e.origin().data().type == VertexType::minimum) {
 		return e.twin().data().m_dcelPath.reversed();
 	} else {
-		return e.data().m_dcelPath;
+		return e.data().m_dcelPath.toPath();
 	}
 }
 
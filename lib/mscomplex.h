@@ -62,8 +62,11 @@ class MsHalfEdge {
 		 * This is used only for saddle -> minimum edges; the DCEL path of a
 		 * minimum -> saddle edge can be found by reversing the dcelPath of its
 		 * twin.
+		 *
+		 * This is stored compactly (see InputDcel::GradientPath), so that
+		 * copying a Morse-Smale complex is cheap.
 		 */
-		InputDcel::Path m_dcelPath;
+		InputDcel::GradientPath m_dcelPath;
 
 		/**
 		 * The δ-value for this half-edge, as computed by the persistence
@@ -94,6 +97,12 @@ class MsFace {
 		 */
 		InputDcel::Face maximum;
 
+		/**
+		 * The position of `maximum` (see InputDcel::position(Face)). If
+		 * `maximum` is the InputDcel's outer face, this is (-1, -1, -∞).
+		 */
+		Point p;
+
 		/**
 		 * A list of faces within a Morse-Smale cell, given as IDs in the
 		 * InputDcel. If `maximum` is the InputDcel's outer face, then this is
@@ -7,12 +7,15 @@
 #include "boundarystatus.h"
 #include "inputdcel.h"
 #include "mscomplexcreator.h"
+#include "parallel.h"
 #include "vertextype.h"
 
 MsComplexCreator::MsComplexCreator(const std::shared_ptr<InputDcel>& dcel,
                                    const std::shared_ptr<MsComplex>& msc,
-                                   std::function<void(int)> progressListener)
-    : m_dcel(dcel), m_msc(msc), m_progressListener(progressListener) {}
+                                   std::function<void(int)> progressListener,
+                                   int threadCount)
+    : m_dcel(dcel), m_msc(msc), m_progressListener(progressListener),
+      m_threadCount(threadCount) {}
 
 void MsComplexCreator::create() {
 
@@ -25,10 +28,16 @@ void MsComplexCreator::create() {
 	boundaryMinimum.data().p = {-1, -1, -std::numeric_limits<double>::infinity()};
 	boundaryMinimum.data().type = VertexType::minimum;
 
-	// Add an MS-vertex for each terrain minimum.
+	// Add an MS-vertex for each terrain minimum. The critical vertices are
+	// determined in parallel, but the MS-vertices are added sequentially, so
+	// that their IDs do not depend on the number of threads.
+	std::vector<char> isMinimum(m_dcel->vertexCount());
+	parallelFor(m_dcel->vertexCount(), m_threadCount, [this, &isMinimum](int i) {
+		isMinimum[i] = m_dcel->isCritical(m_dcel->vertex(i));
+	});
 	for (int i = 0; i < m_dcel->vertexCount(); i++) {
 		InputDcel::Vertex v = m_dcel->vertex(i);
-		if (m_dcel->isCritical(v)) {
+		if (isMinimum[i]) {
 			MsComplex::Vertex newV = m_msc->addVertex();
 			newV.data().p = v.data().p;
 			newV.data().inputDcelSimplex = v;
@@ -39,15 +48,21 @@ void MsComplexCreator::create() {
 
 	signalProgress(5);
 
-	// Add an MS-vertex for each saddle.
+	// Add an MS-vertex for each saddle. Both half-edges of a saddle edge are
+	// critical; the MS-vertex is added for the one with the lower ID.
+	std::vector<char> isSaddle(m_dcel->halfEdgeCount());
+	parallelFor(m_dcel->halfEdgeCount(), m_threadCount, [this, &isSaddle](int i) {
+		InputDcel::HalfEdge e = m_dcel->halfEdge(i);
+		isSaddle[i] = e.twin().id() > i && m_dcel->isCritical(e);
+	});
 	for (int i = 0; i < m_dcel->halfEdgeCount(); i++) {
 		InputDcel::HalfEdge e = m_dcel->halfEdge(i);
 
-		if (m_dcel->isCritical(e) && e.twin().data().msVertex == -1) {
+		if (isSaddle[i]) {
 			MsComplex::Vertex newV = m_msc->addVertex();
-			newV.data().p = e.data().p;
-			// Saddles get assigned the height of their highest endpoint.
-			newV.data().p.h = std::max(e.origin().data().p.h, e.destination().data().p.h);
+			// Saddles get assigned the height of their highest endpoint, which
+			// is what InputDcel::position() returns.
+			newV.data().p = InputDcel::position(e);
 			newV.data().inputDcelSimplex = e;
 			newV.data().type = VertexType::saddle;
 			e.data().msVertex = newV.id();
@@ -65,12 +80,27 @@ void MsComplexCreator::create() {
 	// that order to set next/previous pointers in the DCEL correctly. On the
 	// other hand, next/previous pointers around saddles are trivial to set as
 	// saddles have degree 2.)
+	//
+	// The DFSs only read the InputDcel, so they are run in parallel, each
+	// storing its saddle order in its own buffer. Afterwards, the MS-edges are
+	// added sequentially in the order of the minima.
+	std::vector<MsComplex::Vertex> minima;
 	for (int i = 0; i < m_msc->vertexCount(); i++) {
 		MsComplex::Vertex m = m_msc->vertex(i);
 		if (m.data().type == VertexType::minimum && m != boundaryMinimum) {
-			addEdgesFromMinimum(m);
+			minima.push_back(m);
 		}
 	}
+	std::vector<std::vector<InputDcel::GradientPath>> orders(minima.size());
+	parallelFor(minima.size(), m_threadCount, [this, &minima, &orders](int i) {
+		assert(std::holds_alternative<InputDcel::Vertex>(minima[i].data().inputDcelSimplex));
+		orders[i] = saddleOrder(std::get<InputDcel::Vertex>(minima[i].data().inputDcelSimplex));
+	}, [this](int progress) {
+		signalProgress(10 + progress / 10);
+	});
+	for (int i = 0; i < minima.size(); i++) {
+		addEdgesFromMinimum(minima[i], std::move(orders[i]));
+	}
 
 	// Add boundary minimum → saddle half-edges. This works the same as “normal”
 	// minimum → saddle half-edges, except the boundary minimum doesn't actually
@@ -88,12 +118,22 @@ void MsComplexCreator::create() {
 
 	signalProgress(50);
 
-	// For each MS-face, find its maximum and the set of InputDcel faces it
-	// contains.
-	for (int i = 0; i < m_msc->faceCount(); i++) {
+	// For each MS-face, find its maximum. Every MS-face only writes its own
+	// data, so this is done in parallel.
+	parallelFor(m_msc->faceCount(), m_threadCount, [this](int i) {
 		MsComplex::Face f = m_msc->face(i);
-		setDcelFacesOfFace(f);
-	}
+		f.data().maximum = findFaceMaximum(f);
+		if (f.data().maximum == m_dcel->outerFace()) {
+			f.data().p = {-1, -1, -std::numeric_limits<double>::infinity()};
+		} else {
+			f.data().p = InputDcel::position(f.data().maximum);
+		}
+	}, [this](int progress) {
+		signalProgress(50 + progress / 5);
+	});
+
+	// Then find the set of InputDcel faces each MS-face contains.
+	setDcelFacesOfFaces();
 
 	// Assert that the sum of numbers of InputDcel faces assigned to MS-faces is
 	// equal to the total number of InputDcel faces (minus one: the outer face
@@ -109,34 +149,24 @@ void MsComplexCreator::create() {
 
 	signalProgress(80);
 
-	// Compute sand functions for each face.
-	for (int i = 0; i < m_msc->faceCount(); i++) {
-		MsComplex::Face f = m_msc->face(i);
-		setSandFunctionOfFace(f);
-	}
+	// Compute sand functions for each face (again in parallel).
+	parallelFor(m_msc->faceCount(), m_threadCount, [this](int i) {
+		setSandFunctionOfFace(m_msc->face(i));
+	}, [this](int progress) {
+		signalProgress(80 + progress / 5);
+	});
 
 	signalProgress(100);
 }
 
-void MsComplexCreator::addEdgesFromMinimum(MsComplex::Vertex m) {
-	// Find the paths from each reachable saddle around this minimum, in
-	// counter-clockwise order.
-	assert(m.data().type == VertexType::minimum);
-	assert(std::holds_alternative<InputDcel::Vertex>(m.data().inputDcelSimplex));
-	std::vector<InputDcel::Path> order =
-	    saddleOrder(std::get<InputDcel::Vertex>(m.data().inputDcelSimplex));
-
-	// Add MS-edges representing these paths.
-	addEdgesFromMinimum(m, order);
-}
-
-void MsComplexCreator::addEdgesFromMinimum(MsComplex::Vertex m, std::vector<InputDcel::Path> order) {
+void MsComplexCreator::addEdgesFromMinimum(MsComplex::Vertex m,
+                                           std::vector<InputDcel::GradientPath> order) {
 	// Add MS-edges representing the paths in the given order.
 	std::vector<MsComplex::HalfEdge> addedEdges;
-	for (const InputDcel::Path& path : order) {
+	for (const InputDcel::GradientPath& path : order) {
 		// Find the MS-vertex representing the path's origin saddle.
-		assert(path.edges().front().data().msVertex != -1);
-		MsComplex::Vertex s = m_msc->vertex(path.edges().front().data().msVertex);
+		assert(path.firstEdge().data().msVertex != -1);
+		MsComplex::Vertex s = m_msc->vertex(path.firstEdge().data().msVertex);
 
 		// Create the MS-edge.
 		MsComplex::HalfEdge edge = m_msc->addEdge(m, s);
@@ -181,16 +211,16 @@ void MsComplexCreator::addEdgesFromBoundaryMinimum(MsComplex::Vertex boundaryMin
 	// from each reachable saddle, in clockwise order. All of these paths
 	// together result in one consistent order of saddles around the boundary
 	// minimum.
-	std::vector<InputDcel::Path> order;
-	m_dcel->outerFace().forAllBoundaryVertices([this, &order, &boundaryMinimum](InputDcel::Vertex v) {
+	std::vector<InputDcel::GradientPath> order;
+	for (InputDcel::Vertex v : m_dcel->outerFace().boundaryVertices()) {
 		assert(v.data().boundaryStatus != BoundaryStatus::INTERIOR);
 		if (v.data().boundaryStatus == BoundaryStatus::PERMEABLE) {
-			std::vector<InputDcel::Path> vertexOrder = saddleOrder(v);
+			std::vector<InputDcel::GradientPath> vertexOrder = saddleOrder(v);
 			// saddleOrder() returns a counter-clockwise order, so we need to
 			// reverse the order to make it clockwise.
 			order.insert(order.end(), vertexOrder.rbegin(), vertexOrder.rend());
 		}
-	});
+	}
 
 	// Because the boundary minimum is outside the boundary itself, walking in
 	// counter-clockwise order around the boundary minimum corresponds to
@@ -202,8 +232,8 @@ void MsComplexCreator::addEdgesFromBoundaryMinimum(MsComplex::Vertex boundaryMin
 	addEdgesFromMinimum(boundaryMinimum, order);
 }
 
-std::vector<InputDcel::Path> MsComplexCreator::saddleOrder(InputDcel::Vertex m) {
-	std::vector<InputDcel::Path> order;
+std::vector<InputDcel::GradientPath> MsComplexCreator::saddleOrder(InputDcel::Vertex m) {
+	std::vector<InputDcel::GradientPath> order;
 
 	InputDcel::HalfEdge edge = m.outgoing();  // arbitrary outgoing edge
 	InputDcel::HalfEdge endEdge = edge;
@@ -216,7 +246,7 @@ std::vector<InputDcel::Path> MsComplexCreator::saddleOrder(InputDcel::Vertex m)
 }
 
 void MsComplexCreator::saddleOrderRecursive(InputDcel::HalfEdge edge,
-                                            std::vector<InputDcel::Path>& order) {
+                                            std::vector<InputDcel::GradientPath>& order) {
 
 	edge = edge.twin();
 
@@ -235,18 +265,53 @@ void MsComplexCreator::saddleOrderRecursive(InputDcel::HalfEdge edge,
 	}
 }
 
-void MsComplexCreator::setDcelFacesOfFace(MsComplex::Face f) {
+void MsComplexCreator::setDcelFacesOfFaces() {
+
+	// Every InputDcel face belongs to the MS-face whose maximum we reach by
+	// walking upwards following edge-face gradient pairs. Instead of walking
+	// all the way up from every face, we remember for every face the maximum
+	// we found, so that every face is visited only a constant number of times.
+	std::vector<int> maximumOf(m_dcel->faceCount(), -1);
+	std::vector<int> walked;
+	for (int i = 0; i < m_dcel->faceCount(); i++) {
+		InputDcel::Face face = m_dcel->face(i);
+		while (maximumOf[face.id()] == -1 && face.data().pairedWithEdge != -1) {
+			walked.push_back(face.id());
+			face = m_dcel->halfEdge(face.data().pairedWithEdge).twin().incidentFace();
+		}
+		int maximum = maximumOf[face.id()] == -1 ? face.id() : maximumOf[face.id()];
+		maximumOf[face.id()] = maximum;
+		for (int walkedFace : walked) {
+			maximumOf[walkedFace] = maximum;
+		}
+		walked.clear();
+	}
 
-	f.data().maximum = findFaceMaximum(f);
+	// Faces whose maximum is the outer face do not belong to any MS-face.
+	std::vector<int> msFaceOfMaximum(m_dcel->faceCount(), -1);
+	for (int i = 0; i < m_msc->faceCount(); i++) {
+		MsComplex::Face f = m_msc->face(i);
+		if (f.data().maximum != m_dcel->outerFace()) {
+			msFaceOfMaximum[f.data().maximum.id()] = i;
+		}
+	}
 
-	// From the maximum, collect all the faces of f
-	if (f.data().maximum != m_dcel->outerFace()) {
-		f.data().faces.push_back(f.data().maximum);
-		f.data().maximum.forAllReachableFaces([](InputDcel::HalfEdge e) {
-			return e.twin().data().pairedWithFace;
-		}, [&f](InputDcel::Face foundFace, InputDcel::HalfEdge) {
-			f.data().faces.push_back(foundFace);
-		});
+	std::vector<int> faceCounts(m_msc->faceCount(), 0);
+	for (int i = 0; i < m_dcel->faceCount(); i++) {
+		int msFace = msFaceOfMaximum[maximumOf[i]];
+		m_dcel->face(i).data().msFace = msFace;
+		if (msFace != -1) {
+			faceCounts[msFace]++;
+		}
+	}
+	for (int i = 0; i < m_msc->faceCount(); i++) {
+		m_msc->face(i).data().faces.reserve(faceCounts[i]);
+	}
+	for (int i = 0; i < m_dcel->faceCount(); i++) {
+		InputDcel::Face face = m_dcel->face(i);
+		if (face.data().msFace != -1) {
+			m_msc->face(face.data().msFace).data().faces.push_back(face);
+		}
 	}
 }
 
@@ -259,7 +324,7 @@ InputDcel::Face MsComplexCreator::findFaceMaximum(MsComplex::Face f) {
 	assert(e.origin().data().type == VertexType::saddle);
 
 	// Start from the InputDcel face adjacent to the saddle edge.
-	const InputDcel::HalfEdge saddleEdge = e.data().m_dcelPath.edges()[0];
+	const InputDcel::HalfEdge saddleEdge = e.data().m_dcelPath.firstEdge();
 	InputDcel::Face face = saddleEdge.incidentFace();
 
 	// Walk upwards following edge-face gradient pairs.
@@ -276,26 +341,16 @@ void MsComplexCreator::setSandFunctionOfFace(MsComplex::Face f) {
 		f.data().volumeAbove =
 		    PiecewiseLinearFunction(LinearFunction{std::numeric_limits<double>::infinity()});
 	} else {
-		std::queue<PiecewiseLinearFunction> queue;
+		// Every boundary vertex of every DCEL face contributes a quarter
+		// pillar, so vertices are counted once per incident face.
+		std::pmr::vector<double> heights;
+		heights.reserve(4 * f.data().faces.size());
 		for (auto face : f.data().faces) {
-			face.forAllBoundaryVertices([&queue](InputDcel::Vertex v) {
-				queue.push(PiecewiseLinearFunction{v.data().p});
-			});
+			for (InputDcel::Vertex v : face.boundaryVertices()) {
+				heights.push_back(v.data().p.h);
+			}
 		}
-		if (queue.empty()) {
-			f.data().volumeAbove = PiecewiseLinearFunction();
-			return;
-		}
-
-		while (queue.size() > 1) {
-			PiecewiseLinearFunction f1 = queue.front();
-			queue.pop();
-			PiecewiseLinearFunction f2 = queue.front();
-			queue.pop();
-			queue.push(f1.add(f2));
-		}
-
-		f.data().volumeAbove = queue.front();
+		f.data().volumeAbove = PiecewiseLinearFunction::sumOfPillars(std::move(heights));
 	}
 }
 
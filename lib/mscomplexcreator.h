@@ -48,34 +48,41 @@ class MsComplexCreator {
 		/// \param dcel The DCEL to create a Morse-Smale complex from.
 		/// \param msc An empty Morse-Smale complex to store the result in.
 		/// \param progressListener A function that is called when a progress
-		/// update is available.
+		/// update is available. It is always called from the thread that
+		/// calls create().
+		/// \param threadCount The number of threads to use. The resulting
+		/// Morse-Smale complex does not depend on this.
 		MsComplexCreator(const std::shared_ptr<InputDcel>& dcel,
 		                 const std::shared_ptr<MsComplex>& msc,
-		                 std::function<void(int)> progressListener = nullptr);
+		                 std::function<void(int)> progressListener = nullptr,
+		                 int threadCount = 1);
 
 		/// Creates the Morse-Smale complex.
 		void create();
 
 	private:
 
+		void addEdgesFromBoundaryMinimum(MsComplex::Vertex boundaryMinimum);
+
 		/// Adds all Morse-Smale edges connected to the given minimum.
 		///
 		/// This method creates all half-edges in the Morse-Smale complex around
 		/// the minimum, and sets all next / previous pointers around the
-		/// minimum, but leaves the next / previous pointers on the other side
-		/// of the edges (that is, at the saddle) unset.
-		void addEdgesFromMinimum(MsComplex::Vertex m);
-
-		void addEdgesFromBoundaryMinimum(MsComplex::Vertex boundaryMinimum);
-
-		void addEdgesFromMinimum(MsComplex::Vertex m, std::vector<InputDcel::Path> order);
+		/// minimum. The next / previous pointers on the other side of the edges
+		/// (that is, at the saddle) are set only once both edges of the saddle
+		/// have been added.
+		///
+		/// \param order The saddle order around the minimum, as computed by
+		/// saddleOrder().
+		void addEdgesFromMinimum(MsComplex::Vertex m,
+		                         std::vector<InputDcel::GradientPath> order);
 
 		/// Returns the saddle order around the given minimum.
 		///
 		/// \return A list with saddles, in counter-clockwise order. Every
 		/// saddle is represented by a path consisting of the half-edges in the
 		/// saddle-to-minimum Morse-Smale edge.
-		std::vector<InputDcel::Path> saddleOrder(InputDcel::Vertex m);
+		std::vector<InputDcel::GradientPath> saddleOrder(InputDcel::Vertex m);
 
 		/// Computes a part of the saddle order around a minimum, starting
 		/// the search from the given vertex, and adds them to the list.
@@ -86,10 +93,14 @@ class MsComplexCreator {
 		/// 
 		/// \note Helper method for \c saddleOrder().
 		void saddleOrderRecursive(InputDcel::HalfEdge wedgeSteepestDescentEdge,
-		                          std::vector<InputDcel::Path>& order);
+		                          std::vector<InputDcel::GradientPath>& order);
 
-		/// Sets the `faces` set and the `maximum` pointer of the given face.
-		void setDcelFacesOfFace(MsComplex::Face f);
+		/// Sets the `faces` set of all MS-faces, and the `msFace` of all
+		/// InputDcel faces. This assumes that the `maximum` pointers of the
+		/// MS-faces have been set already.
+		///
+		/// This takes time linear in the number of InputDcel faces.
+		void setDcelFacesOfFaces();
 		/// Finds the InputDcel face that is the maximum of the given MS-face.
 		/// This can also be the outer face of the InputDcel.
 		InputDcel::Face findFaceMaximum(MsComplex::Face f);
@@ -109,6 +120,9 @@ class MsComplexCreator {
 
 		/// A function that is called when there is a progress update.
 		std::function<void(int)> m_progressListener;
+
+		/// The number of threads to use.
+		int m_threadCount;
 };
 
 #endif // MSCOMPLEXCREATOR_H
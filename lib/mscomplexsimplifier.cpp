@@ -1,11 +1,13 @@
 #include "mscomplexsimplifier.h"
 
 #include <algorithm>
+#include <limits>
+#include <optional>
+#include <vector>
 
 MsComplexSimplifier::MsComplexSimplifier(const std::shared_ptr<MsComplex>& msc,
                                          std::function<void(int)> progressListener) :
     msc(msc),
-    mscCopy(*msc),
     progressListener(progressListener) {
 }
 
@@ -18,11 +20,32 @@ MsComplexSimplifier::signalProgress(int progress) {
 
 void
 MsComplexSimplifier::simplify() {
+	computeDeltas();
+	writeDeltas();
+}
+
+void
+MsComplexSimplifier::computeDeltas() {
+
+	// start from the values currently stored in the MS complex
+	deltas.resize(msc->halfEdgeCount());
+	for (int i = 0; i < msc->halfEdgeCount(); i++) {
+		deltas[i] = msc->halfEdge(i).data().m_delta;
+	}
+	heaviestSides.resize(msc->vertexCount());
+	for (int i = 0; i < msc->vertexCount(); i++) {
+		heaviestSides[i] = msc->vertex(i).data().m_heaviestSide;
+	}
+
+	// the faces that have been merged so far, and the sand functions of the
+	// faces that other faces have been merged into
+	UnionFind faceSets(msc->faceCount());
+	std::vector<std::optional<PiecewiseLinearFunction>> mergedVolumeAbove(msc->faceCount());
 
 	// sort saddle points on (ascending) height
 	std::vector<MsComplex::Vertex> saddles;
-	for (int i = 0; i < mscCopy.vertexCount(); i++) {
-		MsComplex::Vertex v = mscCopy.vertex(i);
+	for (int i = 0; i < msc->vertexCount(); i++) {
+		MsComplex::Vertex v = msc->vertex(i);
 		if (v.data().type == VertexType::saddle) {
 			saddles.push_back(v);
 		}
@@ -39,80 +62,131 @@ MsComplexSimplifier::simplify() {
 		MsComplex::Vertex saddle = saddles[i];
 
 		std::pair<double, MsComplex::HalfEdge> significance =
-		        computeSaddleSignificance(saddle);
+		        computeSaddleSignificance(saddle, faceSets, mergedVolumeAbove);
 		double delta = significance.first;
 		MsComplex::HalfEdge heaviestSide = significance.second;
-		msc->vertex(saddle.id()).data().m_heaviestSide =
-		    heaviestSide.data().m_dcelPath.edges().front().id();
+		heaviestSides[saddle.id()] = heaviestSide.data().m_dcelPath.firstEdge().id();
 
 		// saddles should have degree 2
 		assert(saddle.outgoing().nextOutgoing().nextOutgoing() ==
 		       saddle.outgoing());
 
 		// set edge weights
-		msc->halfEdge(saddle.outgoing().id()).data().m_delta = delta;
-		msc->halfEdge(saddle.outgoing().id()).twin().data().m_delta = delta;
-		msc->halfEdge(saddle.outgoing().nextOutgoing().id()).
-		        data().m_delta = delta;
-		msc->halfEdge(saddle.outgoing().nextOutgoing().id()).
-		        twin().data().m_delta = delta;
-
-		if (saddle.outgoing().incidentFace() != saddle.outgoing().nextOutgoing().incidentFace()) {
-			// actually remove saddle, and merge faces
-			// add sand functions around the saddle together
-			PiecewiseLinearFunction f;
-			f = f.add(heaviestSide.incidentFace().data().volumeAbove);
-			f = f.add(heaviestSide.nextOutgoing().incidentFace().data().volumeAbove);
+		deltas[saddle.outgoing().id()] = delta;
+		deltas[saddle.outgoing().twin().id()] = delta;
+		deltas[saddle.outgoing().nextOutgoing().id()] = delta;
+		deltas[saddle.outgoing().nextOutgoing().twin().id()] = delta;
+
+		int heavyFace = faceSets.findSet(heaviestSide.incidentFace().id());
+		int lightFace = faceSets.findSet(heaviestSide.nextOutgoing().incidentFace().id());
+		if (heavyFace != lightFace) {
+			// actually remove saddle, and merge faces: add sand functions
+			// around the saddle together (in place, into the sand function of
+			// the largest face, which is copied from the MS complex the first
+			// time another face is merged into it)
+			if (!mergedVolumeAbove[heavyFace]) {
+				mergedVolumeAbove[heavyFace] = msc->face(heavyFace).data().volumeAbove;
+			}
+			PiecewiseLinearFunction& f = *mergedVolumeAbove[heavyFace];
+			f += volumeAboveOf(lightFace, mergedVolumeAbove);
 			f.prune(saddle.data().p.h);
+			mergedVolumeAbove[lightFace].reset();
 
-			// assign added sand function to largest face
-			heaviestSide.incidentFace().data().volumeAbove = f;
-
-			// remove the saddle and its adjacent edges, maintaining the data
-			// (and sand function) of the largest face
-			heaviestSide.remove();
+			// the largest face remains the representative of the merged face
+			faceSets.merge(heavyFace, lightFace);
 		}
 	}
 
 	// remove all degree-1 vertices (iteratively)
-	bool removedVertices;
-	do {
-		removedVertices = false;
-		for (int i = 0; i < msc->vertexCount(); i++) {
-			MsComplex::Vertex v = msc->vertex(i);
-			if (v.isRemoved()) {
-				continue;
-			}
-			if (v.data().p.h == -std::numeric_limits<double>::infinity()) {
-				continue;
-			}
-			std::vector<MsComplex::HalfEdge> edges;
-			v.forAllOutgoingEdges([&edges](MsComplex::HalfEdge e) {
-				edges.push_back(e);
-			});
-			if (edges.size() == 1) {
-				if (edges[0].data().m_delta > 0) {
-					edges[0].data().m_delta = 0;
-					edges[0].twin().data().m_delta = 0;
-					removedVertices = true;
+	propagateDeltas(*msc, deltas);
+}
+
+void
+MsComplexSimplifier::writeDeltas() {
+	assert(deltas.size() == msc->halfEdgeCount());
+	assert(heaviestSides.size() == msc->vertexCount());
+	for (int i = 0; i < msc->halfEdgeCount(); i++) {
+		msc->halfEdge(i).data().m_delta = deltas[i];
+	}
+	for (int i = 0; i < msc->vertexCount(); i++) {
+		msc->vertex(i).data().m_heaviestSide = heaviestSides[i];
+	}
+}
+
+void MsComplexSimplifier::propagateDeltas(MsComplex& msc) {
+	std::vector<double> deltas(msc.halfEdgeCount());
+	for (int i = 0; i < msc.halfEdgeCount(); i++) {
+		deltas[i] = msc.halfEdge(i).data().m_delta;
+	}
+	propagateDeltas(msc, deltas);
+	for (int i = 0; i < msc.halfEdgeCount(); i++) {
+		msc.halfEdge(i).data().m_delta = deltas[i];
+	}
+}
+
+void MsComplexSimplifier::propagateDeltas(MsComplex& msc, std::vector<double>& deltas) {
+	// initially every vertex needs to be checked; after that, a vertex only
+	// needs to be checked again if the δ-value of one of its edges decreased
+	// (we use the worklist as a stack, so that a change is followed along a
+	// branch right away, instead of being interleaved with other changes)
+	std::vector<int> worklist(msc.vertexCount());
+	std::vector<bool> inWorklist(msc.vertexCount(), true);
+	for (int i = 0; i < msc.vertexCount(); i++) {
+		worklist[i] = i;
+	}
+
+	while (!worklist.empty()) {
+		MsComplex::Vertex v = msc.vertex(worklist.back());
+		worklist.pop_back();
+		inWorklist[v.id()] = false;
+		if (v.isRemoved()) {
+			continue;
+		}
+		if (v.data().p.h == -std::numeric_limits<double>::infinity()) {
+			continue;
+		}
+
+		// find the edge with the highest δ-value (if it is unique), and the
+		// second-highest δ-value
+		int degree = 0;
+		MsComplex::HalfEdge highest;
+		double secondHighestDelta = -std::numeric_limits<double>::infinity();
+		for (MsComplex::HalfEdge e : v.outgoingEdges()) {
+			degree++;
+			if (!highest.isInitialized() || deltas[e.id()] > deltas[highest.id()]) {
+				if (highest.isInitialized()) {
+					secondHighestDelta = deltas[highest.id()];
 				}
-				continue;
+				highest = e;
+			} else {
+				secondHighestDelta = std::max(secondHighestDelta, deltas[e.id()]);
 			}
-			std::sort(edges.begin(), edges.end(),
-			          [](MsComplex::HalfEdge e1, MsComplex::HalfEdge e2) {
-				return e1.data().m_delta > e2.data().m_delta;
-			});
-			if (edges[0].data().m_delta > edges[1].data().m_delta) {
-				edges[0].data().m_delta = edges[1].data().m_delta;
-				edges[0].twin().data().m_delta = edges[1].data().m_delta;
-				removedVertices = true;
+		}
+
+		double newDelta;
+		if (degree == 1) {
+			newDelta = 0;
+		} else if (degree >= 2) {
+			newDelta = secondHighestDelta;
+		} else {
+			continue;
+		}
+		if (deltas[highest.id()] > newDelta) {
+			deltas[highest.id()] = newDelta;
+			deltas[highest.twin().id()] = newDelta;
+			MsComplex::Vertex w = highest.destination();
+			if (!inWorklist[w.id()]) {
+				inWorklist[w.id()] = true;
+				worklist.push_back(w.id());
 			}
 		}
-	} while (removedVertices);
+	}
 }
 
 std::pair<double, MsComplex::HalfEdge>
-MsComplexSimplifier::computeSaddleSignificance(MsComplex::Vertex saddle) {
+MsComplexSimplifier::computeSaddleSignificance(
+        MsComplex::Vertex saddle, UnionFind& faceSets,
+        std::vector<std::optional<PiecewiseLinearFunction>>& mergedVolumeAbove) {
 	//if (saddle.data().isBoundarySaddle) {
 	//	return {0, saddle.outgoing()};
 	//}
@@ -125,11 +199,13 @@ MsComplexSimplifier::computeSaddleSignificance(MsComplex::Vertex saddle) {
 	
 	MsComplex::HalfEdge e1 = saddle.outgoing();
 	MsComplex::HalfEdge e2 = e1.nextOutgoing();
-	double volume1 = e1.incidentFace().data().volumeAbove(saddleHeight);
+	double volume1 =
+	        volumeAboveOf(faceSets.findSet(e1.incidentFace().id()), mergedVolumeAbove)(saddleHeight);
 	if (std::isnan(volume1)) {
 		volume1 = std::numeric_limits<double>::infinity();
 	}
-	double volume2 = e2.incidentFace().data().volumeAbove(saddleHeight);
+	double volume2 =
+	        volumeAboveOf(faceSets.findSet(e2.incidentFace().id()), mergedVolumeAbove)(saddleHeight);
 	if (std::isnan(volume2)) {
 		volume2 = std::numeric_limits<double>::infinity();
 	}
@@ -140,3 +216,12 @@ MsComplexSimplifier::computeSaddleSignificance(MsComplex::Vertex saddle) {
 		return {volume1, e2};
 	}
 }
+
+PiecewiseLinearFunction& MsComplexSimplifier::volumeAboveOf(
+        int representative,
+        std::vector<std::optional<PiecewiseLinearFunction>>& mergedVolumeAbove) {
+	if (mergedVolumeAbove[representative]) {
+		return *mergedVolumeAbove[representative];
+	}
+	return msc->face(representative).data().volumeAbove;
+}
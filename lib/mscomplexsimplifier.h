@@ -2,8 +2,12 @@
 #define MSCOMPLEXSIMPLIFIER_H
 
 #include <memory>
+#include <optional>
+#include <vector>
 
 #include "mscomplex.h"
+#include "piecewiselinearfunction.h"
+#include "unionfind.h"
 
 /**
  * Implementation of an algorithm that simplifies a Morse-Smale complex by
@@ -11,10 +15,16 @@
  * above the height of the saddle point on either side is below a given
  * threshold.
  *
- * Executing a simplification does not actually change the input Morse-Smale
- * complex. Instead it produces a list of δ-values `δ(e)` for each Morse-Smale
- * edge `e`. The network for any δ-value can then be reconstructed by dropping
+ * Executing a simplification does not actually change the topology of the
+ * input Morse-Smale complex. Instead it produces a list of δ-values `δ(e)` for
+ * each Morse-Smale edge `e`, which are stored in the edges of the input
+ * complex. The network for any δ-value can then be reconstructed by dropping
  * any edge `e` with `δ(e) < δ`.
+ *
+ * To keep track of which Morse-Smale faces have been merged while simulating
+ * the simplification, the simplifier doesn't copy the Morse-Smale complex, but
+ * uses a union-find structure on the face IDs and a sand function for every
+ * set of merged faces.
  */
 class MsComplexSimplifier {
 
@@ -26,7 +36,10 @@ class MsComplexSimplifier {
 		 *
 		 * \note Call simplify() to actually execute the simplification.
 		 *
-		 * \param msc The Morse-Smale complex to simplify.
+		 * \param msc The Morse-Smale complex to simplify. Its δ-values (see
+		 * MsHalfEdge::m_delta) and heaviest sides (see
+		 * MsVertex::m_heaviestSide) are overwritten by simplify() and
+		 * writeDeltas().
 		 * \param progressListener A function that is called when a progress
 		 * update is available.
 		 */
@@ -34,10 +47,50 @@ class MsComplexSimplifier {
 		                    std::function<void(int)> progressListener = nullptr);
 
 		/**
-		 * Simplifies the Morse-Smale complex.
+		 * Simplifies the Morse-Smale complex. This is the same as calling
+		 * computeDeltas() followed by writeDeltas().
 		 */
 		void simplify();
 
+		/**
+		 * Computes the δ-values and heaviest sides, without changing the
+		 * Morse-Smale complex. As this only reads the complex, it can run
+		 * while other threads are reading the complex too.
+		 */
+		void computeDeltas();
+
+		/**
+		 * Writes the δ-values and heaviest sides computed by computeDeltas()
+		 * into the Morse-Smale complex.
+		 */
+		void writeDeltas();
+
+		/**
+		 * Lowers the δ-values of the given Morse-Smale complex until no
+		 * vertex (except for vertices at height -∞) has a unique incident
+		 * edge with the highest δ-value, or a single incident edge with a
+		 * positive δ-value. Such edges lead to a dead end in the network for
+		 * δ-values above the other incident edges, so they are given the
+		 * second-highest δ-value (or 0 for a single edge).
+		 *
+		 * This is done using a worklist: after an edge's δ-value is lowered,
+		 * only its destination needs to be checked again, instead of
+		 * repeatedly checking all vertices until nothing changes.
+		 *
+		 * \param msc The Morse-Smale complex.
+		 */
+		static void propagateDeltas(MsComplex& msc);
+
+		/**
+		 * Like propagateDeltas(MsComplex&), but operates on the given
+		 * δ-values instead of those stored in the Morse-Smale complex, which
+		 * is not changed.
+		 *
+		 * \param msc The Morse-Smale complex.
+		 * \param deltas The δ-value of every half-edge, indexed by ID.
+		 */
+		static void propagateDeltas(MsComplex& msc, std::vector<double>& deltas);
+
 	private:
 
 		/**
@@ -49,6 +102,11 @@ class MsComplexSimplifier {
 		 * continue the simplification.
 		 *
 		 * \param saddle The saddle to check.
+		 * \param faceSets The union-find structure on the face IDs, tracking
+		 * which faces have been merged so far.
+		 * \param mergedVolumeAbove The sand function of every set of merged
+		 * faces, indexed by the ID of the representative (see
+		 * volumeAboveOf()).
 		 * \return A pair containing two elements:
 		 *
 		 *  * the minimum of the two
@@ -57,7 +115,23 @@ class MsComplexSimplifier {
 		 *    volume above `saddle`.
 		 */
 		std::pair<double, MsComplex::HalfEdge>
-		computeSaddleSignificance(MsComplex::Vertex saddle);
+		computeSaddleSignificance(
+		        MsComplex::Vertex saddle, UnionFind& faceSets,
+		        std::vector<std::optional<PiecewiseLinearFunction>>& mergedVolumeAbove);
+
+		/**
+		 * Returns the sand function of a set of merged faces. A face's own
+		 * sand function is only copied once another face is merged into it;
+		 * until then, the function stored in the Morse-Smale complex is used.
+		 *
+		 * \param representative The representative of the set.
+		 * \param mergedVolumeAbove The sand function of every set of faces
+		 * that another face has been merged into, indexed by the ID of the
+		 * representative.
+		 */
+		PiecewiseLinearFunction& volumeAboveOf(
+		        int representative,
+		        std::vector<std::optional<PiecewiseLinearFunction>>& mergedVolumeAbove);
 
 		/**
 		 * The Morse-Smale complex we need to compute the δ-values for.
@@ -65,10 +139,15 @@ class MsComplexSimplifier {
 		std::shared_ptr<MsComplex> msc;
 
 		/**
-		 * The Morse-Smale complex we're going to simplify (remove saddles
-		 * and edges from).
+		 * The δ-value of every half-edge, as computed by computeDeltas().
+		 */
+		std::vector<double> deltas;
+
+		/**
+		 * The heaviest side of every vertex (see MsVertex::m_heaviestSide),
+		 * as computed by computeDeltas().
 		 */
-		MsComplex mscCopy;
+		std::vector<int> heaviestSides;
 
 		/**
 		 * Calls the progress listener, if one is set.
@@ -40,6 +40,7 @@ MsToNetworkGraphCreator::create() {
 		networkGraph->addEdge(e.origin().id(), e.destination().id(), path,
 		                      delta);
 	}
+	networkGraph->buildDeltaIndex();
 
 	signalProgress(100);
 }
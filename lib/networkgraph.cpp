@@ -1,6 +1,8 @@
 #include "networkgraph.h"
 
 #include <algorithm>
+#include <cassert>
+#include <numeric>
 
 NetworkGraph::Vertex::Vertex(int id, Point p) :
     id(id), p(p) {
@@ -50,9 +52,33 @@ int NetworkGraph::addEdge(int from, int to, std::vector<Point> path,
 	return edgeIndex;
 }
 
-void NetworkGraph::filterOnDelta(double threshold) {
-	m_edges.erase(std::remove_if(m_edges.begin(), m_edges.end(),
-	                             [threshold](Edge e) {
-	                  return e.delta < threshold;
-	              }), m_edges.end());
+void NetworkGraph::buildDeltaIndex() {
+	m_edgesByDelta.resize(m_edges.size());
+	std::iota(m_edgesByDelta.begin(), m_edgesByDelta.end(), 0);
+	std::stable_sort(m_edgesByDelta.begin(), m_edgesByDelta.end(), [this](int e1, int e2) {
+		return m_edges[e1].delta < m_edges[e2].delta;
+	});
+}
+
+std::span<const int> NetworkGraph::edgesByDelta() const {
+	assert(m_edgesByDelta.size() == m_edges.size());
+	return m_edgesByDelta;
+}
+
+std::span<const int> NetworkGraph::edgesWithDeltaAtLeast(double threshold) const {
+	assert(m_edgesByDelta.size() == m_edges.size());
+	auto begin = std::partition_point(m_edgesByDelta.begin(), m_edgesByDelta.end(),
+	                                  [this, threshold](int e) {
+		return m_edges[e].delta < threshold;
+	});
+	return {begin, m_edgesByDelta.end()};
+}
+
+std::span<const int> NetworkGraph::edgesWithDeltaAbove(double threshold) const {
+	assert(m_edgesByDelta.size() == m_edges.size());
+	auto begin = std::partition_point(m_edgesByDelta.begin(), m_edgesByDelta.end(),
+	                                  [this, threshold](int e) {
+		return m_edges[e].delta <= threshold;
+	});
+	return {begin, m_edgesByDelta.end()};
 }
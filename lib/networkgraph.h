@@ -1,12 +1,18 @@
 #ifndef NETWORKGRAPH_H
 #define NETWORKGRAPH_H
 
+#include <span>
 #include <vector>
 
 #include "point.h"
 
 /**
  * A directed graph structure for the computed representative network.
+ *
+ * Besides the edges themselves, the graph stores an index of the edges sorted
+ * by δ-value, which allows retrieving the network for a given δ-threshold in
+ * O(log n) time. This index needs to be built by calling buildDeltaIndex()
+ * after all edges have been added.
  */
 class NetworkGraph {
 
@@ -157,12 +163,43 @@ class NetworkGraph {
 		            double delta = 0);
 
 		/**
-		 * Removes all edges that have a too low delta value.
+		 * Sorts the edges by δ-value, so that edgesByDelta(),
+		 * edgesWithDeltaAtLeast() and edgesWithDeltaAbove() can be used. This
+		 * needs to be called again after adding more edges.
+		 */
+		void buildDeltaIndex();
+
+		/**
+		 * Returns the IDs of all edges, sorted by increasing δ-value. (Edges
+		 * with the same δ-value are sorted by ID.)
+		 *
+		 * \note Requires buildDeltaIndex() to have been called.
+		 *
+		 * \return The edge IDs.
+		 */
+		std::span<const int> edgesByDelta() const;
+
+		/**
+		 * Returns the IDs of the edges with δ-value at least the given
+		 * threshold, sorted by increasing δ-value.
+		 *
+		 * \note Requires buildDeltaIndex() to have been called.
 		 *
-		 * \param threshold The threshold value to use. Every edge with a delta
-		 * value lower than this will be removed.
+		 * \param threshold The threshold.
+		 * \return The edge IDs, as a suffix of edgesByDelta().
 		 */
-		void filterOnDelta(double threshold);
+		std::span<const int> edgesWithDeltaAtLeast(double threshold) const;
+
+		/**
+		 * Returns the IDs of the edges with δ-value strictly larger than the
+		 * given threshold, sorted by increasing δ-value.
+		 *
+		 * \note Requires buildDeltaIndex() to have been called.
+		 *
+		 * \param threshold The threshold.
+		 * \return The edge IDs, as a suffix of edgesByDelta().
+		 */
+		std::span<const int> edgesWithDeltaAbove(double threshold) const;
 
 	private:
 
@@ -175,6 +212,11 @@ class NetworkGraph {
 		 * List of the edges.
 		 */
 		std::vector<Edge> m_edges;
+
+		/**
+		 * The IDs of the edges, sorted by δ-value.
+		 */
+		std::vector<int> m_edgesByDelta;
 };
 
 #endif // NETWORKGRAPH_H
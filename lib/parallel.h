@@ -0,0 +1,135 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Calls `f(i)` for every `i` in `[0, count)`, distributing the calls over
+ * the given number of threads.
+ *
+ * The range is split into `threadCount` contiguous chunks of (roughly) equal
+ * size, and each chunk is handled by its own thread, in increasing order of
+ * `i`. This function returns only after all calls have finished. If
+ * `threadCount` is at most 1, everything runs on the calling thread.
+ *
+ * \note The calls to `f` for different `i` may run concurrently, so `f` must
+ * not write to anything that another call reads or writes.
+ *
+ * \param count The number of indices.
+ * \param threadCount The number of threads to use.
+ * \param f The function to call for every index.
+ */
+template<typename F>
+void parallelFor(int count, int threadCount, F f) {
+	threadCount = std::min(threadCount, count);
+	if (threadCount <= 1) {
+		for (int i = 0; i < count; i++) {
+			f(i);
+		}
+		return;
+	}
+
+	auto runChunk = [count, threadCount, &f](int chunk) {
+		int begin = static_cast<long>(count) * chunk / threadCount;
+		int end = static_cast<long>(count) * (chunk + 1) / threadCount;
+		for (int i = begin; i < end; i++) {
+			f(i);
+		}
+	};
+	std::vector<std::thread> threads;
+	threads.reserve(threadCount - 1);
+	for (int chunk = 1; chunk < threadCount; chunk++) {
+		threads.emplace_back(runChunk, chunk);
+	}
+	runChunk(0);
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+}
+
+/**
+ * Calls `f(i)` for every `i` in `[0, count)`, distributing the calls over
+ * the given number of threads, like parallelFor(int, int, F), while reporting
+ * progress.
+ *
+ * The progress is reported on the calling thread (which does not call `f`
+ * itself if more than one thread is used), so `progress` does not need to be
+ * thread-safe.
+ *
+ * \param count The number of indices.
+ * \param threadCount The number of threads to use.
+ * \param f The function to call for every index.
+ * \param progress A function that is called with the percentage (in
+ * `[0, 100]`) of the indices that have been handled, whenever that
+ * percentage changes.
+ */
+template<typename F, typename P>
+void parallelFor(int count, int threadCount, F f, P progress) {
+	int reportedPercentage = -1;
+	auto report = [count, &progress, &reportedPercentage](int done) {
+		int percentage = count == 0 ? 100 : static_cast<long>(done) * 100 / count;
+		if (percentage != reportedPercentage) {
+			reportedPercentage = percentage;
+			progress(percentage);
+		}
+	};
+
+	threadCount = std::min(threadCount, count);
+	if (threadCount <= 1) {
+		for (int i = 0; i < count; i++) {
+			f(i);
+			report(i + 1);
+		}
+		report(count);
+		return;
+	}
+
+	std::atomic<int> done = 0;
+	std::mutex mutex;
+	std::condition_variable finished;
+	int running = threadCount;
+	auto runChunk = [count, threadCount, &f, &done, &mutex, &finished, &running](int chunk) {
+		int begin = static_cast<long>(count) * chunk / threadCount;
+		int end = static_cast<long>(count) * (chunk + 1) / threadCount;
+		for (int i = begin; i < end; i++) {
+			f(i);
+			done.fetch_add(1, std::memory_order_relaxed);
+		}
+		std::lock_guard<std::mutex> lock(mutex);
+		running--;
+		finished.notify_one();
+	};
+	std::vector<std::thread> threads;
+	threads.reserve(threadCount);
+	for (int chunk = 0; chunk < threadCount; chunk++) {
+		threads.emplace_back(runChunk, chunk);
+	}
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		while (running > 0) {
+			finished.wait_for(lock, std::chrono::milliseconds(100));
+			report(done.load(std::memory_order_relaxed));
+		}
+	}
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+	report(count);
+}
+
+/**
+ * Returns the default number of threads to use for parallel computations,
+ * which is the number of hardware threads (or 1 if that cannot be
+ * determined).
+ */
+inline int defaultThreadCount() {
+	return std::max(1u, std::thread::hardware_concurrency());
+}
+
+#endif // PARALLEL_H
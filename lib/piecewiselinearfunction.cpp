@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <iostream>
@@ -31,9 +32,15 @@ double LinearFunction::heightForVolume(double volume) {
 	return (volume - m_coefficients[0]) / m_coefficients[1];
 }
 
-PiecewiseLinearFunction::PiecewiseLinearFunction() :
-        m_breakpoints{},
-        m_functions{LinearFunction()} {
+PiecewiseLinearFunction::PiecewiseLinearFunction(std::pmr::memory_resource* resource) :
+        m_breakpoints(resource),
+        m_functions(1, LinearFunction(), resource) {
+}
+
+PiecewiseLinearFunction::PiecewiseLinearFunction(const PiecewiseLinearFunction& other,
+                                                 std::pmr::memory_resource* resource) :
+        m_breakpoints(other.m_breakpoints, resource),
+        m_functions(other.m_functions, resource) {
 }
 
 PiecewiseLinearFunction::PiecewiseLinearFunction(LinearFunction function) :
@@ -41,9 +48,9 @@ PiecewiseLinearFunction::PiecewiseLinearFunction(LinearFunction function) :
         m_functions{function} {
 }
 
-PiecewiseLinearFunction::PiecewiseLinearFunction(std::vector<double> breakpoints,
-                           std::vector<LinearFunction> functions) :
-        m_breakpoints(breakpoints), m_functions(functions) {
+PiecewiseLinearFunction::PiecewiseLinearFunction(std::pmr::vector<double> breakpoints,
+                                                 std::pmr::vector<LinearFunction> functions) :
+        m_breakpoints(std::move(breakpoints)), m_functions(std::move(functions)) {
 }
 
 PiecewiseLinearFunction::PiecewiseLinearFunction(Point p1) {
@@ -56,6 +63,45 @@ PiecewiseLinearFunction::PiecewiseLinearFunction(Point p1) {
 	m_functions = {LinearFunction{0.25 * p1.h, -0.25}, LinearFunction{}};
 }
 
+PiecewiseLinearFunction PiecewiseLinearFunction::sumOfPillars(std::pmr::vector<double> heights) {
+	heights.erase(std::remove_if(heights.begin(), heights.end(),
+	                             [](double h) {
+		                             return std::isnan(h);
+	                             }),
+	              heights.end());
+	std::sort(heights.begin(), heights.end());
+
+	int pillarCount = heights.size();
+	int breakpointCount = 0;
+	for (int i = 0; i < pillarCount; i++) {
+		if (i == 0 || heights[i] != heights[i - 1]) {
+			breakpointCount++;
+		}
+	}
+
+	// Walk down from the highest pillar, keeping track of the number of
+	// pillars above the current height and the sum of their heights. Below
+	// breakpoint b, the volume is 0.25 * (sum - count * h). The breakpoints
+	// are written to the back of the heights vector, which never overwrites
+	// heights we still need to read.
+	std::pmr::vector<LinearFunction> functions(breakpointCount + 1, heights.get_allocator());
+	int write = pillarCount;
+	int function = breakpointCount;
+	double sum = 0;
+	for (int i = pillarCount; i > 0;) {
+		double breakpoint = heights[i - 1];
+		while (i > 0 && heights[i - 1] == breakpoint) {
+			sum += breakpoint;
+			i--;
+		}
+		heights[--write] = breakpoint;
+		functions[--function] = LinearFunction{0.25 * sum, -0.25 * (pillarCount - i)};
+	}
+	heights.erase(heights.begin(), heights.begin() + write);
+
+	return PiecewiseLinearFunction(std::move(heights), std::move(functions));
+}
+
 LinearFunction PiecewiseLinearFunction::functionAt(double h) {
 
 	int i = std::distance(m_breakpoints.begin(),
@@ -73,6 +119,14 @@ double PiecewiseLinearFunction::operator()(double h) {
 	return value;
 }
 
+const std::pmr::vector<double>& PiecewiseLinearFunction::breakpoints() const {
+	return m_breakpoints;
+}
+
+const std::pmr::vector<LinearFunction>& PiecewiseLinearFunction::functions() const {
+	return m_functions;
+}
+
 void PiecewiseLinearFunction::output(std::ostream& out) {
 	out << "/" << std::endl;
 	out << "| " << m_functions[0] << "  if h < " << m_breakpoints[0] << std::endl;
@@ -83,41 +137,71 @@ void PiecewiseLinearFunction::output(std::ostream& out) {
 	out << "\\" << std::endl;
 }
 
-[[nodiscard]] PiecewiseLinearFunction PiecewiseLinearFunction::add(
+PiecewiseLinearFunction PiecewiseLinearFunction::add(
         const PiecewiseLinearFunction& other) const {
-	std::vector<double> breakpoints;
-	std::vector<LinearFunction> functions;
-	int i = 0;
-	int j = 0;
-
-	while (i < m_breakpoints.size() || j < other.m_breakpoints.size()) {
-		functions.push_back(m_functions[i].add(other.m_functions[j]));
-		if (j == other.m_breakpoints.size()
-		        || (i < m_breakpoints.size() &&
-		            m_breakpoints[i] < other.m_breakpoints[j])) {
-			breakpoints.push_back(m_breakpoints[i]);
-			i++;
-		} else {
-			breakpoints.push_back(other.m_breakpoints[j]);
-			j++;
-		}
-	}
-	functions.push_back(m_functions[i].add(other.m_functions[j]));
+	PiecewiseLinearFunction result = *this;
+	result += other;
+	return result;
+}
 
-	return PiecewiseLinearFunction(breakpoints, functions);
+PiecewiseLinearFunction& PiecewiseLinearFunction::operator+=(
+        const PiecewiseLinearFunction& other) {
+	addMultiple(other, 1);
+	return *this;
 }
 
 PiecewiseLinearFunction PiecewiseLinearFunction::subtract(
         const PiecewiseLinearFunction& other) const {
-	return add(other.multiply(-1));
+	PiecewiseLinearFunction result = *this;
+	result -= other;
+	return result;
+}
+
+PiecewiseLinearFunction& PiecewiseLinearFunction::operator-=(
+        const PiecewiseLinearFunction& other) {
+	addMultiple(other, -1);
+	return *this;
 }
 
 PiecewiseLinearFunction PiecewiseLinearFunction::multiply(double factor) const {
-	std::vector<LinearFunction> multipliedFunctions;
-	for (LinearFunction f : m_functions) {
-		multipliedFunctions.push_back(f.multiply(factor));
+	PiecewiseLinearFunction result = *this;
+	result *= factor;
+	return result;
+}
+
+PiecewiseLinearFunction& PiecewiseLinearFunction::operator*=(double factor) {
+	for (LinearFunction& f : m_functions) {
+		f = f.multiply(factor);
+	}
+	return *this;
+}
+
+void PiecewiseLinearFunction::addMultiple(const PiecewiseLinearFunction& other,
+                                          double factor) {
+	if (&other == this) {
+		*this *= 1 + factor;
+		return;
+	}
+
+	// merge the breakpoints from the back, so that the merged result can be
+	// written into our own vectors: the piece formed by our i-th and other's
+	// j-th function ends up at position i + j, which is never before any
+	// position we still need to read
+	int i = m_breakpoints.size();
+	int j = other.m_breakpoints.size();
+	m_breakpoints.resize(i + j);
+	m_functions.resize(i + j + 1);
+	m_functions[i + j] = m_functions[i].add(other.m_functions[j].multiply(factor));
+	while (i > 0 || j > 0) {
+		if (j == 0 || (i > 0 && m_breakpoints[i - 1] >= other.m_breakpoints[j - 1])) {
+			m_breakpoints[i + j - 1] = m_breakpoints[i - 1];
+			i--;
+		} else {
+			m_breakpoints[i + j - 1] = other.m_breakpoints[j - 1];
+			j--;
+		}
+		m_functions[i + j] = m_functions[i].add(other.m_functions[j].multiply(factor));
 	}
-	return PiecewiseLinearFunction(m_breakpoints, multipliedFunctions);
 }
 
 void PiecewiseLinearFunction::prune(double h) {
@@ -2,6 +2,7 @@
 #define PIECEWISECUBICFUNCTION_H
 
 #include <array>
+#include <memory_resource>
 #include <vector>
 
 #include "point.h"
@@ -95,6 +96,14 @@ class LinearFunction {
 /**
  * A piecewise linear function that consists of a sequence of linear functions,
  * with breakpoints between them.
+ *
+ * The breakpoints and functions are stored in memory obtained from a
+ * `std::pmr::memory_resource`. By default this is the default memory
+ * resource, but a function can be put in another one (for example, a
+ * `std::pmr::monotonic_buffer_resource` serving as an arena for a whole
+ * computation) by passing it to the constructor. Copies made with the copy
+ * constructor use the default resource again; assigning to a function keeps
+ * its resource.
  */
 class PiecewiseLinearFunction {
 
@@ -102,8 +111,26 @@ class PiecewiseLinearFunction {
 
 		/**
 		 * Creates a piecewise linear function that evaluates to zero everywhere.
+		 *
+		 * \param resource The memory resource to allocate from.
+		 */
+		explicit PiecewiseLinearFunction(
+		    std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+		/**
+		 * Creates a copy of the given piecewise linear function that allocates
+		 * from the given memory resource.
+		 *
+		 * \param other The function to copy.
+		 * \param resource The memory resource to allocate from.
 		 */
-		PiecewiseLinearFunction();
+		PiecewiseLinearFunction(const PiecewiseLinearFunction& other,
+		                        std::pmr::memory_resource* resource);
+
+		PiecewiseLinearFunction(const PiecewiseLinearFunction& other) = default;
+		PiecewiseLinearFunction(PiecewiseLinearFunction&& other) = default;
+		PiecewiseLinearFunction& operator=(const PiecewiseLinearFunction& other) = default;
+		PiecewiseLinearFunction& operator=(PiecewiseLinearFunction&& other) = default;
 
 		/**
 		 * Creates a piecewise linear function that is defined by just one
@@ -122,8 +149,8 @@ class PiecewiseLinearFunction {
 		 * the function used for `h < breakpoints[0]`, `functions[1]` is the
 		 * function used for `breakpoints[0] < h < breakpoints[1]`, and so on.
 		 */
-		PiecewiseLinearFunction(std::vector<double> breakpoints,
-		             std::vector<LinearFunction> functions);
+		PiecewiseLinearFunction(std::pmr::vector<double> breakpoints,
+		                        std::pmr::vector<LinearFunction> functions);
 
 		/**
 		 * Creates a piecewise linear function representing the volume above
@@ -133,6 +160,20 @@ class PiecewiseLinearFunction {
 		 */
 		PiecewiseLinearFunction(Point p);
 
+		/**
+		 * Creates a piecewise linear function representing the total volume
+		 * above height *h* of a set of quarter pillars with the given heights.
+		 * This is equivalent to (but much faster than) adding the functions
+		 * created by PiecewiseLinearFunction(Point) for every height.
+		 *
+		 * Heights that are NaN are ignored. Equal heights result in a single
+		 * breakpoint.
+		 *
+		 * \param heights The heights of the pillars, in any order.
+		 * \return The resulting function.
+		 */
+		static PiecewiseLinearFunction sumOfPillars(std::pmr::vector<double> heights);
+
 		/**
 		 * Evaluates the function at a certain *h*-value.
 		 *
@@ -158,6 +199,19 @@ class PiecewiseLinearFunction {
 		 */
 		LinearFunction functionAt(double h);
 
+		/**
+		 * Returns the list of breakpoints, in ascending order.
+		 */
+		const std::pmr::vector<double>& breakpoints() const;
+
+		/**
+		 * Returns the list of linear functions, where `functions()[0]` is the
+		 * function used for `h <= breakpoints()[0]`, `functions()[1]` is the
+		 * function used for `breakpoints()[0] < h <= breakpoints()[1]`, and
+		 * so on. This list is always one longer than breakpoints().
+		 */
+		const std::pmr::vector<LinearFunction>& functions() const;
+
 		/**
 		 * Adds a function to this function and returns the result.
 		 *
@@ -166,6 +220,16 @@ class PiecewiseLinearFunction {
 		 */
 		[[nodiscard]] PiecewiseLinearFunction add(const PiecewiseLinearFunction& other) const;
 
+		/**
+		 * Adds a function to this function, in place. This does not allocate
+		 * any memory if this function has enough capacity to store the
+		 * breakpoints of both functions.
+		 *
+		 * \param other The function to add.
+		 * \return This function.
+		 */
+		PiecewiseLinearFunction& operator+=(const PiecewiseLinearFunction& other);
+
 		/**
 		 * Subtracts a function to this function and returns the result.
 		 *
@@ -174,6 +238,15 @@ class PiecewiseLinearFunction {
 		 */
 		[[nodiscard]] PiecewiseLinearFunction subtract(const PiecewiseLinearFunction& other) const;
 
+		/**
+		 * Subtracts a function from this function, in place, like
+		 * `operator+=`.
+		 *
+		 * \param other The function to subtract.
+		 * \return This function.
+		 */
+		PiecewiseLinearFunction& operator-=(const PiecewiseLinearFunction& other);
+
 		/**
 		 * Multiplies this function by a factor and returns the result.
 		 *
@@ -182,6 +255,14 @@ class PiecewiseLinearFunction {
 		 */
 		[[nodiscard]] PiecewiseLinearFunction multiply(double factor) const;
 
+		/**
+		 * Multiplies this function by a factor, in place.
+		 *
+		 * \param factor The factor to multiply by.
+		 * \return This function.
+		 */
+		PiecewiseLinearFunction& operator*=(double factor);
+
 		/**
 		 * Prunes the piecewise function by removing pieces above the given
 		 * *h*-value. After pruning, calling the function with a parameter
@@ -212,17 +293,25 @@ class PiecewiseLinearFunction {
 
 	private:
 
+		/**
+		 * Adds `factor` times the given function to this function, in place.
+		 *
+		 * \param other The function to add.
+		 * \param factor The factor to multiply `other` by.
+		 */
+		void addMultiple(const PiecewiseLinearFunction& other, double factor);
+
 		/**
 		 * The list of breakpoints, in ascending order.
 		 */
-		std::vector<double> m_breakpoints;
+		std::pmr::vector<double> m_breakpoints;
 
 		/**
 		 * The list of functions, where `functions[0]` is the function used for
 		 * `h < breakpoints[0]`, `functions[1]` is the function used for
 		 * `breakpoints[0] < h < breakpoints[1]`, and so on.
 		 */
-		std::vector<LinearFunction> m_functions;
+		std::pmr::vector<LinearFunction> m_functions;
 };
 
 #endif // PIECEWISECUBICFUNCTION_H
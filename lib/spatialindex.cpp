@@ -0,0 +1,168 @@
+#include "spatialindex.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+static bool isFinite(const SpatialIndex::Box& box) {
+	return std::isfinite(box.xMin) && std::isfinite(box.yMin) && std::isfinite(box.xMax) &&
+	       std::isfinite(box.yMax);
+}
+
+/// A box that contains nothing, to be extended with extend().
+static SpatialIndex::Box emptyBox() {
+	double inf = std::numeric_limits<double>::infinity();
+	return SpatialIndex::Box{inf, inf, -inf, -inf};
+}
+
+static void extend(SpatialIndex::Box& box, Point p) {
+	box.xMin = std::min(box.xMin, p.x);
+	box.yMin = std::min(box.yMin, p.y);
+	box.xMax = std::max(box.xMax, p.x);
+	box.yMax = std::max(box.yMax, p.y);
+}
+
+SpatialIndex::SpatialIndex() = default;
+
+SpatialIndex::SpatialIndex(const std::vector<Box>& items, double tileSize) :
+    m_itemCount(items.size()), m_tileSize(tileSize) {
+	m_bounds = emptyBox();
+	for (const Box& item : items) {
+		if (isFinite(item)) {
+			m_bounds.xMin = std::min(m_bounds.xMin, item.xMin);
+			m_bounds.yMin = std::min(m_bounds.yMin, item.yMin);
+			m_bounds.xMax = std::max(m_bounds.xMax, item.xMax);
+			m_bounds.yMax = std::max(m_bounds.yMax, item.yMax);
+		}
+	}
+	if (m_bounds.xMin > m_bounds.xMax) {
+		// no finite items
+		m_bounds = Box{0, 0, 0, 0};
+		m_tileStart = {0};
+		return;
+	}
+	m_columns = std::floor((m_bounds.xMax - m_bounds.xMin) / m_tileSize) + 1;
+	m_rows = std::floor((m_bounds.yMax - m_bounds.yMin) / m_tileSize) + 1;
+
+	// first count the items per tile, then put them in place
+	std::vector<int> counts(m_columns * m_rows + 1, 0);
+	for (const Box& item : items) {
+		if (!isFinite(item)) {
+			continue;
+		}
+		for (int r = row(item.yMin); r <= row(item.yMax); r++) {
+			for (int c = column(item.xMin); c <= column(item.xMax); c++) {
+				counts[r * m_columns + c]++;
+			}
+		}
+	}
+	m_tileStart.resize(counts.size());
+	int total = 0;
+	for (int tile = 0; tile < counts.size(); tile++) {
+		m_tileStart[tile] = total;
+		total += counts[tile];
+	}
+	m_items.resize(total);
+	std::vector<int> next(m_tileStart.begin(), m_tileStart.end() - 1);
+	for (int i = 0; i < items.size(); i++) {
+		const Box& item = items[i];
+		if (!isFinite(item)) {
+			continue;
+		}
+		for (int r = row(item.yMin); r <= row(item.yMax); r++) {
+			for (int c = column(item.xMin); c <= column(item.xMax); c++) {
+				m_items[next[r * m_columns + c]++] = i;
+			}
+		}
+	}
+}
+
+std::vector<int> SpatialIndex::query(const Box& region) const {
+	std::vector<int> result;
+	if (m_items.empty() || region.xMax < m_bounds.xMin || region.xMin > m_bounds.xMax ||
+	    region.yMax < m_bounds.yMin || region.yMin > m_bounds.yMax) {
+		return result;
+	}
+	for (int r = row(region.yMin); r <= row(region.yMax); r++) {
+		for (int c = column(region.xMin); c <= column(region.xMax); c++) {
+			int tile = r * m_columns + c;
+			result.insert(result.end(), m_items.begin() + m_tileStart[tile],
+			              m_items.begin() + m_tileStart[tile + 1]);
+		}
+	}
+	// within a tile the items are already sorted, but items from different
+	// tiles are interleaved and can occur in more than one tile
+	std::sort(result.begin(), result.end());
+	result.erase(std::unique(result.begin(), result.end()), result.end());
+	return result;
+}
+
+int SpatialIndex::itemCount() const {
+	return m_itemCount;
+}
+
+int SpatialIndex::column(double x) const {
+	int c = std::floor((x - m_bounds.xMin) / m_tileSize);
+	return std::clamp(c, 0, m_columns - 1);
+}
+
+int SpatialIndex::row(double y) const {
+	int r = std::floor((y - m_bounds.yMin) / m_tileSize);
+	return std::clamp(r, 0, m_rows - 1);
+}
+
+SpatialIndex SpatialIndex::ofVertices(InputDcel& dcel) {
+	std::vector<Box> items(dcel.vertexCount());
+	for (int i = 0; i < dcel.vertexCount(); i++) {
+		Point p = dcel.vertex(i).data().p;
+		items[i] = Box{p.x, p.y, p.x, p.y};
+	}
+	return SpatialIndex(items, 16);
+}
+
+SpatialIndex SpatialIndex::ofHalfEdges(InputDcel& dcel) {
+	std::vector<Box> items(dcel.halfEdgeCount());
+	for (int i = 0; i < dcel.halfEdgeCount(); i++) {
+		InputDcel::HalfEdge e = dcel.halfEdge(i);
+		items[i] = emptyBox();
+		extend(items[i], e.origin().data().p);
+		extend(items[i], e.destination().data().p);
+	}
+	return SpatialIndex(items, 16);
+}
+
+SpatialIndex SpatialIndex::ofFaces(InputDcel& dcel) {
+	std::vector<Box> items(dcel.faceCount());
+	for (int i = 0; i < dcel.faceCount(); i++) {
+		items[i] = emptyBox();
+		dcel.face(i).forAllBoundaryVertices([&items, i](InputDcel::Vertex v) {
+			extend(items[i], v.data().p);
+		});
+	}
+	return SpatialIndex(items, 16);
+}
+
+SpatialIndex SpatialIndex::ofSaddleEdges(MsComplex& msc) {
+	std::vector<Box> items(msc.halfEdgeCount());
+	for (int i = 0; i < msc.halfEdgeCount(); i++) {
+		MsComplex::HalfEdge e = msc.halfEdge(i);
+		items[i] = emptyBox();
+		if (e.origin().data().type != VertexType::saddle) {
+			continue;
+		}
+		extend(items[i], e.origin().data().p);
+		extend(items[i], e.destination().data().p);
+		if (!e.data().m_dcelPath.empty()) {
+			e.data().m_dcelPath.forAllVertices([&items, i](InputDcel::Vertex v) {
+				extend(items[i], v.data().p);
+			});
+		}
+	}
+	return SpatialIndex(items, 16);
+}
+
+InputDcelIndex::InputDcelIndex(InputDcel& dcel) :
+    vertices(SpatialIndex::ofVertices(dcel)),
+    halfEdges(SpatialIndex::ofHalfEdges(dcel)),
+    faces(SpatialIndex::ofFaces(dcel)) {
+}
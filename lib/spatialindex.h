@@ -0,0 +1,120 @@
+#ifndef SPATIALINDEX_H
+#define SPATIALINDEX_H
+
+#include <vector>
+
+#include "inputdcel.h"
+#include "mscomplex.h"
+
+/**
+ * A static index that buckets items by the square tiles of a uniform grid,
+ * so that the items near a given rectangle can be found without iterating
+ * over all items.
+ *
+ * Items are identified by their position in the list of bounding boxes the
+ * index is built from. An item is stored in every tile its bounding box
+ * overlaps. The tiles are stored contiguously (each tile is a range in one
+ * array of item IDs), so building the index needs only two passes over the
+ * items.
+ */
+class SpatialIndex {
+
+	public:
+
+		/// An axis-aligned rectangle.
+		struct Box {
+			double xMin;
+			double yMin;
+			double xMax;
+			double yMax;
+		};
+
+		/**
+		 * Creates an empty index.
+		 */
+		SpatialIndex();
+
+		/**
+		 * Builds an index of the given items.
+		 *
+		 * \param items The bounding box of each item. Items with non-finite
+		 * coordinates are not stored in the index.
+		 * \param tileSize The side length of the tiles.
+		 */
+		SpatialIndex(const std::vector<Box>& items, double tileSize);
+
+		/**
+		 * Returns the IDs of all items whose tiles overlap the given region.
+		 * This includes all items whose bounding box overlaps the region,
+		 * but may include some more items close to it.
+		 *
+		 * \param region The region to query.
+		 * \return The item IDs, sorted in increasing order and without
+		 * duplicates.
+		 */
+		std::vector<int> query(const Box& region) const;
+
+		/**
+		 * Returns the number of items the index was built from.
+		 */
+		int itemCount() const;
+
+		/**
+		 * Builds an index of the vertices of an InputDcel.
+		 */
+		static SpatialIndex ofVertices(InputDcel& dcel);
+		/**
+		 * Builds an index of the half-edges of an InputDcel, using the
+		 * bounding boxes of their endpoints.
+		 */
+		static SpatialIndex ofHalfEdges(InputDcel& dcel);
+		/**
+		 * Builds an index of the faces of an InputDcel, using the bounding
+		 * boxes of their boundary vertices.
+		 */
+		static SpatialIndex ofFaces(InputDcel& dcel);
+		/**
+		 * Builds an index of the half-edges of a Morse-Smale complex that
+		 * start at a saddle, using the bounding boxes of their InputDcel
+		 * paths. The other half-edges are not stored in the index.
+		 */
+		static SpatialIndex ofSaddleEdges(MsComplex& msc);
+
+	private:
+
+		/// Returns the tile column containing `x`, clamped to the grid.
+		int column(double x) const;
+		/// Returns the tile row containing `y`, clamped to the grid.
+		int row(double y) const;
+
+		/// The number of items.
+		int m_itemCount = 0;
+		/// The area covered by the tiles.
+		Box m_bounds{0, 0, 0, 0};
+		double m_tileSize = 1;
+		int m_columns = 0;
+		int m_rows = 0;
+		/// For each tile (in row-major order), the position of its first item
+		/// in m_items; followed by the total number of stored items.
+		std::vector<int> m_tileStart;
+		/// The item IDs, grouped by tile.
+		std::vector<int> m_items;
+};
+
+/**
+ * Spatial indices of the elements of an InputDcel, used to draw only the
+ * elements in view.
+ */
+struct InputDcelIndex {
+
+	/**
+	 * Builds the indices of the given InputDcel.
+	 */
+	explicit InputDcelIndex(InputDcel& dcel);
+
+	SpatialIndex vertices;
+	SpatialIndex halfEdges;
+	SpatialIndex faces;
+};
+
+#endif // SPATIALINDEX_H
@@ -20,11 +20,18 @@ void UnionFind::set(int p, UnionFindNode node) {
 }
 
 int UnionFind::findSet(int p) {
-	UnionFindNode &x = get(p);
-	if (p != x.parent) {
-		x.parent = findSet(x.parent);
+	// find the representative first, and then compress the path (iteratively,
+	// as the path can be very long without the rank heuristic)
+	int representative = p;
+	while (get(representative).parent != representative) {
+		representative = get(representative).parent;
 	}
-	return x.parent;
+	while (p != representative) {
+		int parent = get(p).parent;
+		get(p).parent = representative;
+		p = parent;
+	}
+	return representative;
 }
 
 void UnionFind::merge(int p1, int p2) {
@@ -0,0 +1,182 @@
+#include "catch.hpp"
+
+#include <QImage>
+#include <QString>
+
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+
+#include "io/binaryheightmapreader.h"
+#include "io/binaryheightmapwriter.h"
+#include "io/heightmapcache.h"
+#include "units.h"
+
+/// Creates a 7x5 heightmap with some nodata values.
+static HeightMap testHeightMap() {
+	HeightMap heightMap(7, 5);
+	for (int y = 0; y < 5; y++) {
+		for (int x = 0; x < 7; x++) {
+			if ((x + y) % 4 != 0) {
+				heightMap.setElevationAt(x, y, x * 10 + y + 0.25);
+			}
+		}
+	}
+	return heightMap;
+}
+
+static void checkEqual(const HeightMap& actual, const HeightMap& expected) {
+	REQUIRE(actual.width() == expected.width());
+	REQUIRE(actual.height() == expected.height());
+	for (int y = 0; y < expected.height(); y++) {
+		for (int x = 0; x < expected.width(); x++) {
+			if (std::isnan(expected.elevationAt(x, y))) {
+				CHECK(std::isnan(actual.elevationAt(x, y)));
+			} else {
+				CHECK(actual.elevationAt(x, y) == expected.elevationAt(x, y));
+			}
+		}
+	}
+}
+
+TEST_CASE("writing and reading a binary heightmap file") {
+	HeightMap heightMap = testHeightMap();
+	QString fileName = QString::fromStdString(
+	    (std::filesystem::temp_directory_path() / "topotide-test-heightmap.tthm").string());
+	Units units(2.5, 4.0);
+
+	SECTION("double precision, not tiled") {
+		REQUIRE(BinaryHeightMapWriter::writeBinaryFile(heightMap, fileName, units));
+	}
+	SECTION("single precision, not tiled") {
+		REQUIRE(BinaryHeightMapWriter::writeBinaryFile(
+		    heightMap, fileName, units, BinaryHeightMapWriter::Precision::SINGLE));
+	}
+	SECTION("double precision, tiled") {
+		REQUIRE(BinaryHeightMapWriter::writeBinaryFile(
+		    heightMap, fileName, units, BinaryHeightMapWriter::Precision::DOUBLE, 3));
+	}
+	SECTION("single precision, tiled") {
+		REQUIRE(BinaryHeightMapWriter::writeBinaryFile(
+		    heightMap, fileName, units, BinaryHeightMapWriter::Precision::SINGLE, 4));
+	}
+
+	QString error;
+	Units readUnits;
+	HeightMap result = BinaryHeightMapReader::readBinaryFile(fileName, error, readUnits);
+	std::filesystem::remove(fileName.toStdString());
+	CHECK(error == "");
+	CHECK(readUnits.m_xResolution == 2.5);
+	CHECK(readUnits.m_yResolution == 4.0);
+	// the test values are exactly representable as floats
+	checkEqual(result, heightMap);
+}
+
+/// Overwrites the bytes at the given offset in a file.
+static void patchFile(const QString& fileName, std::streamoff offset, const char* bytes,
+                      int count) {
+	std::fstream file(fileName.toStdString(), std::ios::in | std::ios::out | std::ios::binary);
+	file.seekp(offset);
+	file.write(bytes, count);
+}
+
+/// Overwrites the 32-bit little-endian integer at the given offset in a file.
+static void patchInt(const QString& fileName, std::streamoff offset, uint32_t value) {
+	char bytes[4];
+	for (int i = 0; i < 4; i++) {
+		bytes[i] = static_cast<char>(value >> (8 * i));
+	}
+	patchFile(fileName, offset, bytes, 4);
+}
+
+TEST_CASE("reading incorrect binary heightmap files") {
+	QString error;
+	Units units;
+	HeightMap heightMap;
+
+	SECTION("text file") {
+		heightMap = BinaryHeightMapReader::readBinaryFile(
+		    "data/test/esri-grid-correct.ascii", error, units);
+	}
+	SECTION("non-existing file") {
+		heightMap = BinaryHeightMapReader::readBinaryFile(
+		    "data/test/binary-non-existing-file.tthm", error, units);
+	}
+	CHECK(heightMap.isEmpty());
+	CHECK(error.size() > 0);
+}
+
+TEST_CASE("reading corrupted binary heightmap files") {
+	QString fileName = QString::fromStdString(
+	    (std::filesystem::temp_directory_path() / "topotide-test-corrupted.tthm").string());
+	REQUIRE(BinaryHeightMapWriter::writeBinaryFile(
+	    testHeightMap(), fileName, Units(1.0, 1.0), BinaryHeightMapWriter::Precision::DOUBLE,
+	    3));
+
+	SECTION("wrong version") {
+		patchInt(fileName, 8, BinaryHeightMapReader::version + 1);
+	}
+	SECTION("value size other than 4 or 8") {
+		patchInt(fileName, 12, 2);
+	}
+	SECTION("tile width without tile height") {
+		patchInt(fileName, 28, 0);
+	}
+	SECTION("tile size that does not match the data size") {
+		patchInt(fileName, 24, 4);
+		patchInt(fileName, 28, 4);
+	}
+	SECTION("huge width and height") {
+		patchInt(fileName, 16, 0x7fffffff);
+		patchInt(fileName, 20, 0x7fffffff);
+	}
+	SECTION("truncated data") {
+		std::filesystem::resize_file(
+		    fileName.toStdString(),
+		    std::filesystem::file_size(fileName.toStdString()) - sizeof(double));
+	}
+
+	QString error;
+	Units units;
+	HeightMap heightMap = BinaryHeightMapReader::readBinaryFile(fileName, error, units);
+	std::filesystem::remove(fileName.toStdString());
+	CHECK(heightMap.isEmpty());
+	CHECK(error.size() > 0);
+}
+
+TEST_CASE("caching heightmaps") {
+	std::filesystem::path directory =
+	    std::filesystem::temp_directory_path() / "topotide-test-heightmap-cache";
+	std::filesystem::path source = directory / "source.txt";
+	std::filesystem::create_directories(directory);
+	std::ofstream(source) << "some DEM";
+	QString sourceFileName = QString::fromStdString(source.string());
+
+	HeightMapCache cache(QString::fromStdString((directory / "cache").string()));
+	Units units;
+	CHECK(cache.read(sourceFileName, units).isEmpty());
+
+	HeightMap heightMap = testHeightMap();
+	REQUIRE(cache.write(sourceFileName, heightMap, Units(2.0, 3.0)));
+	HeightMap cached = cache.read(sourceFileName, units);
+	checkEqual(cached, heightMap);
+	CHECK(units.m_xResolution == 2.0);
+	CHECK(units.m_yResolution == 3.0);
+
+	// changing the source file invalidates the entry
+	std::ofstream(source) << "some other DEM";
+	CHECK(cache.read(sourceFileName, units).isEmpty());
+
+	// writing the new entry removes the old one
+	REQUIRE(cache.write(sourceFileName, heightMap, Units(2.0, 3.0)));
+	CHECK(!cache.read(sourceFileName, units).isEmpty());
+	int entryCount = 0;
+	for (const auto& entry : std::filesystem::directory_iterator(directory / "cache")) {
+		CHECK(entry.path().extension() == ".tthm");
+		entryCount++;
+	}
+	CHECK(entryCount == 1);
+
+	std::filesystem::remove_all(directory);
+}
@@ -3,6 +3,10 @@
 #include <QImage>
 #include <QString>
 
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+
 #include "io/esrigridreader.h"
 #include "units.h"
 
@@ -17,10 +21,82 @@ TEST_CASE("reading a correct Esri grid file") {
 	SECTION("comma as decimal separator") {
 		heightMap = EsriGridReader::readGridFile("data/test/esri-grid-correct-with-comma.ascii", error, units);
 	}
-	CHECK(!heightMap.isEmpty());
+	REQUIRE(!heightMap.isEmpty());
 	CHECK(error == "");
 	CHECK(units.m_xResolution == 50.0);
 	CHECK(units.m_yResolution == 50.0);
+	CHECK(heightMap.width() == 4);
+	CHECK(heightMap.height() == 6);
+	CHECK(std::isnan(heightMap.elevationAt(0, 0)));
+	CHECK(heightMap.elevationAt(2, 0) == 5);
+	CHECK(heightMap.elevationAt(1, 1) == 20);
+	CHECK(heightMap.elevationAt(2, 5) == 1);
+	CHECK(std::isnan(heightMap.elevationAt(3, 5)));
+}
+
+TEST_CASE("reading an Esri grid file with a comma only in the elevation values") {
+	QString error;
+	Units units;
+	HeightMap heightMap = EsriGridReader::readGridFile(
+	    "data/test/esri-grid-comma-in-body.ascii", error, units);
+	REQUIRE(!heightMap.isEmpty());
+	CHECK(error == "");
+	CHECK(units.m_xResolution == 50.0);
+	REQUIRE(heightMap.width() == 4);
+	REQUIRE(heightMap.height() == 2);
+	CHECK(heightMap.elevationAt(0, 0) == 1.5);
+	CHECK(heightMap.elevationAt(1, 0) == 2.25);
+	CHECK(std::isnan(heightMap.elevationAt(2, 0)));
+	CHECK(heightMap.elevationAt(1, 1) == 6.75);
+	CHECK(heightMap.elevationAt(3, 1) == 8.5);
+}
+
+TEST_CASE("reading a large Esri grid file with multiple threads") {
+	// values are written with a varying number of values per line, to check
+	// that rows do not need to correspond to lines
+	const int width = 300;
+	const int height = 200;
+	std::filesystem::path path =
+	        std::filesystem::temp_directory_path() / "topotide-test-esri-grid.ascii";
+	{
+		std::ofstream out(path);
+		out << "ncols " << width << "\nnrows " << height << "\n"
+		    << "xllcorner 0.0\nyllcorner 0.0\ncellsize 2.5\nNODATA_value -9999\n";
+		for (int i = 0; i < width * height; i++) {
+			if (i % 7 == 3) {
+				out << "-9999";
+			} else {
+				out << (i % 1000) << "." << (i % 4) * 25;
+			}
+			out << (i % 13 == 0 ? "\n" : " ");
+		}
+	}
+
+	QString error;
+	Units units;
+	HeightMap sequential = EsriGridReader::readGridFile(
+	    QString::fromStdString(path.string()), error, units, 1);
+	HeightMap parallel = EsriGridReader::readGridFile(
+	    QString::fromStdString(path.string()), error, units, 4);
+	std::filesystem::remove(path);
+
+	REQUIRE(!sequential.isEmpty());
+	REQUIRE(!parallel.isEmpty());
+	CHECK(error == "");
+	CHECK(units.m_xResolution == 2.5);
+	REQUIRE(parallel.width() == width);
+	REQUIRE(parallel.height() == height);
+	for (int y = 0; y < height; y++) {
+		for (int x = 0; x < width; x++) {
+			int i = y * width + x;
+			if (i % 7 == 3) {
+				CHECK(std::isnan(parallel.elevationAt(x, y)));
+			} else {
+				CHECK(parallel.elevationAt(x, y) == (i % 1000) + (i % 4) * 0.25);
+			}
+		}
+	}
+	CHECK(sequential.elevationAt(150, 100) == parallel.elevationAt(150, 100));
 }
 
 TEST_CASE("reading incorrect Esri grid files") {
@@ -60,6 +136,10 @@ TEST_CASE("reading incorrect Esri grid files") {
 		heightMap = EsriGridReader::readGridFile(
 		    "data/test/esri-grid-premature-eof.ascii", error, units);
 	}
+	SECTION("elevation value with two signs") {
+		heightMap = EsriGridReader::readGridFile(
+		    "data/test/esri-grid-double-sign.ascii", error, units);
+	}
 	SECTION("non-existing file") {
 		heightMap = EsriGridReader::readGridFile(
 		    "data/test/esri-grid-non-existing-file.ascii", error, units);
@@ -3,6 +3,8 @@
 #include <QImage>
 #include <QString>
 
+#include <cmath>
+
 #include "io/gdalreader.h"
 #include "units.h"
 
@@ -23,6 +25,37 @@ TEST_CASE("reading a correct Esri grid file with GDAL") {
 	//CHECK(units.m_yResolution == 50.0);
 }
 
+TEST_CASE("reading a window of an Esri grid file with GDAL") {
+	QString error;
+	Units units;
+	HeightMap full = GdalReader::readGdalFile("data/test/esri-grid-correct.ascii", error, units);
+	REQUIRE(!full.isEmpty());
+
+	SECTION("window inside the raster") {
+		HeightMap windowed = GdalReader::readGdalFile(
+		    "data/test/esri-grid-correct.ascii", error, units, 2,
+		    GdalReader::Window{1, 2, 2, 3});
+		REQUIRE(windowed.width() == full.width());
+		REQUIRE(windowed.height() == full.height());
+		for (int y = 0; y < full.height(); y++) {
+			for (int x = 0; x < full.width(); x++) {
+				if (x >= 1 && x < 3 && y >= 2 && y < 5) {
+					CHECK(windowed.elevationAt(x, y) == full.elevationAt(x, y));
+				} else {
+					CHECK(std::isnan(windowed.elevationAt(x, y)));
+				}
+			}
+		}
+	}
+	SECTION("window outside the raster") {
+		HeightMap windowed = GdalReader::readGdalFile(
+		    "data/test/esri-grid-correct.ascii", error, units, 1,
+		    GdalReader::Window{2, 2, 3, 3});
+		CHECK(windowed.isEmpty());
+		CHECK(error.size() > 0);
+	}
+}
+
 TEST_CASE("reading incorrect Esri grid files with GDAL") {
 	HeightMap heightMap;
 	QString error = "";
@@ -0,0 +1,64 @@
+#include "catch.hpp"
+
+#include <QImage>
+#include <QString>
+
+#include "io/textfilereader.h"
+#include "units.h"
+
+TEST_CASE("reading a correct text file") {
+	QString error;
+	Units units;
+	HeightMap heightMap = TextFileReader::readTextFile("data/test/text-correct.txt", error, units);
+
+	REQUIRE(!heightMap.isEmpty());
+	CHECK(error == "");
+	CHECK(units.m_xResolution == 2.5);
+	CHECK(units.m_yResolution == 4.0);
+	CHECK(heightMap.width() == 3);
+	CHECK(heightMap.height() == 2);
+	CHECK(heightMap.elevationAt(0, 0) == 1);
+	CHECK(heightMap.elevationAt(2, 0) == 3);
+	CHECK(heightMap.elevationAt(0, 1) == 4);
+	CHECK(heightMap.elevationAt(1, 1) == 5.5);
+}
+
+TEST_CASE("reading incorrect text files") {
+	HeightMap heightMap;
+	QString error = "";
+	Units units;
+
+	SECTION("non-integral width") {
+		heightMap = TextFileReader::readTextFile(
+		    "data/test/text-non-integral-width.txt", error, units);
+	}
+	SECTION("premature end of file") {
+		heightMap = TextFileReader::readTextFile(
+		    "data/test/text-premature-eof.txt", error, units);
+	}
+	SECTION("insufficient elevation values") {
+		heightMap = TextFileReader::readTextFile(
+		    "data/test/text-insufficient-elevation-values.txt", error, units);
+	}
+	SECTION("too many elevation values") {
+		heightMap = TextFileReader::readTextFile(
+		    "data/test/text-too-many-elevation-values.txt", error, units);
+		CHECK(error.endsWith("(encountered more at line 6, column 1)"));
+	}
+	SECTION("non-numeric elevation value") {
+		heightMap = TextFileReader::readTextFile(
+		    "data/test/text-non-numeric-elevation.txt", error, units);
+		CHECK(error.endsWith("(encountered [x5] at line 5, column 3)"));
+	}
+	SECTION("elevation value with two signs") {
+		heightMap = TextFileReader::readTextFile(
+		    "data/test/text-double-sign.txt", error, units);
+		CHECK(error.endsWith("(encountered [+-5] at line 5, column 3)"));
+	}
+	SECTION("non-existing file") {
+		heightMap = TextFileReader::readTextFile(
+		    "data/test/text-non-existing-file.txt", error, units);
+	}
+	CHECK(heightMap.isEmpty());
+	CHECK(error.size() > 0);
+}
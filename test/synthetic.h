@@ -0,0 +1,41 @@
+#ifndef SYNTHETIC_H
+#define SYNTHETIC_H
+
+#include <memory>
+
+#include "boundary.h"
+#include "heightmap.h"
+#include "inputdcel.h"
+#include "mscomplex.h"
+#include "mscomplexcreator.h"
+
+/// Returns a 40×30 heightmap with pseudo-random elevations between 0 and 100.
+inline HeightMap syntheticHeightMap() {
+	HeightMap heightMap(40, 30);
+	for (int x = 0; x < 40; x++) {
+		for (int y = 0; y < 30; y++) {
+			heightMap.setElevationAt(x, y, (x * 37 + y * 91 + x * y * 13) % 101);
+		}
+	}
+	return heightMap;
+}
+
+/// Returns the DCEL of syntheticHeightMap(), with its gradient flow computed.
+inline std::shared_ptr<InputDcel> syntheticDcel() {
+	HeightMap heightMap = syntheticHeightMap();
+	auto dcel = std::make_shared<InputDcel>(heightMap, Boundary(heightMap));
+	dcel->computeGradientFlow();
+	return dcel;
+}
+
+/// Creates the Morse-Smale complex of the given DCEL using the given number of
+/// threads.
+inline std::shared_ptr<MsComplex> createMsComplex(const std::shared_ptr<InputDcel>& dcel,
+                                                  int threadCount = 1) {
+	auto msc = std::make_shared<MsComplex>();
+	MsComplexCreator creator(dcel, msc, nullptr, threadCount);
+	creator.create();
+	return msc;
+}
+
+#endif // SYNTHETIC_H
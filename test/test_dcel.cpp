@@ -191,6 +191,38 @@ TEST_CASE("isValid()") {
 	}
 }
 
+TEST_CASE("creating a DCEL with struct-of-arrays storage") {
+
+	typedef Dcel<int, std::string, double, DcelSoaStorage> SoaDcel;
+
+	SoaDcel dcel;
+	SoaDcel::Vertex a = dcel.addVertex();
+	SoaDcel::Vertex b = dcel.addVertex();
+	a.setData(1);
+	b.setData(2);
+	SoaDcel::HalfEdge e = dcel.addEdge(a, b);
+	SoaDcel::HalfEdge e2 = e.twin();
+	e.setData("e");
+	e2.setData("e2");
+	a.setOutgoing(e);
+	b.setOutgoing(e2);
+	e.setNext(e2);
+	e2.setNext(e);
+	dcel.addFaces();
+
+	REQUIRE(dcel.isValid(true));
+	REQUIRE(dcel.vertexCount() == 2);
+	REQUIRE(dcel.halfEdgeCount() == 2);
+	REQUIRE(dcel.faceCount() == 1);
+	REQUIRE(e.origin() == a);
+	REQUIRE(e.destination() == b);
+	REQUIRE(e.incidentFace() == e2.incidentFace());
+	REQUIRE(a.data() == 1);
+	REQUIRE(b.data() == 2);
+	REQUIRE(e.data() == "e");
+	REQUIRE(e2.data() == "e2");
+}
+
 TEST_CASE("splitting, carving and removing a vertex") {
 
 	// some arbitrary data types to test with
@@ -3,7 +3,11 @@
 
 #include <QImage>
 
+#include <limits>
+#include <vector>
+
 #include "inputdcel.h"
+#include "synthetic.h"
 
 SCENARIO("creating a DCEL from an InputGraph") {
 
@@ -61,6 +65,94 @@ SCENARIO("creating a DCEL from an InputGraph") {
 	}
 }
 
+SCENARIO("creating a DCEL directly from a heightmap") {
+
+	GIVEN("a 3x4 heightmap") {
+		HeightMap heightMap(3, 4);
+		for (int x = 0; x < 3; x++) {
+			for (int y = 0; y < 4; y++) {
+				heightMap.setElevationAt(x, y, (x * 7 + y * 5) % 6);
+			}
+		}
+
+		WHEN("creating a DCEL for the entire heightmap") {
+			InputDcel direct(heightMap, Boundary(heightMap));
+			InputGraph g(heightMap);
+			InputDcel viaGraph(g);
+			THEN("it should be a valid grid") {
+				REQUIRE(direct.isValid(true));
+				REQUIRE(direct.vertexCount() == 12);
+				REQUIRE(direct.halfEdgeCount() == 34);
+				REQUIRE(direct.faceCount() == 7);
+				int outerBoundaryLength = 0;
+				direct.outerFace().forAllBoundaryEdges([&](InputDcel::HalfEdge) {
+					outerBoundaryLength++;
+				});
+				REQUIRE(outerBoundaryLength == 10);
+			}
+			THEN("it should be equal to the DCEL created through an InputGraph") {
+				REQUIRE(direct.vertexCount() == viaGraph.vertexCount());
+				REQUIRE(direct.halfEdgeCount() == viaGraph.halfEdgeCount());
+				REQUIRE(direct.faceCount() == viaGraph.faceCount());
+				for (int i = 0; i < direct.vertexCount(); i++) {
+					InputDcel::Vertex v = direct.vertex(i);
+					InputDcel::Vertex w = viaGraph.vertexAt(v.data().p.x, v.data().p.y);
+					REQUIRE(w.isInitialized());
+					CHECK(v.data().p == w.data().p);
+					CHECK(v.data().boundaryStatus == w.data().boundaryStatus);
+					CHECK(v.degree() == w.degree());
+					v.forAllOutgoingEdges([&](InputDcel::HalfEdge e) {
+						InputDcel::Vertex to = viaGraph.vertexAt(
+						        e.destination().data().p.x, e.destination().data().p.y);
+						InputDcel::HalfEdge f = w.outgoingTo(to);
+						REQUIRE(f.isInitialized());
+						CHECK(e.data().boundaryStatus == f.data().boundaryStatus);
+						CHECK(e.next().destination().data().p ==
+						      f.next().destination().data().p);
+						CHECK((e.incidentFace() == direct.outerFace()) ==
+						      (f.incidentFace() == viaGraph.outerFace()));
+					});
+				}
+			}
+		}
+
+		WHEN("creating a DCEL for part of the heightmap") {
+			Path path;
+			path.addPoint(HeightMap::Coordinate(0, 0));
+			path.addPoint(HeightMap::Coordinate(2, 0));
+			path.addPoint(HeightMap::Coordinate(2, 2));
+			path.addPoint(HeightMap::Coordinate(1, 2));
+			path.addPoint(HeightMap::Coordinate(1, 3));
+			path.addPoint(HeightMap::Coordinate(0, 3));
+			path.addPoint(HeightMap::Coordinate(0, 0));
+			Boundary boundary(path);
+			InputDcel direct(heightMap, boundary);
+			InputGraph g(heightMap, boundary);
+			InputDcel viaGraph(g);
+			THEN("it should be identical to the DCEL created through an InputGraph") {
+				REQUIRE(direct.isValid(true));
+				REQUIRE(direct.vertexCount() == 11);
+				REQUIRE(direct.vertexCount() == viaGraph.vertexCount());
+				REQUIRE(direct.halfEdgeCount() == viaGraph.halfEdgeCount());
+				REQUIRE(direct.faceCount() == viaGraph.faceCount());
+				REQUIRE(direct.outerFace().id() == viaGraph.outerFace().id());
+				for (int i = 0; i < direct.vertexCount(); i++) {
+					CHECK(direct.vertex(i).data().p == viaGraph.vertex(i).data().p);
+					CHECK(direct.vertex(i).data().boundaryStatus ==
+					      viaGraph.vertex(i).data().boundaryStatus);
+				}
+				for (int i = 0; i < direct.halfEdgeCount(); i++) {
+					CHECK(direct.halfEdge(i).origin().id() ==
+					      viaGraph.halfEdge(i).origin().id());
+					CHECK(direct.halfEdge(i).next().id() == viaGraph.halfEdge(i).next().id());
+					CHECK(direct.halfEdge(i).data().boundaryStatus ==
+					      viaGraph.halfEdge(i).data().boundaryStatus);
+				}
+			}
+		}
+	}
+}
+
 SCENARIO("measuring volume above a face") {
 	GIVEN("a DCEL created from a 2x2 heightmap") {
 		HeightMap heightMap(2, 2);
@@ -88,3 +180,186 @@ SCENARIO("measuring volume above a face") {
 		}
 	}
 }
+
+/// Checks that computing the gradient flow with one and with four threads
+/// results in identical gradient pairs.
+static void checkParallelGradientFlow(const HeightMap& heightMap, const Boundary& boundary) {
+	InputDcel sequential(heightMap, boundary);
+	sequential.computeGradientFlow(1);
+	InputDcel parallel(heightMap, boundary);
+	parallel.computeGradientFlow(4);
+
+	REQUIRE(sequential.vertexCount() == parallel.vertexCount());
+	for (int i = 0; i < sequential.vertexCount(); i++) {
+		CHECK(sequential.vertex(i).data().pairedWithEdge ==
+		      parallel.vertex(i).data().pairedWithEdge);
+	}
+	for (int i = 0; i < sequential.halfEdgeCount(); i++) {
+		const InputDcelHalfEdge& e = sequential.halfEdge(i).data();
+		const InputDcelHalfEdge& f = parallel.halfEdge(i).data();
+		CHECK(e.highestOfFace == f.highestOfFace);
+		CHECK(e.secondHighestOfFace == f.secondHighestOfFace);
+		CHECK(e.pairedWithVertex == f.pairedWithVertex);
+		CHECK(e.pairedWithFace == f.pairedWithFace);
+	}
+	for (int i = 0; i < sequential.faceCount(); i++) {
+		CHECK(sequential.face(i).data().pairedWithEdge ==
+		      parallel.face(i).data().pairedWithEdge);
+	}
+}
+
+SCENARIO("computing the gradient flow in parallel") {
+	GIVEN("a 40x30 heightmap") {
+		HeightMap heightMap = syntheticHeightMap();
+
+		THEN("the gradient pairs should not depend on the number of threads") {
+			checkParallelGradientFlow(heightMap, Boundary(heightMap));
+		}
+
+		WHEN("using a boundary with permeable regions") {
+			Path path;
+			path.addPoint(HeightMap::Coordinate(2, 15));
+			path.addPoint(HeightMap::Coordinate(20, 1));
+			path.addPoint(HeightMap::Coordinate(37, 15));
+			path.addPoint(HeightMap::Coordinate(20, 28));
+			path.addPoint(HeightMap::Coordinate(2, 15));
+			Boundary boundary(path);
+			boundary.addPermeableRegion({0, 1});
+			boundary.addPermeableRegion({2, 3});
+
+			THEN("the gradient pairs should not depend on the number of threads") {
+				checkParallelGradientFlow(heightMap, boundary);
+			}
+		}
+	}
+}
+
+SCENARIO("following gradient paths") {
+	GIVEN("a 40x30 heightmap with its gradient flow") {
+		HeightMap heightMap = syntheticHeightMap();
+		InputDcel dcel(heightMap, Boundary(heightMap));
+		dcel.computeGradientFlow();
+
+		THEN("the gradient path from every saddle edge follows the vertex-edge pairs") {
+			int saddleCount = 0;
+			for (int i = 0; i < dcel.halfEdgeCount(); i++) {
+				InputDcel::HalfEdge e = dcel.halfEdge(i);
+				if (!dcel.isCritical(e)) {
+					continue;
+				}
+				saddleCount++;
+				InputDcel::GradientPath path = dcel.gradientPath(e);
+
+				// walk the path explicitly
+				InputDcel::Path expected;
+				expected.addEdge(e);
+				while (expected.destination().data().pairedWithEdge != -1) {
+					expected.addEdge(dcel.halfEdge(expected.destination().data().pairedWithEdge));
+				}
+
+				REQUIRE(path.length() == expected.length());
+				CHECK(path.firstEdge() == e);
+				CHECK(path.origin() == expected.origin());
+				CHECK(path.destination() == expected.destination());
+				int j = 0;
+				for (InputDcel::HalfEdge pathEdge : path) {
+					CHECK(pathEdge == expected.edges()[j]);
+					j++;
+				}
+				CHECK(j == expected.length());
+
+				InputDcel::Path reversed = path.reversed();
+				CHECK(reversed.origin() == expected.destination());
+				CHECK(reversed.destination() == expected.origin());
+			}
+			CHECK(saddleCount > 0);
+		}
+	}
+
+	GIVEN("an empty gradient path") {
+		InputDcel::GradientPath path;
+
+		THEN("it should not contain any edges") {
+			CHECK(path.empty());
+			CHECK(path.length() == 0);
+			CHECK(path.begin() == path.end());
+			CHECK(!path.origin().isInitialized());
+			CHECK(!path.destination().isInitialized());
+		}
+	}
+}
+
+/// Returns the ID of the vertex at the given position by scanning all
+/// vertices, or -1 if there is none.
+static int vertexIdAtByScanning(InputDcel& dcel, double x, double y) {
+	for (int i = 0; i < dcel.vertexCount(); i++) {
+		Point p = dcel.vertex(i).data().p;
+		if (p.x == x && p.y == y && p.h < std::numeric_limits<double>::infinity()) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+/// Checks that vertexAt() and verticesAt() agree with scanning all vertices,
+/// for all (half-)integer positions in and around a width × height area.
+static void checkVertexLookup(InputDcel& dcel, int width, int height) {
+	std::vector<Point> positions;
+	std::vector<int> expected;
+	for (double y = -1; y <= height; y += 0.5) {
+		for (double x = -1; x <= width; x += 0.5) {
+			positions.push_back(Point{x, y, 0});
+			expected.push_back(vertexIdAtByScanning(dcel, x, y));
+			InputDcel::Vertex v = dcel.vertexAt(x, y);
+			CHECK(v.isInitialized() == (expected.back() != -1));
+			if (v.isInitialized()) {
+				CHECK(v.id() == expected.back());
+			}
+		}
+	}
+	CHECK(!dcel.vertexAt(std::numeric_limits<double>::quiet_NaN(), 0).isInitialized());
+
+	std::vector<InputDcel::Vertex> vertices = dcel.verticesAt(positions, 4);
+	REQUIRE(vertices.size() == positions.size());
+	for (int i = 0; i < vertices.size(); i++) {
+		CHECK(vertices[i].isInitialized() == (expected[i] != -1));
+		if (vertices[i].isInitialized()) {
+			CHECK(vertices[i].id() == expected[i]);
+		}
+	}
+}
+
+SCENARIO("looking up vertices by their position") {
+	GIVEN("a 40x30 heightmap") {
+		HeightMap heightMap = syntheticHeightMap();
+
+		WHEN("the boundary covers the entire heightmap") {
+			InputDcel dcel(heightMap, Boundary(heightMap));
+			THEN("the lookup should find the same vertices as a linear scan") {
+				checkVertexLookup(dcel, 40, 30);
+			}
+		}
+
+		WHEN("the boundary covers part of the heightmap") {
+			Path path;
+			path.addPoint(HeightMap::Coordinate(2, 15));
+			path.addPoint(HeightMap::Coordinate(20, 1));
+			path.addPoint(HeightMap::Coordinate(37, 15));
+			path.addPoint(HeightMap::Coordinate(20, 28));
+			path.addPoint(HeightMap::Coordinate(2, 15));
+			InputDcel dcel(heightMap, Boundary(path));
+			THEN("the lookup should find the same vertices as a linear scan") {
+				REQUIRE(dcel.vertexCount() < 40 * 30);
+				checkVertexLookup(dcel, 40, 30);
+			}
+		}
+
+		WHEN("creating the DCEL from an InputGraph") {
+			InputGraph g(heightMap);
+			InputDcel dcel(g);
+			THEN("the lookup should find the same vertices as a linear scan") {
+				checkVertexLookup(dcel, 40, 30);
+			}
+		}
+	}
+}
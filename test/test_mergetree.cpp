@@ -0,0 +1,147 @@
+#include <QColor>
+#include <QImage>
+
+#include <cmath>
+#include <memory>
+#include <optional>
+#include <variant>
+#include <vector>
+
+#include "catch.hpp"
+
+#include "boundary.h"
+#include "heightmap.h"
+#include "inputdcel.h"
+#include "mergetree.h"
+#include "mscomplex.h"
+#include "mscomplexcreator.h"
+#include "synthetic.h"
+
+/// Computes the volume above the given height in the subtree rooted at the
+/// given node, by summing the sand functions of the leaves in that subtree.
+static double sumOfLeafVolumes(const MergeTree& tree, int nodeId, double height) {
+	const MergeTree::Node& node = tree.get(nodeId);
+	if (node.m_children.empty()) {
+		MsComplex::Face maximum = std::get<MsComplex::Face>(node.m_criticalSimplex);
+		return maximum.data().volumeAbove(height);
+	}
+	double volume = 0;
+	for (int child : node.m_children) {
+		volume += sumOfLeafVolumes(tree, child, height);
+	}
+	return volume;
+}
+
+TEST_CASE("computing the merge tree of a Morse-Smale complex") {
+	std::shared_ptr<InputDcel> dcel = syntheticDcel();
+	std::shared_ptr<MsComplex> msc = createMsComplex(dcel);
+	MergeTree tree(msc);
+
+	// every MS-face is a leaf, and all of them end up in a single tree
+	int leafCount = 0;
+	for (int i = 0; tree.get(i).m_children.empty(); i++) {
+		leafCount++;
+	}
+	CHECK(leafCount == msc->faceCount());
+	CHECK(tree.root().m_parent == -1);
+
+	for (int i = leafCount; i <= tree.root().m_index; i++) {
+		const MergeTree::Node& node = tree.get(i);
+		REQUIRE(node.m_children.size() == 2);
+		for (int child : node.m_children) {
+			CHECK(tree.get(child).m_parent == i);
+			if (!tree.get(child).m_children.empty()) {
+				CHECK(tree.get(child).m_p.h >= node.m_p.h);
+			}
+		}
+		double expected = sumOfLeafVolumes(tree, i, node.m_p.h);
+		if (std::isinf(expected)) {
+			CHECK(node.m_volumeAbove == expected);
+		} else {
+			CHECK(node.m_volumeAbove == Approx(expected));
+		}
+	}
+}
+
+TEST_CASE("finding the ancestors of merge tree nodes at a given height") {
+	std::shared_ptr<InputDcel> dcel = syntheticDcel();
+	std::shared_ptr<MsComplex> msc = createMsComplex(dcel);
+	MergeTree tree(msc);
+
+	std::vector<int> nodeIds;
+	for (int i = 0; i <= tree.root().m_index; i++) {
+		nodeIds.push_back(i);
+	}
+	for (double height = -1; height <= 102; height += 0.5) {
+		std::vector<std::optional<int>> ancestors = tree.parentsAtHeight(nodeIds, height, 4);
+		for (int i : nodeIds) {
+			// compare to just walking up the tree
+			std::optional<int> expected;
+			if (tree.get(i).m_p.h >= height) {
+				int ancestor = i;
+				while (tree.get(ancestor).m_parent != -1 &&
+				       tree.get(tree.get(ancestor).m_parent).m_p.h > height) {
+					ancestor = tree.get(ancestor).m_parent;
+				}
+				expected = ancestor;
+			}
+			CHECK(tree.parentAtHeight(i, height) == expected);
+			CHECK(ancestors[i] == expected);
+		}
+	}
+}
+
+TEST_CASE("numbering the leaves of a merge tree") {
+	std::shared_ptr<InputDcel> dcel = syntheticDcel();
+	std::shared_ptr<MsComplex> msc = createMsComplex(dcel);
+	MergeTree tree(msc);
+
+	// the leaf range of every node should consist of exactly the leaves in its
+	// subtree
+	std::vector<int> leafOfNumber(msc->faceCount(), -1);
+	for (int i = 0; i <= tree.root().m_index; i++) {
+		const MergeTree::Node& node = tree.get(i);
+		if (node.m_children.empty()) {
+			REQUIRE(node.m_firstLeaf == node.m_lastLeaf);
+			REQUIRE(node.m_firstLeaf >= 0);
+			REQUIRE(node.m_firstLeaf < msc->faceCount());
+			CHECK(leafOfNumber[node.m_firstLeaf] == -1);
+			leafOfNumber[node.m_firstLeaf] = i;
+		}
+	}
+	CHECK(tree.root().m_firstLeaf == 0);
+	CHECK(tree.root().m_lastLeaf == msc->faceCount() - 1);
+	for (int leaf = 0; leaf < msc->faceCount(); leaf++) {
+		int ancestor = leafOfNumber[leaf];
+		while (ancestor != -1) {
+			CHECK(tree.get(ancestor).m_firstLeaf <= leaf);
+			CHECK(leaf <= tree.get(ancestor).m_lastLeaf);
+			ancestor = tree.get(ancestor).m_parent;
+		}
+	}
+
+	// the raster should contain the leaf of the MS-face of each InputDcel face
+	std::vector<int> raster = tree.leafRaster(40, 30);
+	std::vector<int> leafOfMsFace(msc->faceCount(), -1);
+	for (int leaf = 0; leaf < msc->faceCount(); leaf++) {
+		const MergeTree::Node& node = tree.get(leafOfNumber[leaf]);
+		leafOfMsFace[std::get<MsComplex::Face>(node.m_criticalSimplex).id()] = leaf;
+	}
+	for (int i = 0; i < dcel->faceCount(); i++) {
+		InputDcel::Face f = dcel->face(i);
+		if (f == dcel->outerFace()) {
+			continue;
+		}
+		Point p = InputDcel::position(f);
+		int x = std::floor(p.x);
+		int y = std::floor(p.y);
+		if (f.data().msFace == -1) {
+			CHECK(raster[y * 40 + x] == -1);
+		} else {
+			CHECK(raster[y * 40 + x] == leafOfMsFace[f.data().msFace]);
+		}
+	}
+	for (int x = 0; x < 40; x++) {
+		CHECK(raster[29 * 40 + x] == -1);
+	}
+}
@@ -1,13 +1,24 @@
 #include <QColor>
 #include <QImage>
 
+#include <cmath>
+#include <fstream>
 #include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "catch.hpp"
 
+#include "boundary.h"
+#include "heightmap.h"
+#include "inputdcel.h"
 #include "inputgraph.h"
 #include "mscomplex.h"
 #include "mscomplexcreator.h"
+#include "mscomplexsimplifier.h"
+#include "synthetic.h"
 
 /*TEST_CASE("creating a Morse-Smale complex") {
 
@@ -315,3 +326,210 @@ TEST_CASE("creating a Morse-Smale complex with non-square aspect ratio") {
 	MsComplexCreator msCreator(dcel, &msc);
 	msCreator.create();
 }*/
+
+/// Checks that creating the Morse-Smale complex with one and with four
+/// threads results in identical complexes.
+static void checkParallelMsComplex(const HeightMap& heightMap, const Boundary& boundary) {
+	auto dcel = std::make_shared<InputDcel>(heightMap, boundary);
+	dcel->computeGradientFlow();
+	std::shared_ptr<MsComplex> sequential = createMsComplex(dcel, 1);
+	std::shared_ptr<MsComplex> parallel = createMsComplex(dcel, 4);
+	REQUIRE(parallel->isValid(true));
+
+	REQUIRE(sequential->vertexCount() == parallel->vertexCount());
+	for (int i = 0; i < sequential->vertexCount(); i++) {
+		MsComplex::Vertex v = sequential->vertex(i);
+		MsComplex::Vertex w = parallel->vertex(i);
+		CHECK(v.data().type == w.data().type);
+		CHECK(v.data().p == w.data().p);
+		CHECK(v.outgoing().id() == w.outgoing().id());
+	}
+
+	REQUIRE(sequential->halfEdgeCount() == parallel->halfEdgeCount());
+	for (int i = 0; i < sequential->halfEdgeCount(); i++) {
+		MsComplex::HalfEdge e = sequential->halfEdge(i);
+		MsComplex::HalfEdge f = parallel->halfEdge(i);
+		CHECK(e.origin().id() == f.origin().id());
+		CHECK(e.next().id() == f.next().id());
+		CHECK(e.incidentFace().id() == f.incidentFace().id());
+		CHECK(e.data().m_dcelPath.length() == f.data().m_dcelPath.length());
+	}
+
+	REQUIRE(sequential->faceCount() == parallel->faceCount());
+	for (int i = 0; i < sequential->faceCount(); i++) {
+		MsFace& f = sequential->face(i).data();
+		MsFace& g = parallel->face(i).data();
+		CHECK(f.maximum.id() == g.maximum.id());
+		REQUIRE(f.faces.size() == g.faces.size());
+		for (int j = 0; j < f.faces.size(); j++) {
+			CHECK(f.faces[j].id() == g.faces[j].id());
+		}
+		for (double h = -1; h <= 102; h += 0.5) {
+			CHECK(f.volumeAbove(h) == g.volumeAbove(h));
+		}
+	}
+}
+
+SCENARIO("creating a Morse-Smale complex in parallel") {
+	GIVEN("a 40x30 heightmap") {
+		HeightMap heightMap = syntheticHeightMap();
+
+		THEN("the Morse-Smale complex should not depend on the number of threads") {
+			checkParallelMsComplex(heightMap, Boundary(heightMap));
+		}
+
+		WHEN("using a boundary with permeable regions") {
+			Path path;
+			path.addPoint(HeightMap::Coordinate(2, 15));
+			path.addPoint(HeightMap::Coordinate(20, 1));
+			path.addPoint(HeightMap::Coordinate(37, 15));
+			path.addPoint(HeightMap::Coordinate(20, 28));
+			path.addPoint(HeightMap::Coordinate(2, 15));
+			Boundary boundary(path);
+			boundary.addPermeableRegion({0, 1});
+			boundary.addPermeableRegion({2, 3});
+
+			THEN("the Morse-Smale complex should not depend on the number of threads") {
+				checkParallelMsComplex(heightMap, boundary);
+			}
+		}
+	}
+}
+
+TEST_CASE("assigning InputDcel faces to Morse-Smale faces") {
+	std::shared_ptr<InputDcel> dcel = syntheticDcel();
+	std::shared_ptr<MsComplex> msc = createMsComplex(dcel, 1);
+
+	// every InputDcel face should be assigned to the MS-face whose maximum is
+	// reached by following the edge-face gradient pairs upwards
+	int assignedCount = 0;
+	for (int i = 0; i < msc->faceCount(); i++) {
+		MsFace& f = msc->face(i).data();
+		for (InputDcel::Face face : f.faces) {
+			CHECK(face.data().msFace == i);
+			while (face.data().pairedWithEdge != -1) {
+				face = dcel->halfEdge(face.data().pairedWithEdge).twin().incidentFace();
+			}
+			CHECK(face == f.maximum);
+		}
+		assignedCount += f.faces.size();
+	}
+	for (int i = 0; i < dcel->faceCount(); i++) {
+		if (dcel->face(i).data().msFace == -1) {
+			InputDcel::Face face = dcel->face(i);
+			while (face.data().pairedWithEdge != -1) {
+				face = dcel->halfEdge(face.data().pairedWithEdge).twin().incidentFace();
+			}
+			CHECK(face == dcel->outerFace());
+		} else {
+			assignedCount--;
+		}
+	}
+	CHECK(assignedCount == 0);
+}
+
+TEST_CASE("simplifying a Morse-Smale complex") {
+	std::shared_ptr<InputDcel> dcel = syntheticDcel();
+	std::shared_ptr<MsComplex> msc = createMsComplex(dcel, 1);
+	int vertexCount = msc->vertexCount();
+	int halfEdgeCount = msc->halfEdgeCount();
+	int faceCount = msc->faceCount();
+	std::vector<double> volumes;
+	for (int i = 0; i < faceCount; i++) {
+		volumes.push_back(msc->face(i).data().volumeAbove(50));
+	}
+
+	MsComplexSimplifier simplifier(msc);
+	simplifier.simplify();
+
+	// the simplifier should only write the δ-values and heaviest sides
+	REQUIRE(msc->isValid(true));
+	CHECK(msc->vertexCount() == vertexCount);
+	CHECK(msc->halfEdgeCount() == halfEdgeCount);
+	CHECK(msc->faceCount() == faceCount);
+	for (int i = 0; i < faceCount; i++) {
+		CHECK(msc->face(i).data().volumeAbove(50) == volumes[i]);
+	}
+
+	for (int i = 0; i < msc->vertexCount(); i++) {
+		MsComplex::Vertex saddle = msc->vertex(i);
+		if (saddle.data().type != VertexType::saddle) {
+			continue;
+		}
+		CHECK(saddle.data().m_heaviestSide != -1);
+		for (MsComplex::HalfEdge e : {saddle.outgoing(), saddle.outgoing().nextOutgoing()}) {
+			CHECK(e.data().m_delta >= 0);
+			CHECK(e.data().m_delta == e.twin().data().m_delta);
+		}
+	}
+
+	// compare to the δ-values and heaviest sides computed by the original
+	// simplifier, which simplified a copy of the complex
+	std::ifstream expected("data/test/synthetic-simplified.txt");
+	int expectedHalfEdgeCount;
+	int expectedVertexCount;
+	expected >> expectedHalfEdgeCount >> expectedVertexCount;
+	REQUIRE(expectedHalfEdgeCount == halfEdgeCount);
+	REQUIRE(expectedVertexCount == vertexCount);
+	for (int i = 0; i < halfEdgeCount; i++) {
+		// read as a string, as streams cannot parse "inf"
+		std::string delta;
+		expected >> delta;
+		if (std::isinf(std::stod(delta))) {
+			CHECK(msc->halfEdge(i).data().m_delta == std::stod(delta));
+		} else {
+			CHECK(msc->halfEdge(i).data().m_delta == Approx(std::stod(delta)));
+		}
+	}
+	for (int i = 0; i < vertexCount; i++) {
+		int heaviestSide;
+		expected >> heaviestSide;
+		CHECK(msc->vertex(i).data().m_heaviestSide == heaviestSide);
+	}
+	CHECK(expected);
+}
+
+/// Fills `msc` with a tree with the given vertex heights and edges (with the
+/// given δ-values). Around each vertex, the edges are ordered as given.
+static void createTree(MsComplex& msc, const std::vector<double>& heights,
+                       const std::vector<std::pair<int, int>>& edges,
+                       const std::vector<double>& deltas) {
+	for (double h : heights) {
+		msc.addVertex().data().p.h = h;
+	}
+	std::vector<std::vector<MsComplex::HalfEdge>> outgoing(heights.size());
+	for (int i = 0; i < edges.size(); i++) {
+		MsComplex::HalfEdge e =
+		    msc.addEdge(msc.vertex(edges[i].first), msc.vertex(edges[i].second));
+		e.data().m_delta = deltas[i];
+		e.twin().data().m_delta = deltas[i];
+		outgoing[edges[i].first].push_back(e);
+		outgoing[edges[i].second].push_back(e.twin());
+	}
+	for (int v = 0; v < heights.size(); v++) {
+		msc.vertex(v).setOutgoing(outgoing[v][0]);
+		for (int i = 0; i < outgoing[v].size(); i++) {
+			outgoing[v][i].twin().setNext(outgoing[v][(i + 1) % outgoing[v].size()]);
+		}
+	}
+	msc.addFaces();
+}
+
+TEST_CASE("propagating δ-values to dead ends") {
+	// two vertices at height -∞, connected by a path 0 - 1 - 2 - 3, with a
+	// dead end 2 - 4
+	double infinity = std::numeric_limits<double>::infinity();
+	MsComplex msc;
+	createTree(msc, {-infinity, 1, 2, -infinity, 3}, {{0, 1}, {1, 2}, {2, 3}, {2, 4}},
+	           {5, 3, 7, 9});
+	REQUIRE(msc.isValid(true));
+
+	MsComplexSimplifier::propagateDeltas(msc);
+	CHECK(msc.halfEdge(0).data().m_delta == 3);
+	CHECK(msc.halfEdge(2).data().m_delta == 3);
+	CHECK(msc.halfEdge(4).data().m_delta == 3);
+	CHECK(msc.halfEdge(6).data().m_delta == 0);
+	for (int i = 0; i < msc.halfEdgeCount(); i++) {
+		CHECK(msc.halfEdge(i).data().m_delta == msc.halfEdge(i).twin().data().m_delta);
+	}
+}
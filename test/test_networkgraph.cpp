@@ -0,0 +1,36 @@
+#include "catch.hpp"
+
+#include <limits>
+#include <span>
+#include <vector>
+
+#include "networkgraph.h"
+
+TEST_CASE("querying a network graph by δ-value") {
+	NetworkGraph graph;
+	for (int i = 0; i < 5; i++) {
+		graph.addVertex(Point(i, 0, 0));
+	}
+	double inf = std::numeric_limits<double>::infinity();
+	graph.addEdge(0, 1, {}, 3);
+	graph.addEdge(1, 2, {}, inf);
+	graph.addEdge(2, 3, {}, 1);
+	graph.addEdge(3, 4, {}, 3);
+	graph.addEdge(4, 0, {}, 2);
+	graph.buildDeltaIndex();
+
+	auto ids = [](std::span<const int> edges) {
+		return std::vector<int>(edges.begin(), edges.end());
+	};
+	CHECK((ids(graph.edgesByDelta()) == std::vector<int>{2, 4, 0, 3, 1}));
+	CHECK((ids(graph.edgesWithDeltaAtLeast(3)) == std::vector<int>{0, 3, 1}));
+	CHECK((ids(graph.edgesWithDeltaAbove(3)) == std::vector<int>{1}));
+	CHECK(ids(graph.edgesWithDeltaAbove(0)).size() == 5);
+	CHECK((ids(graph.edgesWithDeltaAtLeast(inf)) == std::vector<int>{1}));
+	CHECK(graph.edgesWithDeltaAbove(inf).empty());
+
+	// the edges themselves and the incidences are unaffected by the queries
+	CHECK(graph.edgeCount() == 5);
+	CHECK(graph.edge(3).id == 3);
+	CHECK((graph[3].incidentEdges == std::vector<int>{2, 3}));
+}
@@ -1,5 +1,9 @@
 #include "catch.hpp"
 
+#include <limits>
+#include <memory_resource>
+#include <vector>
+
 #include "piecewiselinearfunction.h"
 
 TEST_CASE("linear functions") {
@@ -32,6 +36,41 @@ TEST_CASE("adding piecewise linear functions") {
 	CHECK(f3(3) == Approx(3));
 }
 
+TEST_CASE("adding and subtracting piecewise linear functions in place") {
+	PiecewiseLinearFunction f1({0, 4}, {LinearFunction(1), LinearFunction(2), LinearFunction(0, 1)});
+	PiecewiseLinearFunction f2({2, 4}, {LinearFunction(3), LinearFunction(1), LinearFunction(1, 1)});
+	PiecewiseLinearFunction f3 = f1;
+	f3 += f2;
+	for (double h = -1; h <= 6; h += 0.5) {
+		CHECK(f3(h) == Approx(f1(h) + f2(h)));
+	}
+	f3 -= f2;
+	for (double h = -1; h <= 6; h += 0.5) {
+		CHECK(f3(h) == Approx(f1(h)));
+	}
+	f3 += f3;
+	for (double h = -1; h <= 6; h += 0.5) {
+		CHECK(f3(h) == Approx(2 * f1(h)));
+	}
+	f3 -= f3;
+	for (double h = -1; h <= 6; h += 0.5) {
+		CHECK(f3(h) == 0);
+	}
+}
+
+TEST_CASE("allocating piecewise linear functions from a memory resource") {
+	std::pmr::monotonic_buffer_resource arena;
+	PiecewiseLinearFunction f(&arena);
+	f += PiecewiseLinearFunction({0}, {LinearFunction(1), LinearFunction(2)});
+	PiecewiseLinearFunction g(f, &arena);
+	g += PiecewiseLinearFunction({2}, {LinearFunction(3), LinearFunction(1)});
+	CHECK(f(-1) == Approx(1));
+	CHECK(f(1) == Approx(2));
+	CHECK(g(-1) == Approx(4));
+	CHECK(g(1) == Approx(5));
+	CHECK(g(3) == Approx(3));
+}
+
 TEST_CASE("searching heights for a given piecewise linear function value") {
 	PiecewiseLinearFunction f1(
 	    {-1, 1}, {LinearFunction(-1, -2), LinearFunction(0, -1), LinearFunction(-1, -0.5)});
@@ -50,3 +89,20 @@ TEST_CASE("searching heights for a given piecewise linear function value") {
 	CHECK(f1.heightForVolume(-2.5) == Approx(3));
 	CHECK(f1.heightForVolume(-3) == Approx(4));
 }
+
+TEST_CASE("summing quarter pillars") {
+	std::vector<double> heights{3, 1, 4, 1, 5, 9, 2, 6, 5, 3};
+	PiecewiseLinearFunction expected;
+	for (double h : heights) {
+		expected = expected.add(PiecewiseLinearFunction(Point(0, 0, h)));
+	}
+	PiecewiseLinearFunction sum = PiecewiseLinearFunction::sumOfPillars({heights.begin(), heights.end()});
+	for (double h = -1; h <= 10; h += 0.25) {
+		CHECK(sum(h) == Approx(expected(h)));
+	}
+
+	PiecewiseLinearFunction empty = PiecewiseLinearFunction::sumOfPillars(
+	    {std::numeric_limits<double>::quiet_NaN()});
+	CHECK(empty(-1) == 0);
+	CHECK(empty(1) == 0);
+}
@@ -0,0 +1,76 @@
+#include "catch.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "boundary.h"
+#include "heightmap.h"
+#include "inputdcel.h"
+#include "spatialindex.h"
+
+TEST_CASE("querying a spatial index") {
+	std::mt19937 random(1);
+	std::uniform_real_distribution<double> coordinate(0, 100);
+	std::uniform_real_distribution<double> size(0, 20);
+	std::vector<SpatialIndex::Box> items;
+	for (int i = 0; i < 500; i++) {
+		double x = coordinate(random);
+		double y = coordinate(random);
+		items.push_back(SpatialIndex::Box{x, y, x + size(random), y + size(random)});
+	}
+	items.push_back(SpatialIndex::Box{std::numeric_limits<double>::quiet_NaN(), 0, 0, 0});
+	SpatialIndex index(items, 8);
+	CHECK(index.itemCount() == 501);
+
+	for (int q = 0; q < 100; q++) {
+		double x = coordinate(random) - 10;
+		double y = coordinate(random) - 10;
+		SpatialIndex::Box region{x, y, x + size(random), y + size(random)};
+		std::vector<int> result = index.query(region);
+
+		// every overlapping item should be found, exactly once
+		REQUIRE(std::is_sorted(result.begin(), result.end()));
+		REQUIRE(std::adjacent_find(result.begin(), result.end()) == result.end());
+		for (int i = 0; i < 500; i++) {
+			const SpatialIndex::Box& item = items[i];
+			bool overlaps = item.xMin <= region.xMax && item.xMax >= region.xMin &&
+			                item.yMin <= region.yMax && item.yMax >= region.yMin;
+			if (overlaps) {
+				CHECK(std::binary_search(result.begin(), result.end(), i));
+			}
+		}
+		CHECK(!std::binary_search(result.begin(), result.end(), 500));
+	}
+
+	SECTION("regions outside the index are empty") {
+		CHECK(index.query(SpatialIndex::Box{200, 200, 300, 300}).empty());
+		CHECK(SpatialIndex().query(SpatialIndex::Box{0, 0, 100, 100}).empty());
+	}
+}
+
+TEST_CASE("indexing the vertices of an InputDcel") {
+	HeightMap heightMap(40, 30);
+	for (int x = 0; x < 40; x++) {
+		for (int y = 0; y < 30; y++) {
+			heightMap.setElevationAt(x, y, x + y);
+		}
+	}
+	InputDcel dcel(heightMap, Boundary(heightMap));
+	InputDcelIndex index(dcel);
+	std::vector<int> vertices = index.vertices.query(SpatialIndex::Box{10, 5, 12, 6});
+	std::vector<int> expected;
+	for (int i = 0; i < dcel.vertexCount(); i++) {
+		Point p = dcel.vertex(i).data().p;
+		if (p.x >= 10 && p.x <= 12 && p.y >= 5 && p.y <= 6) {
+			expected.push_back(i);
+		}
+	}
+	CHECK(expected.size() == 6);
+	for (int v : expected) {
+		CHECK(std::binary_search(vertices.begin(), vertices.end(), v));
+	}
+	CHECK(index.faces.itemCount() == dcel.faceCount());
+}